@@ -0,0 +1,75 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <hydra_utils/dsg_types.h>
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace hydra {
+namespace incremental {
+
+/**
+ * @brief Tracks which nodes are connected to mesh vertices in the active window
+ *
+ * Only connections to active vertices are kept: once every vertex that a node is
+ * connected to leaves the active window, the node leaves the index. Updates scale
+ * with the size of the active window instead of the number of nodes in the graph.
+ */
+class ActiveWindowIndex {
+ public:
+  //! Add connections between a node and (active) mesh vertices
+  void addConnections(NodeId node, const std::vector<size_t>& vertices);
+
+  void removeNode(NodeId node);
+
+  //! Forget vertices that are no longer active (and nodes left without any)
+  void updateActiveVertices(const std::vector<size_t>& active_vertices);
+
+  inline bool contains(NodeId node) const { return node_vertices_.count(node); }
+
+  inline size_t size() const { return node_vertices_.size(); }
+
+  //! Nodes connected to at least one active vertex (in ascending order)
+  std::vector<NodeId> getNodes() const;
+
+ private:
+  std::unordered_map<NodeId, std::unordered_set<size_t>> node_vertices_;
+  std::unordered_map<size_t, std::unordered_set<NodeId>> vertex_nodes_;
+};
+
+}  // namespace incremental
+}  // namespace hydra
@@ -0,0 +1,141 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <hydra_utils/dsg_types.h>
+
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace hydra {
+namespace incremental {
+
+//! Size of the logged layers of a scene graph (cheap to compute with the graph locked)
+struct GraphLogStats {
+  struct Layer {
+    std::string name;
+    size_t num_nodes;
+    size_t num_edges;
+  };
+
+  uint64_t timestamp_ns = 0;
+  std::vector<Layer> layers;
+};
+
+GraphLogStats getGraphLogStats(const DynamicSceneGraph& graph,
+                               const std::map<LayerId, std::string>& layer_names,
+                               uint64_t timestamp_ns);
+
+/**
+ * @brief Moves log output off of the pipeline threads
+ *
+ * Producers enqueue tasks that hold everything they need to write (e.g., a formatted
+ * line or the layer sizes of a graph). A single writer thread runs them in batches
+ * and flushes the files it owns once per batch. When the queue is full, new tasks are
+ * dropped (and counted) instead of blocking the producer.
+ */
+class AsyncLogger {
+ public:
+  //! Buffered output files, only ever used from the writer thread
+  class Files {
+   public:
+    //! Get the stream for a file (opened for appending unless truncated)
+    std::ofstream& get(const std::string& filename, bool truncate = false);
+
+    inline bool isOpen(const std::string& filename) const {
+      return streams_.count(filename);
+    }
+
+    void flush();
+
+   private:
+    std::map<std::string, std::unique_ptr<std::ofstream>> streams_;
+  };
+
+  using Task = std::function<void(Files&)>;
+
+  explicit AsyncLogger(size_t max_queue_size = 100);
+
+  ~AsyncLogger();
+
+  AsyncLogger(const AsyncLogger& other) = delete;
+
+  AsyncLogger& operator=(const AsyncLogger& other) = delete;
+
+  //! Queue a task for the writer thread (returns false if it was dropped)
+  bool enqueue(Task task);
+
+  //! Start a file with a header (replacing any previous contents)
+  bool writeHeader(const std::string& filename, const std::string& header);
+
+  //! Append a line (without the newline) to a file
+  bool appendLine(const std::string& filename, const std::string& line);
+
+  //! Append the stats of every layer to <directory>/<layer name>_layer_stats.csv
+  bool logGraphStats(const std::string& directory, const GraphLogStats& stats);
+
+  //! Block until every queued task has been written
+  void flush();
+
+  //! Write the remaining tasks and join the writer thread
+  void stop();
+
+  size_t numDropped() const;
+
+ private:
+  void run();
+
+  const size_t max_queue_size_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<Task> queue_;
+  //! Tasks taken by the writer that haven't been written yet
+  size_t num_in_progress_ = 0;
+  size_t num_dropped_ = 0;
+  bool should_stop_ = false;
+
+  std::thread writer_thread_;
+};
+
+}  // namespace incremental
+}  // namespace hydra
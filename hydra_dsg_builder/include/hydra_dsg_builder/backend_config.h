@@ -92,6 +92,8 @@ struct DsgBackendConfig {
   bool optimize_on_lc = true;
   bool enable_node_merging = true;
   bool call_update_periodically = true;
+  //! Maximum rate of backend updates (0 for no limit)
+  double max_update_rate_hz = 0.0;
   std::map<LayerId, bool> merge_update_map{{DsgLayers::OBJECTS, false},
                                            {DsgLayers::PLACES, true},
                                            {DsgLayers::ROOMS, false},
@@ -145,6 +147,7 @@ void visit_config(const Visitor& v, DsgBackendConfig& config) {
   dsg_handle.visit("optimize_on_lc", config.optimize_on_lc);
   dsg_handle.visit("enable_node_merging", config.enable_node_merging);
   dsg_handle.visit("call_update_periodically", config.call_update_periodically);
+  dsg_handle.visit("max_update_rate_hz", config.max_update_rate_hz);
   dsg_handle.visit("merge_update_map", config.merge_update_map, EnableMapConverter());
   dsg_handle.visit("merge_update_dynamic", config.merge_update_dynamic);
   dsg_handle.visit("places_merge_pos_threshold_m", config.places_merge_pos_threshold_m);
@@ -0,0 +1,251 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace hydra {
+namespace incremental {
+
+struct UpdateQueueStats {
+  //! Updates currently pending (after coalescing)
+  size_t depth = 0;
+  //! Approximate memory used by the pending updates
+  size_t bytes = 0;
+  size_t num_pushed = 0;
+  //! Updates handed to the consumer (merged updates count once)
+  size_t num_popped = 0;
+  //! Updates merged into a newer update instead of being processed on their own
+  size_t num_coalesced = 0;
+  //! Times that every pending update was merged to get back within the budget
+  size_t num_budget_merges = 0;
+  //! Times that a producer waited for the consumer (see waitForBudget)
+  size_t num_waits = 0;
+  double total_wait_s = 0.0;
+  double max_wait_s = 0.0;
+};
+
+/**
+ * @brief Queue of incremental updates that merges pending updates instead of
+ * processing every intermediate state
+ *
+ * Consumers pop every pending update (up to a timestamp) as a single merged update.
+ * Updates are deltas, so they are never dropped: pushing past the memory budget
+ * merges every pending update into one (which is bounded by the size of the active
+ * window). Producers that can afford to block use waitForBudget to wait for the
+ * consumer when even the merged update doesn't fit. The update type needs a
+ * timestamp_ns field.
+ */
+template <typename Update>
+class CoalescingQueue {
+ public:
+  using ConstPtr = std::shared_ptr<const Update>;
+  using SizeFunction = std::function<size_t(const Update&)>;
+  //! Merge consecutive updates (oldest first) into a single update
+  using MergeFunction = std::function<ConstPtr(const std::vector<ConstPtr>&)>;
+
+  CoalescingQueue(size_t max_bytes,
+                  const SizeFunction& size_function,
+                  const MergeFunction& merge_function)
+      : max_bytes_(max_bytes), size_(size_function), merge_(merge_function) {}
+
+  CoalescingQueue(const CoalescingQueue& other) = delete;
+
+  CoalescingQueue& operator=(const CoalescingQueue& other) = delete;
+
+  //! Add an update (never blocks and never drops updates)
+  void push(const ConstPtr& update) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    ++stats_.num_pushed;
+    queue_.push_back({update, size_(*update), 1});
+    stats_.bytes += queue_.back().bytes;
+    if (stats_.bytes <= max_bytes_ || queue_.size() < 2) {
+      return;
+    }
+
+    // merging drops superseded state, leaving at most one version of the window
+    std::vector<Entry> pending(std::make_move_iterator(queue_.begin()),
+                               std::make_move_iterator(queue_.end()));
+    queue_.clear();
+    Entry merged = mergeEntries(pending);
+    stats_.bytes = merged.bytes;
+    ++stats_.num_budget_merges;
+    queue_.push_back(std::move(merged));
+  }
+
+  /**
+   * @brief Block until the pending updates fit in the budget
+   *
+   * Returns early if the queue is stopped. Only call this from producers that the
+   * consumer doesn't depend on to make progress.
+   */
+  void waitForBudget() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    const auto fits = [&] { return stopped_ || stats_.bytes <= max_bytes_; };
+    if (fits()) {
+      return;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    popped_cv_.wait(lock, fits);
+    const std::chrono::duration<double> waited =
+        std::chrono::steady_clock::now() - start;
+    ++stats_.num_waits;
+    stats_.total_wait_s += waited.count();
+    stats_.max_wait_s = std::max(stats_.max_wait_s, waited.count());
+  }
+
+  //! Release producers waiting on the budget (and stop them from waiting again)
+  void stop() {
+    {  // start queue critical section
+      std::unique_lock<std::mutex> lock(mutex_);
+      stopped_ = true;
+    }  // end queue critical section
+    popped_cv_.notify_all();
+  }
+
+  //! Merge and remove every pending update (nullptr if the queue is empty)
+  ConstPtr popAll() { return popUpTo(std::numeric_limits<uint64_t>::max()); }
+
+  //! Merge and remove every pending update up to (and including) timestamp_ns
+  ConstPtr popUpTo(uint64_t timestamp_ns) {
+    std::vector<Entry> to_merge;
+    {  // start queue critical section
+      std::unique_lock<std::mutex> lock(mutex_);
+      while (!queue_.empty() && queue_.front().update->timestamp_ns <= timestamp_ns) {
+        stats_.bytes -= queue_.front().bytes;
+        to_merge.push_back(std::move(queue_.front()));
+        queue_.pop_front();
+      }
+
+      if (to_merge.empty()) {
+        return nullptr;
+      }
+
+      ++stats_.num_popped;
+      for (const auto& entry : to_merge) {
+        stats_.num_coalesced += entry.num_updates;
+      }
+      --stats_.num_coalesced;  // the merged update itself is processed
+    }  // end queue critical section
+    popped_cv_.notify_all();
+
+    // merging happens outside the lock so producers aren't blocked
+    if (to_merge.size() == 1) {
+      return to_merge.front().update;
+    }
+
+    return mergeEntries(to_merge).update;
+  }
+
+  bool empty() const {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return queue_.empty();
+  }
+
+  std::optional<uint64_t> oldestTimestamp() const {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (queue_.empty()) {
+      return std::nullopt;
+    }
+
+    return queue_.front().update->timestamp_ns;
+  }
+
+  //! Timestamp of the newest pending update at or before timestamp_ns
+  std::optional<uint64_t> newestTimestampUpTo(uint64_t timestamp_ns) const {
+    std::unique_lock<std::mutex> lock(mutex_);
+    std::optional<uint64_t> newest;
+    for (const auto& entry : queue_) {
+      if (entry.update->timestamp_ns > timestamp_ns) {
+        break;
+      }
+
+      newest = entry.update->timestamp_ns;
+    }
+
+    return newest;
+  }
+
+  UpdateQueueStats getStats() const {
+    std::unique_lock<std::mutex> lock(mutex_);
+    UpdateQueueStats stats = stats_;
+    stats.depth = queue_.size();
+    return stats;
+  }
+
+ private:
+  struct Entry {
+    ConstPtr update;
+    size_t bytes;
+    //! Number of pushed updates merged into this entry
+    size_t num_updates;
+  };
+
+  Entry mergeEntries(const std::vector<Entry>& entries) const {
+    std::vector<ConstPtr> updates;
+    updates.reserve(entries.size());
+    size_t num_updates = 0;
+    for (const auto& entry : entries) {
+      updates.push_back(entry.update);
+      num_updates += entry.num_updates;
+    }
+
+    ConstPtr merged = merge_(updates);
+    return {merged, size_(*merged), num_updates};
+  }
+
+  const size_t max_bytes_;
+  const SizeFunction size_;
+  const MergeFunction merge_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable popped_cv_;
+  std::deque<Entry> queue_;
+  UpdateQueueStats stats_;
+  bool stopped_ = false;
+};
+
+}  // namespace incremental
+}  // namespace hydra
@@ -0,0 +1,139 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+
+namespace hydra {
+namespace incremental {
+
+//! Parts of the scene graph with their own lock (in the order they are locked)
+enum class DsgLockLayer : uint8_t { AGENTS = 0, OBJECTS = 1, PLACES = 2, MESH = 3 };
+
+/**
+ * @brief Declares which parts of the scene graph a critical section touches
+ *
+ * Exclusive access is required for anything that changes the structure of the graph
+ * (adding or removing nodes, edges or mesh vertices, or merging another graph in).
+ * Otherwise, a critical section may read the layers it reads or writes and may only
+ * modify the attributes of nodes in the layers it writes.
+ */
+struct DsgAccess {
+  //! Exclusive access to the entire graph
+  static DsgAccess Exclusive();
+
+  //! Shared access to the entire graph
+  static DsgAccess Shared();
+
+  DsgAccess& read(DsgLockLayer layer);
+
+  DsgAccess& write(DsgLockLayer layer);
+
+  bool exclusive = false;
+  uint8_t read_layers = 0;
+  uint8_t write_layers = 0;
+};
+
+//! Contention of a named critical section
+struct DsgLockStats {
+  size_t num_acquisitions = 0;
+  size_t num_contended = 0;
+  double total_wait_s = 0.0;
+  double max_wait_s = 0.0;
+};
+
+/**
+ * @brief Reader-writer lock for the scene graph with per-layer locks
+ *
+ * Lock ordering: the graph lock is always taken first, followed by the layer locks in
+ * DsgLockLayer order. A thread may only hold one guard per graph at a time, and when
+ * a section needs two graphs (e.g., the backend merging the frontend graph), the
+ * private graph is locked before the shared graph. Any other locks (e.g., the
+ * loop-closure queue) are taken after the graph locks.
+ */
+class DsgLock {
+ public:
+  static constexpr size_t kNumLayers = 4;
+
+  DsgLock() = default;
+
+  DsgLock(const DsgLock& other) = delete;
+
+  DsgLock& operator=(const DsgLock& other) = delete;
+
+  std::map<std::string, DsgLockStats> getStats() const;
+
+  //! Write the contention of every critical section to a csv file
+  void logStats(const std::string& filename) const;
+
+ private:
+  friend class DsgGuard;
+
+  void recordAcquisition(const std::string& name, bool contended, double wait_s);
+
+  std::shared_mutex graph_mutex_;
+  std::array<std::shared_mutex, kNumLayers> layer_mutexes_;
+
+  mutable std::mutex stats_mutex_;
+  std::map<std::string, DsgLockStats> stats_;
+};
+
+/**
+ * @brief Holds the locks for a critical section (see DsgAccess) until destroyed
+ *
+ * The name identifies the critical section in the contention statistics
+ */
+class DsgGuard {
+ public:
+  DsgGuard(DsgLock& lock, const DsgAccess& access, const std::string& name);
+
+  ~DsgGuard();
+
+  DsgGuard(const DsgGuard& other) = delete;
+
+  DsgGuard& operator=(const DsgGuard& other) = delete;
+
+ private:
+  DsgLock& lock_;
+  DsgAccess access_;
+};
+
+}  // namespace incremental
+}  // namespace hydra
@@ -42,11 +42,20 @@ struct DsgFrontendConfig {
   // TODO(nathan) consider unifying log path with backend
   bool should_log = true;
   std::string log_path;
-  size_t mesh_queue_size = 10;
+  //! Memory budget for pending mesh updates (updates are merged, never dropped)
+  double mesh_queue_max_mb = 100.0;
+  //! Memory budget for pending places updates
+  double places_queue_max_mb = 50.0;
   size_t min_object_vertices = 20;
   bool prune_mesh_indices = false;
   std::string sensor_frame = "base_link";
   std::string mesh_ns = "";
+  //! Receive places and mesh from the topology node (instead of in-process)
+  bool subscribe_to_active_topics = true;
+  //! Threads used to find the nearest places to new objects and agent poses
+  size_t place_query_threads = 1;
+  //! Maximum rate of mesh updates (0 for no limit)
+  double max_update_rate_hz = 0.0;
 };
 
 template <typename Visitor>
@@ -54,11 +63,15 @@ void visit_config(const Visitor& v, DsgFrontendConfig& config) {
   // TODO(nathan) replace with single param (derive should_log from log_path)
   v.visit("should_log", config.should_log);
   v.visit("log_path", config.log_path);
-  v.visit("mesh_queue_size", config.mesh_queue_size);
+  v.visit("mesh_queue_max_mb", config.mesh_queue_max_mb);
+  v.visit("places_queue_max_mb", config.places_queue_max_mb);
   v.visit("min_object_vertices", config.min_object_vertices);
   v.visit("prune_mesh_indices", config.prune_mesh_indices);
   v.visit("sensor_frame", config.sensor_frame);
   v.visit("mesh_ns", config.mesh_ns);
+  v.visit("subscribe_to_active_topics", config.subscribe_to_active_topics);
+  v.visit("place_query_threads", config.place_query_threads);
+  v.visit("max_update_rate_hz", config.max_update_rate_hz);
 }
 
 }  // namespace incremental
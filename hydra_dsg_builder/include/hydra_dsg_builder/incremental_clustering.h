@@ -0,0 +1,131 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <voxblox/core/common.h>
+
+#include <Eigen/Core>
+
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace hydra {
+namespace incremental {
+
+/**
+ * @brief Euclidean clustering that is maintained as points come and go
+ *
+ * Points are bucketed into a voxel grid with a cell size equal to the cluster
+ * tolerance (so neighbors are always in one of the 27 surrounding cells) and
+ * connected with a union-find. Adding a point only touches its neighborhood, and
+ * removing a point only re-clusters the cluster that contained it. Clusters keep
+ * their id across updates: a merged cluster keeps the id of the larger cluster and a
+ * split cluster keeps its id for the largest piece.
+ */
+class IncrementalClusterer {
+ public:
+  using PointGetter = std::function<Eigen::Vector3f(size_t)>;
+
+  struct ClusterInfo {
+    uint64_t id;
+    std::vector<size_t> indices;
+  };
+
+  IncrementalClusterer(double tolerance, size_t min_cluster_size, size_t max_cluster_size);
+
+  /**
+   * @brief Set the points to cluster
+   *
+   * Points that are new or moved since the last update are (re)inserted, and points
+   * that are missing from indices are removed. The per-point work is a single hash
+   * lookup for points that didn't change.
+   */
+  void update(const std::vector<size_t>& indices, const PointGetter& get_point);
+
+  //! Clusters within the size limits that changed since the last call
+  std::vector<ClusterInfo> popChangedClusters();
+
+  //! Report a cluster as changed by the next pop (no-op if the cluster is gone)
+  void markChanged(uint64_t cluster_id);
+
+  //! Ids of all clusters within the size limits
+  std::unordered_set<uint64_t> getClusterIds() const;
+
+  inline size_t numPoints() const { return points_.size(); }
+
+  inline size_t numClusters() const { return clusters_.size(); }
+
+ private:
+  struct PointInfo {
+    Eigen::Vector3f pos;
+    voxblox::GlobalIndex cell;
+    size_t parent;
+    uint64_t stamp;
+  };
+
+  using Grid = voxblox::LongIndexHashMapType<std::vector<size_t>>::type;
+
+  voxblox::GlobalIndex getCell(const Eigen::Vector3f& pos) const;
+
+  size_t findRoot(size_t index);
+
+  size_t merge(size_t lhs, size_t rhs);
+
+  void connectToNeighbors(size_t index);
+
+  void insertPoint(size_t index, const Eigen::Vector3f& pos);
+
+  void removePoints(const std::vector<size_t>& removed);
+
+  bool isValid(const ClusterInfo& cluster) const;
+
+  double tolerance_;
+  size_t min_cluster_size_;
+  size_t max_cluster_size_;
+
+  uint64_t stamp_;
+  uint64_t next_cluster_id_;
+  std::unordered_map<size_t, PointInfo> points_;
+  Grid grid_;
+  //! cluster info (members and persistent id) indexed by root point
+  std::unordered_map<size_t, ClusterInfo> clusters_;
+  //! points whose cluster changed since the last pop
+  std::unordered_set<size_t> changed_points_;
+};
+
+}  // namespace incremental
+}  // namespace hydra
@@ -33,6 +33,7 @@
  * purposes notwithstanding any copyright notation herein.
  * -------------------------------------------------------------------------- */
 #pragma once
+#include "hydra_dsg_builder/async_logger.h"
 #include "hydra_dsg_builder/backend_config.h"
 #include "hydra_dsg_builder/dsg_update_functions.h"
 #include "hydra_dsg_builder/incremental_room_finder.h"
@@ -40,7 +41,6 @@
 
 #include <hydra_utils/dsg_streaming_interface.h>
 #include <kimera_pgmo/KimeraPgmoInterface.h>
-#include <spark_dsg/scene_graph_logger.h>
 
 #include <ros/callback_queue.h>
 #include <ros/ros.h>
@@ -108,6 +108,7 @@ class DsgBackend : public kimera_pgmo::KimeraPgmoInterface {
     updateDsgMesh();
     callUpdateFunctions();
     private_dsg_->updated = true;
+    private_dsg_->update_event.notify();
   }
 
   bool updatePrivateDsg();
@@ -150,7 +151,7 @@ class DsgBackend : public kimera_pgmo::KimeraPgmoInterface {
 
   void updateBuildingNode();
 
-  void logStatus(bool init = false) const;
+  void logStatus(bool init = false);
 
   bool addInternalLCDToDeformationGraph();
 
@@ -202,8 +203,9 @@ class DsgBackend : public kimera_pgmo::KimeraPgmoInterface {
   ros::Publisher pose_graph_pub_;
   ros::Publisher opt_mesh_pub_;
 
-  SceneGraphLogger backend_graph_logger_;
   std::list<LoopClosureLog> loop_closures_;
+  //! Writes the graph and status logs off of the optimizer thread
+  AsyncLogger logger_;
 
  private:
   int robot_id_;
@@ -33,6 +33,9 @@
  * purposes notwithstanding any copyright notation herein.
  * -------------------------------------------------------------------------- */
 #pragma once
+#include "hydra_dsg_builder/active_window_index.h"
+#include "hydra_dsg_builder/async_logger.h"
+#include "hydra_dsg_builder/coalescing_queue.h"
 #include "hydra_dsg_builder/frontend_config.h"
 #include "hydra_dsg_builder/incremental_mesh_segmenter.h"
 #include "hydra_dsg_builder/incremental_types.h"
@@ -45,17 +48,20 @@
 #include <hydra_msgs/ActiveLayer.h>
 #include <hydra_msgs/ActiveMesh.h>
 #include <hydra_topology/nearest_neighbor_utilities.h>
+#include <hydra_topology/topology_outputs.h>
 #include <kimera_pgmo/MeshFrontend.h>
 #include <pose_graph_tools/PoseGraph.h>
-#include <spark_dsg/scene_graph_logger.h>
 
 #include <memory>
 #include <mutex>
+#include <optional>
 
 namespace hydra {
 namespace incremental {
 
 using PlacesLayerMsg = hydra_msgs::ActiveLayer;
+using topology::ActiveMeshUpdate;
+using topology::ActivePlacesUpdate;
 using topology::NearestNodeFinder;
 
 struct PlacesQueueState {
@@ -86,6 +92,15 @@ class DsgFrontend {
     return mesh_frontend_.getFullMeshTimes();
   }
 
+  //! Queue places from an in-process topology server (waits while over budget)
+  void addPlacesUpdate(const ActivePlacesUpdate::ConstPtr& update);
+
+  //! Queue a mesh from an in-process topology server (waits while over budget)
+  void addMeshUpdate(const ActiveMeshUpdate::ConstPtr& update);
+
+  //! Write the depth, coalescing and wait statistics of the input queues to a csv
+  void logQueueStats(const std::string& filename) const;
+
  private:
   void handleActivePlaces(const PlacesLayerMsg::ConstPtr& msg);
 
@@ -103,7 +118,7 @@ class DsgFrontend {
 
   PlacesQueueState getPlacesQueueState();
 
-  void processLatestPlacesMsg(const PlacesLayerMsg::ConstPtr& msg);
+  void processLatestPlaces(const ActivePlacesUpdate& update);
 
   void addPlaceObjectEdges(NodeIdSet* extra_objects_to_check = nullptr);
 
@@ -111,6 +126,9 @@ class DsgFrontend {
 
   void addAgentPlaceEdges();
 
+  //! Flag the graph as updated and wake up its readers
+  void publishGraphUpdate();
+
   std::optional<Eigen::Vector3d> getLatestPose();
 
  private:
@@ -122,14 +140,19 @@ class DsgFrontend {
   SharedDsgInfo::Ptr dsg_;
   kimera_pgmo::MeshFrontend mesh_frontend_;
   std::unique_ptr<MeshSegmenter> segmenter_;
+  //! Objects connected to the active mesh (the only ones that can lose vertices)
+  ActiveWindowIndex active_object_window_;
 
-  std::mutex mesh_frontend_mutex_;
   std::atomic<uint64_t> last_mesh_timestamp_;
-  std::queue<hydra_msgs::ActiveMesh::ConstPtr> mesh_queue_;
+  //! Pending mesh updates (merged so that only the newest blocks get processed)
+  std::unique_ptr<CoalescingQueue<ActiveMeshUpdate>> mesh_queue_;
 
-  std::mutex places_queue_mutex_;
   std::atomic<uint64_t> last_places_timestamp_;
-  std::queue<PlacesLayerMsg::ConstPtr> places_queue_;
+  //! Notified after the mesh or places queues or timestamps change
+  PipelineEvent stage_event_;
+  //! Pending places updates (merged up to the latest processed mesh)
+  std::unique_ptr<CoalescingQueue<ActivePlacesUpdate>> places_queue_;
+  std::optional<uint64_t> last_places_sequence_;
 
   ros::Subscriber mesh_sub_;
   std::unique_ptr<ros::CallbackQueue> mesh_frontend_ros_queue_;
@@ -149,7 +172,8 @@ class DsgFrontend {
   char robot_prefix_;
   ros::Subscriber pose_graph_sub_;
 
-  SceneGraphLogger frontend_graph_logger_;
+  //! Writes the graph stats off of the places thread
+  AsyncLogger logger_;
 };
 
 }  // namespace incremental
@@ -71,6 +71,8 @@ class DsgLcd {
 
   std::optional<NodeId> getLatestAgentId();
 
+  void updateLcdGraph();
+
  private:
   ros::NodeHandle nh_;
   std::atomic<bool> should_shutdown_{false};
@@ -84,6 +86,8 @@ class DsgLcd {
   std::unique_ptr<lcd::LcdVisualizer> lcd_visualizer_;
   std::unique_ptr<ros::CallbackQueue> visualizer_queue_;
   DynamicSceneGraph::Ptr lcd_graph_;
+  //! frontend update time that lcd_graph_ corresponds to
+  uint64_t lcd_graph_update_time_;
   // TODO(nathan) replace with struct passed in through constructor
   char robot_prefix_;
 
@@ -33,7 +33,10 @@
  * purposes notwithstanding any copyright notation herein.
  * -------------------------------------------------------------------------- */
 #pragma once
+#include "hydra_dsg_builder/incremental_clustering.h"
 #include "hydra_dsg_builder/incremental_types.h"
+#include "hydra_dsg_builder/mesh_vertex_labels.h"
+#include "hydra_dsg_builder/object_overlap_index.h"
 
 #include <hydra_utils/semantic_ros_publishers.h>
 #include <kimera_semantics/semantic_integrator_base.h>
@@ -51,6 +54,8 @@ struct Cluster {
   using PointT = pcl::PointXYZRGBA;
   using CloudT = pcl::PointCloud<PointT>;
   using CentroidT = pcl::CentroidPoint<pcl::PointXYZ>;
+  //! id of the cluster (persistent across detections)
+  uint64_t id;
   CentroidT centroid;
   CloudT::Ptr cloud;
   pcl::PointIndices indices;
@@ -63,12 +68,18 @@ class MeshSegmenter {
   using ObjectCloudPublishers = SemanticRosPublishers<uint8_t, MeshVertexCloud>;
   using Clusters = std::vector<Cluster>;
   using LabelClusters = std::map<uint8_t, Clusters>;
+  using ObjectIndices = std::map<NodeId, std::vector<size_t>>;
 
   explicit MeshSegmenter(const ros::NodeHandle& nh,
                          const MeshVertexCloud::Ptr& active_vertices);
 
   virtual ~MeshSegmenter();
 
+  //! Decode the labels of vertices added to the mesh since the last call
+  void updateVertexLabels();
+
+  inline const MeshVertexLabels& getVertexLabels() const { return vertex_labels_; }
+
   LabelClusters detectObjects(const std::vector<size_t>& active_indices,
                               const std::optional<Eigen::Vector3d>& pos);
 
@@ -78,15 +89,32 @@ class MeshSegmenter {
 
   void pruneObjectsToCheckForPlaces(const DynamicSceneGraph& graph);
 
-  void updateGraph(DynamicSceneGraph& graph,
-                   const LabelClusters& clusters,
-                   uint64_t timestamp);
+  /**
+   * @brief Add or update objects in the graph from the detected clusters
+   * @returns Mesh vertices of the clusters assigned to each object that was added or
+   * matched (and not pruned) in this update
+   */
+  ObjectIndices updateGraph(DynamicSceneGraph& graph,
+                            const LabelClusters& clusters,
+                            uint64_t timestamp);
+
+  //! Remove an object from the graph (its clusters are detected again)
+  void removeObject(DynamicSceneGraph& graph, NodeId node_id);
 
  private:
-  LabelClusters findNewObjectClusters(const std::vector<size_t>& active_indices) const;
+  LabelClusters findNewObjectClusters(const std::vector<size_t>& active_indices);
+
+  Cluster makeCluster(const IncrementalClusterer::ClusterInfo& info) const;
 
-  Clusters findClusters(const MeshVertexCloud::Ptr& cloud,
-                        const std::vector<size_t>& indices) const;
+  void refreshActiveObjects(uint64_t timestamp);
+
+  void pruneOverlappingObjects(DynamicSceneGraph& graph,
+                               uint8_t label,
+                               const std::set<NodeId>& to_check);
+
+  void removeActiveObject(DynamicSceneGraph& graph, uint8_t label, NodeId node_id);
+
+  void reassignClusters(uint8_t label, NodeId from_node, NodeId to_node);
 
   void archiveOldObjects(const DynamicSceneGraph& graph, uint64_t latest_timestamp);
 
@@ -119,9 +147,17 @@ class MeshSegmenter {
   size_t max_cluster_size_;
   std::map<uint8_t, std::set<NodeId>> active_objects_;
   std::map<NodeId, uint64_t> active_object_timestamps_;
+  ObjectOverlapIndex active_object_index_;
   std::unordered_set<NodeId> objects_to_check_for_places_;
 
+  std::map<uint8_t, IncrementalClusterer> clusterers_;
+  //! clusters that still exist after the latest detection
+  std::map<uint8_t, std::unordered_set<uint64_t>> live_clusters_;
+  //! object node that each cluster was last assigned to
+  std::map<uint8_t, std::map<uint64_t, NodeId>> cluster_objects_;
+
   std::set<uint8_t> object_labels_;
+  MeshVertexLabels vertex_labels_;
   bool enable_active_mesh_pub_;
   bool enable_segmented_mesh_pub_;
 
@@ -33,6 +33,9 @@
  * purposes notwithstanding any copyright notation herein.
  * -------------------------------------------------------------------------- */
 #pragma once
+#include "hydra_dsg_builder/dsg_lock.h"
+#include "hydra_dsg_builder/pipeline_events.h"
+
 #include <gtsam/geometry/Pose3.h>
 #include <hydra_utils/dsg_types.h>
 #include <kimera_pgmo/utils/CommonStructs.h>
@@ -79,9 +82,10 @@ struct SharedDsgInfo {
     latest_places.reset(new NodeIdSet);
   }
 
-  std::mutex mutex;
+  //! Guards the graph (archived_places and last_update_time go with the places)
+  DsgLock lock;
   std::atomic<bool> updated;
-  uint64_t last_update_time;
+  uint64_t last_update_time = 0;
   DynamicSceneGraph::Ptr graph;
   std::shared_ptr<NodeIdSet> latest_places;
 
@@ -90,6 +94,9 @@ struct SharedDsgInfo {
 
   std::mutex lcd_mutex;
   std::queue<lcd::DsgRegistrationSolution> loop_closures;
+
+  //! Notified after the graph, last_update_time or loop_closures change
+  PipelineEvent update_event;
 };
 
 struct DsgBackendStatus {
@@ -90,6 +90,8 @@ struct DsgLcdModuleConfig {
   std::string lcd_visualizer_ns = "/dsg/lcd_visualizer";
   double lcd_agent_horizon_s = 1.5;
   double descriptor_creation_horizon_m = 10.0;
+  //! Maximum rate of detection attempts (0 for no limit)
+  double max_update_rate_hz = 0.0;
 };
 
 namespace lcd {
@@ -147,6 +149,7 @@ void visit_config(const Visitor& v, DsgLcdModuleConfig& config) {
   v.visit("lcd_visualizer_ns", config.lcd_visualizer_ns);
   v.visit("lcd_agent_horizon_s", config.lcd_agent_horizon_s);
   v.visit("descriptor_creation_horizon_m", config.descriptor_creation_horizon_m);
+  v.visit("max_update_rate_hz", config.max_update_rate_hz);
 }
 
 }  // namespace hydra
@@ -0,0 +1,75 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace hydra {
+namespace incremental {
+
+/**
+ * @brief Semantic labels of the frontend mesh vertices, decoded once per vertex
+ *
+ * The frontend mesh only ever appends vertices, so every update only decodes the
+ * vertices added since the last update.
+ */
+class MeshVertexLabels {
+ public:
+  //! Decodes the label of the vertex with the provided index
+  using Decoder = std::function<uint8_t(size_t)>;
+
+  /**
+   * @brief Decode the labels of any new vertices
+   *
+   * If the mesh shrank (i.e., it was reset), all labels are decoded again
+   * @returns The number of vertices that were decoded
+   */
+  size_t update(size_t num_vertices, const Decoder& decode);
+
+  inline size_t size() const { return labels_.size(); }
+
+  inline bool hasLabel(size_t index) const { return index < labels_.size(); }
+
+  inline uint8_t getLabel(size_t index) const { return labels_.at(index); }
+
+  inline const std::vector<uint8_t>& getLabels() const { return labels_; }
+
+ private:
+  std::vector<uint8_t> labels_;
+};
+
+}  // namespace incremental
+}  // namespace hydra
@@ -0,0 +1,109 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <hydra_utils/dsg_types.h>
+#include <voxblox/core/common.h>
+
+#include <cstdint>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+namespace hydra {
+namespace incremental {
+
+/**
+ * @brief Spatial hash over object bounding boxes and positions, keyed by label
+ *
+ * Every object is registered in the cells of a uniform grid that overlap the
+ * axis-aligned bounds of its bounding box (for containment queries on points) and
+ * in the cell of its position (for containment queries on boxes). Queries only
+ * consider objects with the same label and return exact results in ascending node
+ * order, so callers can replace pairwise loops over sorted containers one-to-one.
+ */
+class ObjectOverlapIndex {
+ public:
+  explicit ObjectOverlapIndex(double cell_size = 1.0);
+
+  //! Add an object (or replace its label, bounding box and position)
+  void update(NodeId node,
+              uint8_t label,
+              const BoundingBox& bounding_box,
+              const Eigen::Vector3f& position);
+
+  void remove(NodeId node);
+
+  void clear();
+
+  inline bool contains(NodeId node) const { return entries_.count(node); }
+
+  inline size_t size() const { return entries_.size(); }
+
+  //! Objects with the label whose bounding box contains the point
+  std::vector<NodeId> findBoxesContaining(uint8_t label,
+                                          const Eigen::Vector3f& point) const;
+
+  //! Objects with the label whose position is inside the bounding box
+  std::vector<NodeId> findPositionsInside(uint8_t label,
+                                          const BoundingBox& bounding_box) const;
+
+  //! Axis-aligned bounds of a (possibly rotated) bounding box
+  static void getWorldBounds(const BoundingBox& bounding_box,
+                             Eigen::Vector3f& min,
+                             Eigen::Vector3f& max);
+
+ private:
+  using Grid = voxblox::LongIndexHashMapType<std::vector<NodeId>>::type;
+
+  struct Entry {
+    uint8_t label;
+    BoundingBox bounding_box;
+    Eigen::Vector3f position;
+    voxblox::GlobalIndex min_cell;
+    voxblox::GlobalIndex max_cell;
+  };
+
+  voxblox::GlobalIndex getCell(const Eigen::Vector3f& point) const;
+
+  static void eraseFromCell(Grid& grid, const voxblox::GlobalIndex& cell, NodeId node);
+
+  double cell_size_;
+  std::unordered_map<NodeId, Entry> entries_;
+  std::map<uint8_t, Grid> box_cells_;
+  std::map<uint8_t, Grid> position_cells_;
+};
+
+}  // namespace incremental
+}  // namespace hydra
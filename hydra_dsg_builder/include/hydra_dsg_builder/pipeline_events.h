@@ -0,0 +1,117 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+namespace hydra {
+namespace incremental {
+
+/**
+ * @brief Wakes up pipeline stages when one of their inputs changes
+ *
+ * Producers call notify() after pushing to a queue or finishing a step (i.e., after
+ * updating whatever state the consumers check). Consumers either wait for a condition
+ * on that state or for any notification since a generation they read before checking
+ * their inputs, so notifications that arrive while a stage is busy are never lost.
+ * The timeout only bounds how long a stage can miss state that changes without a
+ * notification (e.g., ros::ok()).
+ */
+class PipelineEvent {
+ public:
+  using Duration = std::chrono::nanoseconds;
+
+  //! Fallback wakeup period (the polling period that the events replace)
+  static constexpr Duration kDefaultTimeout = std::chrono::milliseconds(100);
+
+  PipelineEvent() = default;
+
+  PipelineEvent(const PipelineEvent& other) = delete;
+
+  PipelineEvent& operator=(const PipelineEvent& other) = delete;
+
+  void notify();
+
+  //! Number of notifications so far
+  uint64_t generation() const;
+
+  /**
+   * @brief Wait for a notification after the provided generation
+   * @returns The current generation (equal to since if the wait timed out)
+   */
+  uint64_t waitForChange(uint64_t since, Duration timeout = kDefaultTimeout);
+
+  /**
+   * @brief Wait until ready() holds (checked after every notification)
+   *
+   * ready() is called with the event locked, so it should only read atomics or take
+   * locks that are never held while calling notify()
+   * @returns Whether ready() held before the timeout
+   */
+  template <typename Predicate>
+  bool wait(Predicate&& ready, Duration timeout = kDefaultTimeout) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return cv_.wait_for(lock, timeout, std::forward<Predicate>(ready));
+  }
+
+ private:
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  uint64_t generation_ = 0;
+};
+
+/**
+ * @brief Limits how often a stage runs
+ *
+ * A maximum rate of zero (or less) disables the limit
+ */
+class RateThrottle {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit RateThrottle(double max_rate_hz);
+
+  //! Sleep for what is left of the minimum period since the last call
+  void throttle();
+
+ private:
+  Clock::duration min_period_;
+  Clock::time_point last_call_;
+};
+
+}  // namespace incremental
+}  // namespace hydra
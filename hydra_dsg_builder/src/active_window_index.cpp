@@ -0,0 +1,108 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_dsg_builder/active_window_index.h"
+
+#include <algorithm>
+
+namespace hydra {
+namespace incremental {
+
+void ActiveWindowIndex::addConnections(NodeId node,
+                                       const std::vector<size_t>& vertices) {
+  if (vertices.empty()) {
+    return;
+  }
+
+  auto& node_vertices = node_vertices_[node];
+  for (const auto vertex : vertices) {
+    if (node_vertices.insert(vertex).second) {
+      vertex_nodes_[vertex].insert(node);
+    }
+  }
+}
+
+void ActiveWindowIndex::removeNode(NodeId node) {
+  auto iter = node_vertices_.find(node);
+  if (iter == node_vertices_.end()) {
+    return;
+  }
+
+  for (const auto vertex : iter->second) {
+    auto vertex_iter = vertex_nodes_.find(vertex);
+    vertex_iter->second.erase(node);
+    if (vertex_iter->second.empty()) {
+      vertex_nodes_.erase(vertex_iter);
+    }
+  }
+
+  node_vertices_.erase(iter);
+}
+
+void ActiveWindowIndex::updateActiveVertices(
+    const std::vector<size_t>& active_vertices) {
+  const std::unordered_set<size_t> active(active_vertices.begin(),
+                                          active_vertices.end());
+  auto iter = vertex_nodes_.begin();
+  while (iter != vertex_nodes_.end()) {
+    if (active.count(iter->first)) {
+      ++iter;
+      continue;
+    }
+
+    for (const auto node : iter->second) {
+      auto node_iter = node_vertices_.find(node);
+      node_iter->second.erase(iter->first);
+      if (node_iter->second.empty()) {
+        node_vertices_.erase(node_iter);
+      }
+    }
+
+    iter = vertex_nodes_.erase(iter);
+  }
+}
+
+std::vector<NodeId> ActiveWindowIndex::getNodes() const {
+  std::vector<NodeId> nodes;
+  nodes.reserve(node_vertices_.size());
+  for (const auto& node_vertices_pair : node_vertices_) {
+    nodes.push_back(node_vertices_pair.first);
+  }
+
+  std::sort(nodes.begin(), nodes.end());
+  return nodes;
+}
+
+}  // namespace incremental
+}  // namespace hydra
@@ -0,0 +1,188 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_dsg_builder/async_logger.h"
+
+#include <glog/logging.h>
+
+namespace hydra {
+namespace incremental {
+
+GraphLogStats getGraphLogStats(const DynamicSceneGraph& graph,
+                               const std::map<LayerId, std::string>& layer_names,
+                               uint64_t timestamp_ns) {
+  GraphLogStats stats;
+  stats.timestamp_ns = timestamp_ns;
+  for (const auto& id_name_pair : layer_names) {
+    if (!graph.hasLayer(id_name_pair.first)) {
+      continue;
+    }
+
+    const auto& layer = graph.getLayer(id_name_pair.first);
+    stats.layers.push_back({id_name_pair.second, layer.numNodes(), layer.numEdges()});
+  }
+
+  return stats;
+}
+
+std::ofstream& AsyncLogger::Files::get(const std::string& filename, bool truncate) {
+  auto iter = streams_.find(filename);
+  if (iter != streams_.end() && !truncate) {
+    return *iter->second;
+  }
+
+  const auto mode = truncate ? std::ofstream::out | std::ofstream::trunc
+                             : std::ofstream::out | std::ofstream::app;
+  auto& stream = streams_[filename];
+  stream.reset(new std::ofstream(filename, mode));
+  if (!stream->good()) {
+    LOG(ERROR) << "[Async Logger] Failed to open " << filename;
+  }
+
+  return *stream;
+}
+
+void AsyncLogger::Files::flush() {
+  for (auto& filename_stream_pair : streams_) {
+    filename_stream_pair.second->flush();
+  }
+}
+
+AsyncLogger::AsyncLogger(size_t max_queue_size)
+    : max_queue_size_(max_queue_size), writer_thread_(&AsyncLogger::run, this) {}
+
+AsyncLogger::~AsyncLogger() { stop(); }
+
+bool AsyncLogger::enqueue(Task task) {
+  {  // start queue critical section
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (should_stop_ || queue_.size() >= max_queue_size_) {
+      ++num_dropped_;
+      return false;
+    }
+
+    queue_.push_back(std::move(task));
+  }  // end queue critical section
+
+  cv_.notify_all();
+  return true;
+}
+
+bool AsyncLogger::writeHeader(const std::string& filename, const std::string& header) {
+  return enqueue([filename, header](Files& files) {
+    files.get(filename, true) << header << "\n";
+  });
+}
+
+bool AsyncLogger::appendLine(const std::string& filename, const std::string& line) {
+  return enqueue(
+      [filename, line](Files& files) { files.get(filename) << line << "\n"; });
+}
+
+bool AsyncLogger::logGraphStats(const std::string& directory,
+                                const GraphLogStats& stats) {
+  return enqueue([directory, stats](Files& files) {
+    for (const auto& layer : stats.layers) {
+      const std::string filename = directory + "/" + layer.name + "_layer_stats.csv";
+      // files are started over on the first write of every run
+      const bool is_new = !files.isOpen(filename);
+      auto& output = files.get(filename, is_new);
+      if (is_new) {
+        output << "timestamp_ns,num_nodes,num_edges\n";
+      }
+
+      output << stats.timestamp_ns << "," << layer.num_nodes << "," << layer.num_edges
+             << "\n";
+    }
+  });
+}
+
+void AsyncLogger::flush() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  cv_.wait(lock, [&] { return queue_.empty() && num_in_progress_ == 0; });
+}
+
+void AsyncLogger::stop() {
+  {  // start queue critical section
+    std::unique_lock<std::mutex> lock(mutex_);
+    should_stop_ = true;
+  }  // end queue critical section
+
+  cv_.notify_all();
+  if (!writer_thread_.joinable()) {
+    return;  // already stopped
+  }
+
+  writer_thread_.join();
+
+  const size_t num_dropped = numDropped();
+  if (num_dropped) {
+    LOG(WARNING) << "[Async Logger] Dropped " << num_dropped
+                 << " log entries because the queue was full";
+  }
+}
+
+size_t AsyncLogger::numDropped() const {
+  std::unique_lock<std::mutex> lock(mutex_);
+  return num_dropped_;
+}
+
+void AsyncLogger::run() {
+  Files files;
+  std::deque<Task> batch;
+  while (true) {
+    {  // start queue critical section
+      std::unique_lock<std::mutex> lock(mutex_);
+      num_in_progress_ = 0;
+      cv_.notify_all();  // wake up flush()
+      cv_.wait(lock, [&] { return should_stop_ || !queue_.empty(); });
+      if (queue_.empty()) {
+        break;  // stopping and everything has been written
+      }
+
+      batch.swap(queue_);
+      num_in_progress_ = batch.size();
+    }  // end queue critical section
+
+    for (auto& task : batch) {
+      task(files);
+    }
+
+    batch.clear();
+    files.flush();
+  }
+}
+
+}  // namespace incremental
+}  // namespace hydra
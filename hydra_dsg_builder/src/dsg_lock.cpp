@@ -0,0 +1,187 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_dsg_builder/dsg_lock.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <fstream>
+#include <vector>
+
+namespace hydra {
+namespace incremental {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// graphs locked by the current thread (to catch self-deadlocks)
+thread_local std::vector<const DsgLock*> tl_held_locks;
+
+inline uint8_t layerMask(DsgLockLayer layer) {
+  return static_cast<uint8_t>(1u << static_cast<uint8_t>(layer));
+}
+
+template <typename Mutex>
+bool lockExclusive(Mutex& mutex) {
+  if (mutex.try_lock()) {
+    return false;
+  }
+
+  mutex.lock();
+  return true;
+}
+
+template <typename Mutex>
+bool lockShared(Mutex& mutex) {
+  if (mutex.try_lock_shared()) {
+    return false;
+  }
+
+  mutex.lock_shared();
+  return true;
+}
+
+}  // namespace
+
+constexpr size_t DsgLock::kNumLayers;
+
+DsgAccess DsgAccess::Exclusive() {
+  DsgAccess access;
+  access.exclusive = true;
+  return access;
+}
+
+DsgAccess DsgAccess::Shared() {
+  DsgAccess access;
+  access.read_layers = (1u << DsgLock::kNumLayers) - 1;
+  return access;
+}
+
+DsgAccess& DsgAccess::read(DsgLockLayer layer) {
+  read_layers |= layerMask(layer);
+  return *this;
+}
+
+DsgAccess& DsgAccess::write(DsgLockLayer layer) {
+  write_layers |= layerMask(layer);
+  return *this;
+}
+
+std::map<std::string, DsgLockStats> DsgLock::getStats() const {
+  std::unique_lock<std::mutex> lock(stats_mutex_);
+  return stats_;
+}
+
+void DsgLock::logStats(const std::string& filename) const {
+  const auto stats = getStats();
+  std::ofstream output_file(filename);
+  output_file << "name,num_acquisitions,num_contended,total_wait_s,max_wait_s\n";
+  for (const auto& name_stats_pair : stats) {
+    const auto& entry = name_stats_pair.second;
+    output_file << name_stats_pair.first << "," << entry.num_acquisitions << ","
+                << entry.num_contended << "," << entry.total_wait_s << ","
+                << entry.max_wait_s << "\n";
+  }
+}
+
+void DsgLock::recordAcquisition(const std::string& name,
+                                bool contended,
+                                double wait_s) {
+  std::unique_lock<std::mutex> lock(stats_mutex_);
+  auto& entry = stats_[name];
+  ++entry.num_acquisitions;
+  if (!contended) {
+    return;
+  }
+
+  ++entry.num_contended;
+  entry.total_wait_s += wait_s;
+  entry.max_wait_s = std::max(entry.max_wait_s, wait_s);
+}
+
+DsgGuard::DsgGuard(DsgLock& lock, const DsgAccess& access, const std::string& name)
+    : lock_(lock), access_(access) {
+  CHECK(std::find(tl_held_locks.begin(), tl_held_locks.end(), &lock_) ==
+        tl_held_locks.end())
+      << "scene graph is already locked by this thread (at " << name << ")";
+
+  // writing a layer implies reading it
+  access_.read_layers &= ~access_.write_layers;
+
+  const auto start = Clock::now();
+  bool contended = false;
+  if (access_.exclusive) {
+    contended |= lockExclusive(lock_.graph_mutex_);
+  } else {
+    contended |= lockShared(lock_.graph_mutex_);
+    for (size_t i = 0; i < DsgLock::kNumLayers; ++i) {
+      const uint8_t mask = static_cast<uint8_t>(1u << i);
+      if (access_.write_layers & mask) {
+        contended |= lockExclusive(lock_.layer_mutexes_[i]);
+      } else if (access_.read_layers & mask) {
+        contended |= lockShared(lock_.layer_mutexes_[i]);
+      }
+    }
+  }
+
+  const std::chrono::duration<double> wait_s = Clock::now() - start;
+  lock_.recordAcquisition(name, contended, wait_s.count());
+  tl_held_locks.push_back(&lock_);
+}
+
+DsgGuard::~DsgGuard() {
+  tl_held_locks.erase(std::find(tl_held_locks.begin(), tl_held_locks.end(), &lock_));
+
+  if (access_.exclusive) {
+    lock_.graph_mutex_.unlock();
+    return;
+  }
+
+  // release in the reverse order of acquisition
+  for (size_t i = DsgLock::kNumLayers; i > 0; --i) {
+    const uint8_t mask = static_cast<uint8_t>(1u << (i - 1));
+    if (access_.write_layers & mask) {
+      lock_.layer_mutexes_[i - 1].unlock();
+    } else if (access_.read_layers & mask) {
+      lock_.layer_mutexes_[i - 1].unlock_shared();
+    }
+  }
+
+  lock_.graph_mutex_.unlock_shared();
+}
+
+}  // namespace incremental
+}  // namespace hydra
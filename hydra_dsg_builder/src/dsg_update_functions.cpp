@@ -34,13 +34,17 @@
  * -------------------------------------------------------------------------- */
 #include "hydra_dsg_builder/dsg_update_functions.h"
 #include "hydra_dsg_builder/incremental_room_finder.h"
+#include "hydra_dsg_builder/object_overlap_index.h"
 
 #include <gtsam/geometry/Pose3.h>
+#include <hydra_topology/mesh_connections.h>
 #include <pcl/common/centroid.h>
 #include <pcl/point_types.h>
 
 #include <glog/logging.h>
 
+#include <algorithm>
+
 namespace hydra {
 namespace dsg_updates {
 
@@ -60,7 +64,8 @@ std::map<NodeId, NodeId> updateObjects(DynamicSceneGraph& graph,
   MeshVertices::Ptr mesh = graph.getMeshVertices();
 
   std::map<NodeId, NodeId> nodes_to_merge;
-  std::map<SemanticLabel, std::vector<NodeId>> semantic_nodes_map;
+  // objects that can still be merged into, keyed by label
+  incremental::ObjectOverlapIndex merge_targets;
   for (const auto& id_node_pair : layer.nodes()) {
     auto& attrs = id_node_pair.second->attributes<ObjectNodeAttributes>();
 
@@ -101,44 +106,42 @@ std::map<NodeId, NodeId> updateObjects(DynamicSceneGraph& graph,
 
     if (allow_node_merging) {
       bool to_be_merged = false;
-      // TODO(yun) faster and smarter way to find overlap?
-      if (semantic_nodes_map.count(attrs.semantic_label) > 0) {
-        for (const auto& node_target_id : semantic_nodes_map[attrs.semantic_label]) {
-          if (graph.hasEdge(id_node_pair.first, node_target_id)) {
-            // Do not merge two nodes already connected by an edge
-            continue;
-          }
-
-          const Node& node_target = layer.getNode(node_target_id).value();
-          auto& attrs_target = node_target.attributes<ObjectNodeAttributes>();
-          // Check for overlap
-          if (attrs.bounding_box.isInside(attrs_target.position)) {
-            const bool curr_bigger =
-                attrs.bounding_box.volume() > attrs_target.bounding_box.volume();
-            VLOG(2) << "Merging " << NodeSymbol(id_node_pair.first).getLabel() << " ["
-                    << attrs.bounding_box.volume() << "] "
-                    << (curr_bigger ? " <- " : " -> ")
-                    << NodeSymbol(node_target_id).getLabel() << " ["
-                    << attrs_target.bounding_box.volume() << "]";
-
-            if (curr_bigger) {
-              nodes_to_merge[node_target_id] = id_node_pair.first;
-            } else {
-              nodes_to_merge[id_node_pair.first] = node_target_id;
-            }
-            to_be_merged = true;
-            break;
-            // TODO(Yun) Merge ones with larger overlap? For now assume more
-            // will be merged next round
-          }
+      // candidates are sorted, so earlier nodes are still preferred
+      const auto candidates =
+          merge_targets.findPositionsInside(attrs.semantic_label, attrs.bounding_box);
+      for (const auto& node_target_id : candidates) {
+        if (graph.hasEdge(id_node_pair.first, node_target_id)) {
+          // Do not merge two nodes already connected by an edge
+          continue;
         }
-      } else {
-        semantic_nodes_map[attrs.semantic_label] = std::vector<NodeId>();
+
+        const Node& node_target = layer.getNode(node_target_id).value();
+        auto& attrs_target = node_target.attributes<ObjectNodeAttributes>();
+        const bool curr_bigger =
+            attrs.bounding_box.volume() > attrs_target.bounding_box.volume();
+        VLOG(2) << "Merging " << NodeSymbol(id_node_pair.first).getLabel() << " ["
+                << attrs.bounding_box.volume() << "] "
+                << (curr_bigger ? " <- " : " -> ")
+                << NodeSymbol(node_target_id).getLabel() << " ["
+                << attrs_target.bounding_box.volume() << "]";
+
+        if (curr_bigger) {
+          nodes_to_merge[node_target_id] = id_node_pair.first;
+        } else {
+          nodes_to_merge[id_node_pair.first] = node_target_id;
+        }
+        to_be_merged = true;
+        break;
+        // TODO(Yun) Merge ones with larger overlap? For now assume more
+        // will be merged next round
       }
 
       if (!to_be_merged) {
         // Prohibit merging to a node that is already to be merged
-        semantic_nodes_map[attrs.semantic_label].push_back(id_node_pair.first);
+        merge_targets.update(id_node_pair.first,
+                             attrs.semantic_label,
+                             attrs.bounding_box,
+                             attrs.position.cast<float>());
       }
     }
   }
@@ -156,6 +159,27 @@ std::map<NodeId, NodeId> updateObjects(DynamicSceneGraph& graph,
   return nodes_to_merge;
 }
 
+// keeps the mesh attachments of a place that is about to be merged into another
+void mergePlaceMeshConnections(const SceneGraphLayer& layer, NodeId from, NodeId to) {
+  const auto& from_attrs =
+      layer.getNode(from).value().get().attributes<PlaceNodeAttributes>();
+  auto& to_attrs = layer.getNode(to).value().get().attributes<PlaceNodeAttributes>();
+  topology::mergeMeshConnections(from_attrs.voxblox_mesh_connections,
+                                 to_attrs.voxblox_mesh_connections);
+
+  if (from_attrs.pcl_mesh_connections.empty()) {
+    return;
+  }
+
+  auto& pcl_connections = to_attrs.pcl_mesh_connections;
+  pcl_connections.insert(pcl_connections.end(),
+                         from_attrs.pcl_mesh_connections.begin(),
+                         from_attrs.pcl_mesh_connections.end());
+  std::sort(pcl_connections.begin(), pcl_connections.end());
+  pcl_connections.erase(std::unique(pcl_connections.begin(), pcl_connections.end()),
+                        pcl_connections.end());
+}
+
 std::map<NodeId, NodeId> updatePlaces(DynamicSceneGraph& graph,
                                       const gtsam::Values& values,
                                       const gtsam::Values&,
@@ -228,6 +252,7 @@ std::map<NodeId, NodeId> updatePlaces(DynamicSceneGraph& graph,
     VLOG(1) << "In DSG update, found " << nodes_to_merge.size()
             << " pairs of overlapping places. Merging...";
     for (const auto& node_pair : nodes_to_merge) {
+      mergePlaceMeshConnections(layer, node_pair.first, node_pair.second);
       graph.mergeNodes(node_pair.first, node_pair.second);
       VLOG(3) << "merging " << NodeSymbol(node_pair.first).getLabel() << " -> "
               << NodeSymbol(node_pair.second).getLabel();
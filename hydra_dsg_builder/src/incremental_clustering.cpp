@@ -0,0 +1,299 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_dsg_builder/incremental_clustering.h"
+
+#include <glog/logging.h>
+
+#include <cmath>
+
+namespace hydra {
+namespace incremental {
+
+using voxblox::GlobalIndex;
+using ClusterInfo = IncrementalClusterer::ClusterInfo;
+
+IncrementalClusterer::IncrementalClusterer(double tolerance,
+                                           size_t min_cluster_size,
+                                           size_t max_cluster_size)
+    : tolerance_(tolerance),
+      min_cluster_size_(min_cluster_size),
+      max_cluster_size_(max_cluster_size),
+      stamp_(0),
+      next_cluster_id_(0) {
+  CHECK_GT(tolerance_, 0.0);
+}
+
+void IncrementalClusterer::update(const std::vector<size_t>& indices,
+                                  const PointGetter& get_point) {
+  ++stamp_;
+
+  std::vector<size_t> removed;
+  std::vector<std::pair<size_t, Eigen::Vector3f>> added;
+  for (const auto idx : indices) {
+    const Eigen::Vector3f pos = get_point(idx);
+    auto iter = points_.find(idx);
+    if (iter == points_.end()) {
+      added.emplace_back(idx, pos);
+      continue;
+    }
+
+    iter->second.stamp = stamp_;
+    if (iter->second.pos != pos) {
+      removed.push_back(idx);
+      added.emplace_back(idx, pos);
+    }
+  }
+
+  for (const auto& idx_info_pair : points_) {
+    if (idx_info_pair.second.stamp != stamp_) {
+      removed.push_back(idx_info_pair.first);
+    }
+  }
+
+  // removals first: a removal only needs to re-cluster the points that are left
+  removePoints(removed);
+  for (const auto& idx_pos_pair : added) {
+    insertPoint(idx_pos_pair.first, idx_pos_pair.second);
+  }
+}
+
+std::vector<ClusterInfo> IncrementalClusterer::popChangedClusters() {
+  std::unordered_set<size_t> roots;
+  for (const auto idx : changed_points_) {
+    roots.insert(findRoot(idx));
+  }
+  changed_points_.clear();
+
+  std::vector<ClusterInfo> changed;
+  for (const auto root : roots) {
+    const auto& cluster = clusters_.at(root);
+    if (isValid(cluster)) {
+      changed.push_back(cluster);
+    }
+  }
+
+  return changed;
+}
+
+void IncrementalClusterer::markChanged(uint64_t cluster_id) {
+  for (const auto& root_cluster_pair : clusters_) {
+    if (root_cluster_pair.second.id == cluster_id) {
+      changed_points_.insert(root_cluster_pair.first);
+      return;
+    }
+  }
+}
+
+std::unordered_set<uint64_t> IncrementalClusterer::getClusterIds() const {
+  std::unordered_set<uint64_t> ids;
+  for (const auto& root_cluster_pair : clusters_) {
+    if (isValid(root_cluster_pair.second)) {
+      ids.insert(root_cluster_pair.second.id);
+    }
+  }
+
+  return ids;
+}
+
+GlobalIndex IncrementalClusterer::getCell(const Eigen::Vector3f& pos) const {
+  GlobalIndex cell;
+  for (int i = 0; i < 3; ++i) {
+    cell(i) = static_cast<voxblox::LongIndexElement>(std::floor(pos(i) / tolerance_));
+  }
+  return cell;
+}
+
+size_t IncrementalClusterer::findRoot(size_t index) {
+  size_t root = index;
+  while (true) {
+    PointInfo& info = points_.at(root);
+    if (info.parent == root) {
+      return root;
+    }
+
+    // path halving
+    info.parent = points_.at(info.parent).parent;
+    root = info.parent;
+  }
+}
+
+size_t IncrementalClusterer::merge(size_t lhs, size_t rhs) {
+  size_t root = findRoot(lhs);
+  size_t other = findRoot(rhs);
+  if (root == other) {
+    return root;
+  }
+
+  if (clusters_.at(root).indices.size() < clusters_.at(other).indices.size()) {
+    std::swap(root, other);
+  }
+
+  // the larger cluster keeps its id and absorbs the members of the smaller one
+  points_.at(other).parent = root;
+  auto& members = clusters_.at(root).indices;
+  const auto& other_members = clusters_.at(other).indices;
+  members.insert(members.end(), other_members.begin(), other_members.end());
+  clusters_.erase(other);
+  return root;
+}
+
+void IncrementalClusterer::connectToNeighbors(size_t index) {
+  const Eigen::Vector3f pos = points_.at(index).pos;
+  const GlobalIndex cell = points_.at(index).cell;
+  const double tolerance_sq = tolerance_ * tolerance_;
+
+  for (int dx = -1; dx <= 1; ++dx) {
+    for (int dy = -1; dy <= 1; ++dy) {
+      for (int dz = -1; dz <= 1; ++dz) {
+        const auto iter = grid_.find(cell + GlobalIndex(dx, dy, dz));
+        if (iter == grid_.end()) {
+          continue;
+        }
+
+        for (const auto other : iter->second) {
+          if (other == index) {
+            continue;
+          }
+
+          if ((points_.at(other).pos - pos).squaredNorm() <= tolerance_sq) {
+            merge(index, other);
+          }
+        }
+      }
+    }
+  }
+}
+
+void IncrementalClusterer::insertPoint(size_t index, const Eigen::Vector3f& pos) {
+  if (points_.count(index)) {
+    return;  // duplicate index in the input
+  }
+
+  const GlobalIndex cell = getCell(pos);
+  points_.emplace(index, PointInfo{pos, cell, index, stamp_});
+  grid_[cell].push_back(index);
+  clusters_.emplace(index, ClusterInfo{next_cluster_id_++, {index}});
+
+  connectToNeighbors(index);
+  changed_points_.insert(index);
+}
+
+void IncrementalClusterer::removePoints(const std::vector<size_t>& removed) {
+  std::unordered_set<size_t> removed_set;
+  std::unordered_set<size_t> roots;
+  for (const auto idx : removed) {
+    if (!points_.count(idx) || removed_set.count(idx)) {
+      continue;
+    }
+
+    removed_set.insert(idx);
+    roots.insert(findRoot(idx));
+  }
+
+  for (const auto idx : removed_set) {
+    const auto cell_iter = grid_.find(points_.at(idx).cell);
+    CHECK(cell_iter != grid_.end());
+    auto& cell_points = cell_iter->second;
+    for (size_t i = 0; i < cell_points.size(); ++i) {
+      if (cell_points[i] == idx) {
+        cell_points[i] = cell_points.back();
+        cell_points.pop_back();
+        break;
+      }
+    }
+
+    if (cell_points.empty()) {
+      grid_.erase(cell_iter);
+    }
+  }
+
+  // only the clusters that lost points need to be re-clustered: all neighbors of
+  // their remaining points belonged to the same cluster
+  for (const auto root : roots) {
+    const ClusterInfo prev = std::move(clusters_.at(root));
+    clusters_.erase(root);
+
+    std::vector<size_t> remaining;
+    remaining.reserve(prev.indices.size());
+    for (const auto idx : prev.indices) {
+      if (removed_set.count(idx)) {
+        continue;
+      }
+
+      remaining.push_back(idx);
+      points_.at(idx).parent = idx;
+      clusters_[idx] = ClusterInfo{0, {idx}};
+    }
+
+    for (const auto idx : remaining) {
+      connectToNeighbors(idx);
+    }
+
+    std::unordered_set<size_t> new_roots;
+    size_t largest_root = 0;
+    size_t largest_size = 0;
+    for (const auto idx : remaining) {
+      const size_t new_root = findRoot(idx);
+      if (!new_roots.insert(new_root).second) {
+        continue;
+      }
+
+      const size_t size = clusters_.at(new_root).indices.size();
+      if (size > largest_size) {
+        largest_root = new_root;
+        largest_size = size;
+      }
+    }
+
+    for (const auto new_root : new_roots) {
+      clusters_.at(new_root).id =
+          (new_root == largest_root) ? prev.id : next_cluster_id_++;
+      changed_points_.insert(new_root);
+    }
+  }
+
+  for (const auto idx : removed_set) {
+    points_.erase(idx);
+    changed_points_.erase(idx);
+  }
+}
+
+bool IncrementalClusterer::isValid(const ClusterInfo& cluster) const {
+  return cluster.indices.size() >= min_cluster_size_ &&
+         cluster.indices.size() <= max_cluster_size_;
+}
+
+}  // namespace incremental
+}  // namespace hydra
@@ -41,6 +41,8 @@
 
 #include <glog/logging.h>
 
+#include <sstream>
+
 namespace hydra {
 namespace incremental {
 
@@ -107,12 +109,7 @@ DsgBackend::DsgBackend(const ros::NodeHandle nh,
   deformation_graph_->storeOnlyNoOptimization();
 
   if (config_.should_log) {
-    backend_graph_logger_.setOutputPath(config_.log_path + "/backend");
     ROS_INFO("Logging backend graph to %s", (config_.log_path + "/backend").c_str());
-    backend_graph_logger_.setLayerName(DsgLayers::OBJECTS, "objects");
-    backend_graph_logger_.setLayerName(DsgLayers::PLACES, "places");
-    backend_graph_logger_.setLayerName(DsgLayers::ROOMS, "rooms");
-    backend_graph_logger_.setLayerName(DsgLayers::BUILDINGS, "buildings");
   } else {
     ROS_ERROR("DSG Backend logging disabled. ");
   }
@@ -124,6 +121,7 @@ DsgBackend::DsgBackend(const ros::NodeHandle nh,
 void DsgBackend::stop() {
   LOG(INFO) << "[DSG Backend] stopping!";
   should_shutdown_ = true;
+  shared_dsg_->update_event.notify();
 
   VLOG(2) << " [DSG Backend] joining optimizer thread";
   if (optimizer_thread_) {
@@ -131,6 +129,9 @@ void DsgBackend::stop() {
     optimizer_thread_.reset();
   }
   VLOG(2) << " [DSG Backend] joined optimizer thread";
+
+  // write out the logs from the last updates
+  logger_.stop();
 }
 
 DsgBackend::~DsgBackend() {
@@ -144,11 +145,16 @@ void DsgBackend::start() {
 }
 
 bool DsgBackend::updatePrivateDsg() {
-  std::unique_lock<std::mutex> graph_lock(private_dsg_->mutex);
-  bool have_frontend_updates = shared_dsg_->updated;
+  DsgGuard guard(private_dsg_->lock, DsgAccess::Exclusive(), "backend/private_update");
+  // cleared before merging so that later updates aren't missed
+  const bool have_frontend_updates = shared_dsg_->updated.exchange(false);
   if (have_frontend_updates) {
+    uint64_t frontend_update_time;
     {  // start joint critical section
-      std::unique_lock<std::mutex> shared_graph_lock(shared_dsg_->mutex);
+      // reading the removed places clears them
+      DsgGuard shared_guard(shared_dsg_->lock,
+                            DsgAccess::Shared().write(DsgLockLayer::PLACES),
+                            "backend/shared_merge");
       private_dsg_->graph->mergeGraph(*shared_dsg_->graph,
                                       merged_nodes_,
                                       false,
@@ -156,6 +162,7 @@ bool DsgBackend::updatePrivateDsg() {
                                       &config_.merge_update_map,
                                       config_.merge_update_dynamic);
       *private_dsg_->latest_places = *shared_dsg_->latest_places;
+      frontend_update_time = shared_dsg_->last_update_time;
 
       if (shared_dsg_->graph->hasLayer(DsgLayers::PLACES)) {
         // TODO(nathan) simplify
@@ -167,11 +174,17 @@ bool DsgBackend::updatePrivateDsg() {
           shared_places_copy_.removeNode(place_id);
         }
       }
-      shared_dsg_->updated = false;
     }  // end joint critical section
 
     if (config_.should_log) {
-      backend_graph_logger_.logGraph(private_dsg_->graph);
+      // only the layer sizes are handed to the writer thread
+      logger_.logGraphStats(config_.log_path + "/backend",
+                            getGraphLogStats(*private_dsg_->graph,
+                                             {{DsgLayers::OBJECTS, "objects"},
+                                              {DsgLayers::PLACES, "places"},
+                                              {DsgLayers::ROOMS, "rooms"},
+                                              {DsgLayers::BUILDINGS, "buildings"}},
+                                             frontend_update_time));
     }
   }
 
@@ -268,8 +281,10 @@ bool DsgBackend::readPgmoUpdates() {
 }
 
 void DsgBackend::runPgmo() {
-  ros::WallRate r(10);
+  RateThrottle throttle(config_.max_update_rate_hz);
   while (ros::ok()) {
+    // read before checking the inputs so that changes while checking aren't missed
+    const uint64_t generation = shared_dsg_->update_event.generation();
     status_.reset();
     ScopedTimer spin_timer("backend/spin", last_timestamp_);
     const size_t prev_loop_closures = num_loop_closures_;
@@ -313,11 +328,10 @@ void DsgBackend::runPgmo() {
 
     if (was_updated) {
       private_dsg_->updated = true;
+      private_dsg_->update_event.notify();
       ros::Time stamp;
       stamp.fromNSec(last_timestamp_);
       dsg_sender_->sendGraph(*private_dsg_->graph, stamp);
-    } else {
-      r.sleep();
     }
 
     if (should_shutdown_ && !have_graph_updates_ && !have_dsg_updates) {
@@ -325,6 +339,13 @@ void DsgBackend::runPgmo() {
     }
 
     have_graph_updates_ = false;
+
+    if (was_updated) {
+      throttle.throttle();
+    } else {
+      // the frontend, lcd and pgmo callbacks notify when there's new input
+      shared_dsg_->update_event.waitForChange(generation);
+    }
   }
 
   // TODO(nathan) figure this out instead of forcing an update before exiting
@@ -341,21 +362,31 @@ void DsgBackend::fullMeshCallback(const KimeraPgmoMesh::ConstPtr& msg) {
 }
 
 void DsgBackend::deformationGraphCallback(const PoseGraph::ConstPtr& msg) {
-  std::unique_lock<std::mutex> lock(pgmo_mutex_);
-  deformation_graph_updates_.push(msg);
-  last_timestamp_ = msg->header.stamp.toNSec();
+  {  // start pgmo critical section
+    std::unique_lock<std::mutex> lock(pgmo_mutex_);
+    deformation_graph_updates_.push(msg);
+    last_timestamp_ = msg->header.stamp.toNSec();
+  }  // end pgmo critical section
+
+  shared_dsg_->update_event.notify();
 }
 
 void DsgBackend::poseGraphCallback(const PoseGraph::ConstPtr& msg) {
-  std::unique_lock<std::mutex> lock(pgmo_mutex_);
-  pose_graph_updates_.push(msg);
+  {  // start pgmo critical section
+    std::unique_lock<std::mutex> lock(pgmo_mutex_);
+    pose_graph_updates_.push(msg);
+  }  // end pgmo critical section
+
+  shared_dsg_->update_event.notify();
 }
 
 bool DsgBackend::saveMeshCallback(std_srvs::Empty::Request&,
                                   std_srvs::Empty::Response&) {
   pcl::PolygonMesh opt_mesh;
   {
-    std::unique_lock<std::mutex> graph_lock(private_dsg_->mutex);
+    DsgGuard guard(private_dsg_->lock,
+                   DsgAccess().read(DsgLockLayer::MESH),
+                   "backend/save_mesh");
     opt_mesh = private_dsg_->graph->getMesh();
   }
   // Save mesh
@@ -518,7 +549,7 @@ void DsgBackend::updateDsgMesh(bool force_mesh_update) {
                                                  interp_horizon_);
   {
     // start private dsg critical section
-    std::unique_lock<std::mutex> graph_lock(private_dsg_->mutex);
+    DsgGuard guard(private_dsg_->lock, DsgAccess::Exclusive(), "backend/set_mesh");
     private_dsg_->graph->setMeshDirectly(opt_mesh);
   }
 
@@ -583,7 +614,7 @@ void DsgBackend::callUpdateFunctions(const gtsam::Values& places_values,
                                      const gtsam::Values& pgmo_values) {
   ScopedTimer spin_timer("backend/update_layers", last_timestamp_);
   {  // start private dsg critical section
-    std::unique_lock<std::mutex> graph_lock(private_dsg_->mutex);
+    DsgGuard guard(private_dsg_->lock, DsgAccess::Exclusive(), "backend/update_layers");
     for (const auto& update_func : dsg_update_funcs_) {
       auto merged_nodes = update_func(*private_dsg_->graph,
                                       places_values,
@@ -649,7 +680,7 @@ void DsgBackend::updateRoomsNodes() {
 
 void DsgBackend::updateBuildingNode() {
   const NodeSymbol node_id('B', 0);
-  std::unique_lock<std::mutex> lock(private_dsg_->mutex);
+  DsgGuard guard(private_dsg_->lock, DsgAccess::Exclusive(), "backend/building");
   const auto& rooms = private_dsg_->graph->getLayer(DsgLayers::ROOMS);
 
   if (!rooms.numNodes()) {
@@ -682,31 +713,30 @@ void DsgBackend::updateBuildingNode() {
   }
 }
 
-void DsgBackend::logStatus(bool init) const {
-  std::ofstream file;
+void DsgBackend::logStatus(bool init) {
   std::string filename = config_.pgmo.log_path + std::string("/dsg_pgmo_status.csv");
   if (init) {
     ROS_INFO("DSG Backend logging PGMO status output to %s", filename.c_str());
-    file.open(filename);
     // file format
-    file << "total_lc,new_lc,total_factors,total_values,new_factors,new_graph_"
-            "factors,trajectory_len,run_time,optimize_time,mesh_update_time\n";
-    file.close();
+    logger_.writeHeader(filename,
+                        "total_lc,new_lc,total_factors,total_values,new_factors,new_"
+                        "graph_factors,trajectory_len,run_time,optimize_time,mesh_"
+                        "update_time");
     return;
   }
 
+  // formatting is cheap, so only the file I/O is left to the writer thread
   const auto& timer = hydra::timing::ElapsedTimeRecorder::instance();
   const double nan = std::numeric_limits<double>::quiet_NaN();
-  file.open(filename, std::ofstream::out | std::ofstream::app);
-  file << status_.total_loop_closures_ << "," << status_.new_loop_closures_ << ","
+  std::stringstream line;
+  line << status_.total_loop_closures_ << "," << status_.new_loop_closures_ << ","
        << status_.total_factors_ << "," << status_.total_values_ << ","
        << status_.new_factors_ << "," << status_.new_graph_factors_ << ","
        << status_.trajectory_len_ << ","
        << timer.getLastElapsed("backend/spin").value_or(nan) << ","
        << timer.getLastElapsed("backend/optimization").value_or(nan) << ","
-       << timer.getLastElapsed("backend/mesh_update").value_or(nan) << std::endl;
-  file.close();
-  return;
+       << timer.getLastElapsed("backend/mesh_update").value_or(nan);
+  logger_.appendLine(filename, line.str());
 }
 
 void DsgBackend::visualizePoseGraph() const {
@@ -36,13 +36,19 @@
 #include "hydra_dsg_builder/incremental_dsg_frontend.h"
 #include "hydra_dsg_builder/incremental_dsg_lcd.h"
 
+#include <hydra_topology/topology_server.h>
+#include <hydra_utils/metric_utilities.h>
 #include <hydra_utils/timing_utilities.h>
+#include <kimera_semantics_ros/semantic_tsdf_server.h>
+#include <ros/callback_queue.h>
 #include <ros/topic_manager.h>
 #include <std_srvs/Empty.h>
+#include <voxblox_ros/tsdf_server.h>
 
 using hydra::DsgLayers;
 using hydra::LayerId;
 using hydra::incremental::SharedDsgInfo;
+using hydra::metrics::MetricRecorder;
 using hydra::timing::ElapsedTimeRecorder;
 
 enum class ExitMode { CLOCK, SERVICE, NORMAL };
@@ -115,6 +121,40 @@ void spinUntilExitRequested() {
   ROS_WARN("Exiting!");
 }
 
+template <typename TsdfServer>
+std::shared_ptr<void> makeTopologyServer(const ros::NodeHandle& nh,
+                                         hydra::incremental::DsgFrontend& frontend) {
+  auto server = std::make_shared<hydra::topology::TopologyServer<TsdfServer>>(nh);
+  server->addMeshCallback([&frontend](const auto& update) {
+    frontend.addMeshUpdate(update);
+  });
+  server->addPlacesCallback([&frontend](const auto& update) {
+    frontend.addPlacesUpdate(update);
+  });
+  return server;
+}
+
+// hosts the topology server in this process, handing off places and mesh without
+// serializing them. Parameters live under ~topology and callbacks run on their own
+// queue to keep GVD updates off of the main spinner
+std::shared_ptr<void> startTopologyServer(const ros::NodeHandle& nh,
+                                          ros::CallbackQueue& queue,
+                                          hydra::incremental::DsgFrontend& frontend) {
+  ros::NodeHandle topology_nh(nh, "topology");
+  topology_nh.setCallbackQueue(&queue);
+  if (!topology_nh.hasParam("publish_active_topics")) {
+    topology_nh.setParam("publish_active_topics", false);
+  }
+
+  bool use_semantic_tsdf_server = false;
+  topology_nh.getParam("use_semantic_tsdf_server", use_semantic_tsdf_server);
+  if (use_semantic_tsdf_server) {
+    return makeTopologyServer<kimera::SemanticTsdfServer>(topology_nh, frontend);
+  } else {
+    return makeTopologyServer<voxblox::TsdfServer>(topology_nh, frontend);
+  }
+}
+
 std::optional<uint64_t> getTimeNs(const hydra::DynamicSceneGraph& graph,
                                   gtsam::Symbol key) {
   hydra::NodeSymbol node(key.chr(), key.index());
@@ -147,6 +187,13 @@ int main(int argc, char* argv[]) {
   bool enable_lcd = false;
   nh.getParam("enable_lcd", enable_lcd);
 
+  bool host_topology_server = false;
+  nh.getParam("host_topology_server", host_topology_server);
+  if (host_topology_server) {
+    // the frontend gets places and mesh directly from the topology server
+    nh.setParam("subscribe_to_active_topics", false);
+  }
+
   nh.getParam("disable_timer_output", ElapsedTimeRecorder::instance().disable_output);
 
   const LayerId mesh_layer_id = 1;
@@ -176,6 +223,15 @@ int main(int argc, char* argv[]) {
       lcd->start();
     }
 
+    ros::CallbackQueue topology_queue;
+    std::shared_ptr<void> topology_server;
+    std::unique_ptr<ros::AsyncSpinner> topology_spinner;
+    if (host_topology_server) {
+      topology_server = startTopologyServer(nh, topology_queue, frontend);
+      topology_spinner.reset(new ros::AsyncSpinner(1, &topology_queue));
+      topology_spinner->start();
+    }
+
     switch (exit_mode) {
       case ExitMode::CLOCK:
         spinWhileClockPresent();
@@ -189,6 +245,12 @@ int main(int argc, char* argv[]) {
         break;
     }
 
+    if (topology_spinner) {
+      topology_spinner->stop();
+      topology_spinner.reset();
+      topology_server.reset();
+    }
+
     frontend.stop();
     if (lcd) {
       lcd->stop();
@@ -199,6 +261,7 @@ int main(int argc, char* argv[]) {
     if (!dsg_output_path.empty()) {
       frontend_mesh = frontend.getFrontendMesh();
       frontend_mesh_times = frontend.getFrontendMeshStamps();
+      frontend.logQueueStats(dsg_output_path + "/frontend/queue_stats.csv");
     }
 
     if (!dsg_output_path.empty()) {
@@ -224,6 +287,9 @@ int main(int argc, char* argv[]) {
     const ElapsedTimeRecorder& timer = ElapsedTimeRecorder::instance();
     timer.logAllElapsed(dsg_output_path);
     timer.logStats(dsg_output_path);
+    MetricRecorder::instance().logAllMetrics(dsg_output_path);
+    frontend_dsg->lock.logStats(dsg_output_path + "/frontend/lock_stats.csv");
+    backend_dsg->lock.logStats(dsg_output_path + "/backend/lock_stats.csv");
     LOG(INFO) << "[DSG Node] Saved scene graph, stats, and logs to " << dsg_output_path;
 
     const std::string output_csv = dsg_output_path + "/loop_closures.csv";
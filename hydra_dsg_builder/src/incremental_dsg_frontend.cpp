@@ -34,6 +34,8 @@
  * -------------------------------------------------------------------------- */
 #include "hydra_dsg_builder/incremental_dsg_frontend.h"
 
+#include <hydra_topology/layer_encoding.h>
+#include <hydra_topology/mesh_connections.h>
 #include <hydra_utils/timing_utilities.h>
 #include <kimera_pgmo/utils/CommonFunctions.h>
 #include <tf2_eigen/tf2_eigen.h>
@@ -59,11 +61,21 @@ DsgFrontend::DsgFrontend(const ros::NodeHandle& nh, const SharedDsgInfo::Ptr& ds
   last_mesh_timestamp_ = 0;
   last_places_timestamp_ = 0;
 
+  mesh_queue_.reset(new CoalescingQueue<ActiveMeshUpdate>(
+      static_cast<size_t>(config_.mesh_queue_max_mb * 1.0e6),
+      [](const ActiveMeshUpdate& update) {
+        return topology::estimateMemoryUsage(update);
+      },
+      &topology::mergeActiveMeshUpdates));
+  places_queue_.reset(new CoalescingQueue<ActivePlacesUpdate>(
+      static_cast<size_t>(config_.places_queue_max_mb * 1.0e6),
+      [](const ActivePlacesUpdate& update) {
+        return topology::estimateMemoryUsage(update);
+      },
+      &topology::mergeActivePlacesUpdates));
+
   if (config_.should_log) {
-    frontend_graph_logger_.setOutputPath(config_.log_path + "/frontend");
     ROS_INFO("Logging frontend graph to %s", (config_.log_path + "/frontend").c_str());
-    frontend_graph_logger_.setLayerName(DsgLayers::OBJECTS, "objects");
-    frontend_graph_logger_.setLayerName(DsgLayers::PLACES, "places");
   }
 }
 
@@ -71,6 +83,11 @@ void DsgFrontend::stop() {
   VLOG(2) << "[DSG Frontend] stopping frontend!";
 
   should_shutdown_ = true;
+  stage_event_.notify();
+  // nothing consumes the queues anymore, so producers can't wait on them
+  mesh_queue_->stop();
+  places_queue_->stop();
+  const bool was_running = mesh_frontend_thread_ || places_thread_;
   if (mesh_frontend_thread_) {
     VLOG(2) << "[DSG Frontend] joining mesh thread";
     mesh_frontend_thread_->join();
@@ -84,6 +101,15 @@ void DsgFrontend::stop() {
     places_thread_.reset();
     VLOG(2) << "[DSG Frontend] joined places thread";
   }
+
+  if (was_running) {
+    // the places thread may have advanced the graph after the last mesh update, and
+    // readers (e.g., the lcd) drain their queues against the final graph
+    publishGraphUpdate();
+  }
+
+  // write out the logs from the last updates
+  logger_.stop();
 }
 
 DsgFrontend::~DsgFrontend() {
@@ -92,23 +118,72 @@ DsgFrontend::~DsgFrontend() {
 }
 
 void DsgFrontend::handleActivePlaces(const PlacesLayerMsg::ConstPtr& msg) {
-  std::unique_lock<std::mutex> queue_lock(places_queue_mutex_);
-  places_queue_.push(msg);
+  auto update = std::make_shared<ActivePlacesUpdate>();
+  update->timestamp_ns = msg->header.stamp.toNSec();
+  std::unique_ptr<SceneGraphLayer::Edges> edges =
+      topology::decodeLayer(msg->layer_contents, update->layer);
+  if (!edges) {
+    LOG(ERROR) << "[DSG Frontend] Dropping places update "
+               << msg->sequence_number << " with invalid contents";
+    return;
+  }
+
+  update->edges = std::move(*edges);
+  update->sequence_number = msg->sequence_number;
+  update->is_full_update = msg->is_full_update;
+  update->deleted_nodes.assign(msg->deleted_nodes.begin(), msg->deleted_nodes.end());
+  update->archived_nodes.assign(msg->archived_nodes.begin(), msg->archived_nodes.end());
+
+  CHECK_EQ(msg->removed_edge_sources.size(), msg->removed_edge_targets.size());
+  for (size_t i = 0; i < msg->removed_edge_sources.size(); ++i) {
+    update->removed_edges.emplace_back(msg->removed_edge_sources[i],
+                                       msg->removed_edge_targets[i]);
+  }
+
+  // the subscriber shares the spinner with the mesh, so it can't wait on the budget
+  places_queue_->push(update);
+  stage_event_.notify();
+}
+
+void DsgFrontend::addPlacesUpdate(const ActivePlacesUpdate::ConstPtr& update) {
+  places_queue_->push(update);
+  stage_event_.notify();
+  // the matching mesh was queued first, so the consumer never waits on this producer
+  places_queue_->waitForBudget();
 }
 
 void DsgFrontend::handleLatestMesh(const hydra_msgs::ActiveMesh::ConstPtr& msg) {
-  {  // start mesh frontend critical section
-    std::unique_lock<std::mutex> mesh_lock(mesh_frontend_mutex_);
-    if (mesh_queue_.size() < config_.mesh_queue_size) {
-      mesh_queue_.push(msg);
-      return;
-    }
-  }  // end mesh frontend critical section
+  auto update = std::make_shared<ActiveMeshUpdate>();
+  update->timestamp_ns = msg->header.stamp.toNSec();
+  // subscriber messages are immutable, so the update aliases the message instead of
+  // copying every block on the callback thread (the message lives as long as the
+  // update does). The blocks are converted by the mesh frontend thread.
+  update->mesh = voxblox_msgs::Mesh::ConstPtr(msg, &msg->mesh);
+  update->archived_blocks = voxblox_msgs::Mesh::ConstPtr(msg, &msg->archived_blocks);
+  mesh_queue_->push(update);
+  stage_event_.notify();
+}
+
+void DsgFrontend::addMeshUpdate(const ActiveMeshUpdate::ConstPtr& update) {
+  mesh_queue_->push(update);
+  stage_event_.notify();
+  mesh_queue_->waitForBudget();
+}
 
-  // we warn outside to keep I/O out of the way of the mutex
-  ROS_WARN_STREAM("[DSG Frontend] Dropping mesh update @ "
-                  << msg->header.stamp.toSec() << " [s] (" << msg->header.stamp.toNSec()
-                  << " [ns])");
+void DsgFrontend::logQueueStats(const std::string& filename) const {
+  std::ofstream output_file(filename);
+  output_file << "name,depth,bytes,num_pushed,num_popped,num_coalesced,"
+              << "num_budget_merges,num_waits,total_wait_s,max_wait_s\n";
+  const std::map<std::string, UpdateQueueStats> stats{
+      {"mesh", mesh_queue_->getStats()}, {"places", places_queue_->getStats()}};
+  for (const auto& name_stats_pair : stats) {
+    const auto& entry = name_stats_pair.second;
+    output_file << name_stats_pair.first << "," << entry.depth << "," << entry.bytes
+                << "," << entry.num_pushed << "," << entry.num_popped << ","
+                << entry.num_coalesced << "," << entry.num_budget_merges << ","
+                << entry.num_waits << "," << entry.total_wait_s << ","
+                << entry.max_wait_s << "\n";
+  }
 }
 
 void DsgFrontend::handleLatestPoseGraph(const PoseGraph::ConstPtr& msg) {
@@ -116,7 +191,7 @@ void DsgFrontend::handleLatestPoseGraph(const PoseGraph::ConstPtr& msg) {
     return;
   }
 
-  std::unique_lock<std::mutex> lock(dsg_->mutex);
+  DsgGuard guard(dsg_->lock, DsgAccess::Exclusive(), "frontend/pose_graph");
   const auto& agents = dsg_->graph->getLayer(DsgLayers::AGENTS, robot_prefix_);
 
   for (const auto& node : msg->nodes) {
@@ -178,7 +253,9 @@ void DsgFrontend::startMeshFrontend() {
 
   mesh_frontend_thread_.reset(new std::thread(&DsgFrontend::runMeshFrontend, this));
 
-  mesh_sub_ = nh_.subscribe("voxblox_mesh", 5, &DsgFrontend::handleLatestMesh, this);
+  if (config_.subscribe_to_active_topics) {
+    mesh_sub_ = nh_.subscribe("voxblox_mesh", 5, &DsgFrontend::handleLatestMesh, this);
+  }
 }
 
 std::optional<Eigen::Vector3d> DsgFrontend::getLatestPose() {
@@ -202,90 +279,125 @@ std::optional<Eigen::Vector3d> DsgFrontend::getLatestPose() {
 }
 
 void DsgFrontend::runMeshFrontend() {
-  ros::WallRate r(10);
+  RateThrottle throttle(config_.max_update_rate_hz);
   while (ros::ok() && !should_shutdown_) {
+    // read before checking the inputs so that changes while checking aren't missed
+    const uint64_t generation = stage_event_.generation();
+
     // identify if the places thread is waiting on a new mesh message
     PlacesQueueState state = getPlacesQueueState();
     bool newer_place_msg = !state.empty && state.timestamp_ns > last_mesh_timestamp_;
 
     if (last_mesh_timestamp_ > last_places_timestamp_ && !newer_place_msg) {
-      r.sleep();  // the mesh thread is running ahead, spin for a little bit
+      // the mesh thread is running ahead, wait for the places thread
+      stage_event_.waitForChange(generation);
       continue;
     }
 
-    hydra_msgs::ActiveMesh::ConstPtr msg(nullptr);
-    {  // start mesh critical region
-      std::unique_lock<std::mutex> mesh_lock(mesh_frontend_mutex_);
-      if (!mesh_queue_.empty()) {
-        msg = mesh_queue_.front();
-        mesh_queue_.pop();
-      }
-    }  // end mesh critical region
-
-    if (!msg) {
-      r.sleep();
+    if (mesh_queue_->empty()) {
+      stage_event_.waitForChange(generation);
       continue;
     }
 
-    voxblox_msgs::Mesh::ConstPtr mesh_msg(new voxblox_msgs::Mesh(msg->mesh));
+    throttle.throttle();
+
+    // everything that arrived while we were busy (or throttled) is merged so that
+    // superseded blocks are never processed
+    const ActiveMeshUpdate::ConstPtr update = mesh_queue_->popAll();
+
+    // the places thread can't take places for this mesh until the timestamp is set
+    const size_t places_merges = places_queue_->getStats().num_budget_merges;
+    const bool places_will_match =
+        places_queue_->newestTimestampUpTo(update->timestamp_ns) ==
+        update->timestamp_ns;
 
     // let the places thread start working on queued messages
-    last_mesh_timestamp_ = msg->header.stamp.toNSec();
-    uint64_t object_timestamp = msg->header.stamp.toNSec();
+    last_mesh_timestamp_ = update->timestamp_ns;
+    stage_event_.notify();
+    uint64_t object_timestamp = update->timestamp_ns;
     {  // start timing scope
       ScopedTimer timer(
           "frontend/mesh_compression", last_mesh_timestamp_, true, 1, false);
 
       mesh_frontend_ros_queue_->callAvailable(ros::WallDuration(0.0));
-      mesh_frontend_.voxbloxCallback(mesh_msg);
+      mesh_frontend_.voxbloxCallback(update->getMesh());
+    }  // end timing scope
+
+    {  // start timing scope
+      ScopedTimer timer("frontend/vertex_labels", last_mesh_timestamp_, true, 1, false);
+      segmenter_->updateVertexLabels();
     }  // end timing scope
 
-    mesh_frontend_.clearArchivedMeshFull(msg->archived_blocks);
+    mesh_frontend_.clearArchivedMeshFull(*update->archived_blocks);
     LabelClusters object_clusters;
 
     {  // timing scope
       ScopedTimer timer("frontend/object_detection", object_timestamp, true, 1, false);
       const auto& invalid_indices = mesh_frontend_.getInvalidIndices();
       {  // start dsg critical section
-        std::unique_lock<std::mutex> lock(dsg_->mutex);
+        DsgGuard guard(dsg_->lock, DsgAccess::Exclusive(), "frontend/mesh_update");
         for (const auto& idx : invalid_indices) {
           dsg_->graph->invalidateMeshVertex(idx);
         }
 
+        // only objects connected to the previous active window can lose vertices
         std::vector<NodeId> objects_to_delete;
-        const auto& objects = dsg_->graph->getLayer(DsgLayers::OBJECTS);
-        for (const auto& id_node_pair : objects.nodes()) {
-          auto connections = dsg_->graph->getMeshConnectionIndices(id_node_pair.first);
+        for (const auto& node_id : active_object_window_.getNodes()) {
+          if (!dsg_->graph->hasNode(node_id)) {
+            active_object_window_.removeNode(node_id);
+            continue;
+          }
+
+          auto connections = dsg_->graph->getMeshConnectionIndices(node_id);
           if (connections.size() < config_.min_object_vertices) {
-            objects_to_delete.push_back(id_node_pair.first);
+            objects_to_delete.push_back(node_id);
           }
         }
 
         for (const auto& node : objects_to_delete) {
-          dsg_->graph->removeNode(node);
+          segmenter_->removeObject(*dsg_->graph, node);
+          active_object_window_.removeNode(node);
         }
       }  // end dsg critical section
 
-      object_clusters = segmenter_->detectObjects(
-          mesh_frontend_.getActiveFullMeshVertices(), getLatestPose());
+      const auto& active_indices = mesh_frontend_.getActiveFullMeshVertices();
+      active_object_window_.updateActiveVertices(active_indices);
+      object_clusters = segmenter_->detectObjects(active_indices, getLatestPose());
     }
 
     {  // start dsg critical section
       ScopedTimer timer("frontend/object_graph_update", last_places_timestamp_);
-      std::unique_lock<std::mutex> lock(dsg_->mutex);
-      segmenter_->updateGraph(*dsg_->graph, object_clusters, last_places_timestamp_);
+      DsgGuard guard(dsg_->lock, DsgAccess::Exclusive(), "frontend/object_update");
+      const auto updated_objects = segmenter_->updateGraph(
+          *dsg_->graph, object_clusters, last_places_timestamp_);
+      // every object that was added or matched is connected to these (active) vertices
+      for (const auto& id_indices_pair : updated_objects) {
+        active_object_window_.addConnections(id_indices_pair.first,
+                                             id_indices_pair.second);
+      }
+
       addPlaceObjectEdges();
     }  // end dsg critical section
 
-    if (state.timestamp_ns != last_mesh_timestamp_) {
-      dsg_->updated = true;
-      continue;  // places dropped a message or is ahead of us, so we don't need
+    if (!places_will_match) {
+      publishGraphUpdate();
+      continue;  // places merged the message or is ahead of us, so we don't need
                  // to update the mapping
     }
 
-    // wait for the places thread to finish the latest message
-    while (!should_shutdown_ && last_mesh_timestamp_ > last_places_timestamp_) {
-      r.sleep();
+    // wait for the places thread to finish the latest message (unless the matching
+    // places were merged into a newer update in the meantime)
+    const auto places_caught_up = [&] {
+      return should_shutdown_ || last_mesh_timestamp_ <= last_places_timestamp_ ||
+             places_queue_->getStats().num_budget_merges != places_merges;
+    };
+    while (ros::ok() && !places_caught_up()) {
+      stage_event_.wait(places_caught_up);
+    }
+
+    if (last_mesh_timestamp_ > last_places_timestamp_) {
+      publishGraphUpdate();
+      continue;
     }
 
     {
@@ -293,61 +405,74 @@ void DsgFrontend::runMeshFrontend() {
       updatePlaceMeshMapping();
     }
 
-    dsg_->updated = true;
+    publishGraphUpdate();
   }
+
+  // release an in-process producer waiting on the budget
+  mesh_queue_->stop();
+}
+
+void DsgFrontend::publishGraphUpdate() {
+  dsg_->updated = true;
+  dsg_->update_event.notify();
 }
 
 void DsgFrontend::startPlaces() {
-  active_places_sub_ =
-      nh_.subscribe("active_places", 5, &DsgFrontend::handleActivePlaces, this);
+  if (config_.subscribe_to_active_topics) {
+    active_places_sub_ =
+        nh_.subscribe("active_places", 5, &DsgFrontend::handleActivePlaces, this);
+  }
 
   places_thread_.reset(new std::thread(&DsgFrontend::runPlaces, this));
 }
 
 PlacesQueueState DsgFrontend::getPlacesQueueState() {
-  std::unique_lock<std::mutex> places_lock(places_queue_mutex_);
-  if (places_queue_.empty()) {
+  const auto oldest_ns = places_queue_->oldestTimestamp();
+  if (!oldest_ns) {
     return {};
   }
 
-  return {false, places_queue_.front()->header.stamp.toNSec()};
+  return {false, *oldest_ns};
 }
 
 void DsgFrontend::runPlaces() {
-  ros::WallRate r(10);
   while (ros::ok() && !should_shutdown_) {
+    const uint64_t generation = stage_event_.generation();
     PlacesQueueState state = getPlacesQueueState();
     if (state.empty || state.timestamp_ns > last_mesh_timestamp_) {
-      // we only sleep if there's no pending work
-      r.sleep();
+      // we only wait if there's no pending work (or the mesh for it isn't ready)
+      stage_event_.waitForChange(generation);
       continue;
     }
 
-    // we only peek at the current message (to gate mesh processing)
-    PlacesLayerMsg::ConstPtr curr_message;
-    {  // start places queue critical section
-      std::unique_lock<std::mutex> places_lock(places_queue_mutex_);
-      curr_message = places_queue_.front();
-    }  // end places queue critical section
+    // every update that the mesh has caught up to is merged into one (the mesh
+    // thread waits on last_places_timestamp_, not the queue)
+    const ActivePlacesUpdate::ConstPtr curr_message =
+        places_queue_->popUpTo(last_mesh_timestamp_);
+    if (!curr_message) {
+      continue;
+    }
 
-    processLatestPlacesMsg(curr_message);
+    processLatestPlaces(*curr_message);
 
     // note that we don't need a mutex because this is the same thread as
     // processLatestPlacesMsg
     auto latest_places = *dsg_->latest_places;
 
-    // pop the most recently processed message (to inform mesh processing that the
-    // timestamp is valid)
-    {  // start places queue critical section
-      std::unique_lock<std::mutex> places_lock(places_queue_mutex_);
-      places_queue_.pop();
-    }  // end places queue critical section
-
     {  // start graph update critical section
-      std::unique_lock<std::mutex> graph_lock(dsg_->mutex);
-
-      // find node ids that are valid, but outside active place window
-      for (const auto& prev : previous_active_places_) {
+      // archiving only changes place attributes
+      DsgGuard guard(dsg_->lock,
+                     DsgAccess().write(DsgLockLayer::PLACES),
+                     "frontend/places_archive");
+
+      // find node ids that are valid, but outside active place window (merged
+      // updates can also archive places that were never active on their own)
+      std::vector<NodeId> archived_candidates(previous_active_places_.begin(),
+                                              previous_active_places_.end());
+      archived_candidates.insert(archived_candidates.end(),
+                                 curr_message->archived_nodes.begin(),
+                                 curr_message->archived_nodes.end());
+      for (const auto& prev : archived_candidates) {
         if (latest_places.count(prev)) {
           continue;
         }
@@ -368,37 +493,73 @@ void DsgFrontend::runPlaces() {
         dsg_->archived_places.insert(prev);
       }
 
-      dsg_->last_update_time = curr_message->header.stamp.toNSec();
+      dsg_->last_update_time = curr_message->timestamp_ns;
     }  // end graph update critical section
 
     previous_active_places_ = latest_places;
 
     // TODO(nathan) consider moving timestamp solely to dsg structure
-    last_places_timestamp_ = curr_message->header.stamp.toNSec();
+    last_places_timestamp_ = curr_message->timestamp_ns;
+    stage_event_.notify();
+    dsg_->update_event.notify();
 
     if (config_.should_log) {
-      std::unique_lock<std::mutex> graph_lock(dsg_->mutex);
-      frontend_graph_logger_.logGraph(dsg_->graph);
+      GraphLogStats stats;
+      {  // start graph critical section
+        DsgGuard guard(dsg_->lock, DsgAccess::Shared(), "frontend/log");
+        stats = getGraphLogStats(*dsg_->graph,
+                                 {{DsgLayers::OBJECTS, "objects"},
+                                  {DsgLayers::PLACES, "places"}},
+                                 curr_message->timestamp_ns);
+      }  // end graph critical section
+
+      logger_.logGraphStats(config_.log_path + "/frontend", stats);
     }
+
     // dsg_->updated = true;
   }
+
+  // release an in-process producer waiting on the budget
+  places_queue_->stop();
 }
 
-void DsgFrontend::processLatestPlacesMsg(const PlacesLayerMsg::ConstPtr& msg) {
-  const uint64_t msg_time_ns = msg->header.stamp.toNSec();
+void DsgFrontend::processLatestPlaces(const ActivePlacesUpdate& update) {
+  const uint64_t msg_time_ns = update.timestamp_ns;
   ScopedTimer timer("frontend/update_places", msg_time_ns, true, 2, false);
-  SceneGraphLayer temp_layer(DsgLayers::PLACES);
-  std::unique_ptr<SceneGraphLayer::Edges> edges =
-      temp_layer.deserializeLayer(msg->layer_contents);
-  VLOG(3) << "[Places Frontend] Received " << temp_layer.numNodes() << " nodes and "
-          << edges->size() << " edges from hydra_topology";
+  VLOG(3) << "[Places Frontend] Received " << update.layer.numNodes() << " nodes and "
+          << update.edges.size() << " edges from hydra_topology ("
+          << (update.is_full_update ? "full" : "partial") << " update)";
+
+  // merged updates cover num_merged consecutive sequence numbers
+  const uint64_t first_sequence = update.sequence_number + 1 - update.num_merged;
+  if (!update.is_full_update && last_places_sequence_ &&
+      first_sequence != *last_places_sequence_ + 1) {
+    LOG(WARNING) << "[Places Frontend] Expected places update "
+                 << *last_places_sequence_ + 1 << " but received "
+                 << first_sequence
+                 << ": removed places may remain until the next full update";
+  }
+  last_places_sequence_ = update.sequence_number;
 
   NodeIdSet active_nodes;
-  for (const auto& id_node_pair : temp_layer.nodes()) {
-    active_nodes.insert(id_node_pair.first);
-    auto& attrs = id_node_pair.second->attributes<PlaceNodeAttributes>();
-    attrs.is_active = true;
-    attrs.last_update_time_ns = msg_time_ns;
+  if (!update.is_full_update) {
+    // partial updates only contain the places that changed
+    active_nodes = *dsg_->latest_places;
+    for (const auto& node_id : update.deleted_nodes) {
+      active_nodes.erase(node_id);
+    }
+    for (const auto& node_id : update.archived_nodes) {
+      active_nodes.erase(node_id);
+    }
+  }
+
+  // places that were archived can still be sent by merged updates
+  const NodeIdSet archived_nodes(update.archived_nodes.begin(),
+                                 update.archived_nodes.end());
+  for (const auto& id_node_pair : update.layer.nodes()) {
+    if (!archived_nodes.count(id_node_pair.first)) {
+      active_nodes.insert(id_node_pair.first);
+    }
   }
 
   const auto& objects = dsg_->graph->getLayer(DsgLayers::OBJECTS);
@@ -406,8 +567,20 @@ void DsgFrontend::processLatestPlacesMsg(const PlacesLayerMsg::ConstPtr& msg) {
 
   NodeIdSet objects_to_check;
   {  // start graph update critical section
-    std::unique_lock<std::mutex> graph_lock(dsg_->mutex);
-    for (const auto& node_id : msg->deleted_nodes) {
+    DsgGuard guard(dsg_->lock, DsgAccess::Exclusive(), "frontend/places_update");
+    // full updates also remove anything that a dropped update should have removed
+    const topology::StalePlaces stale =
+        topology::findStalePlaces(places, *dsg_->latest_places, update);
+    if (!stale.nodes.empty() || !stale.edges.empty()) {
+      LOG(WARNING) << "[Places Frontend] Removing " << stale.nodes.size()
+                   << " places and " << stale.edges.size()
+                   << " edges missing from full update " << update.sequence_number;
+    }
+
+    std::vector<NodeId> nodes_to_remove(update.deleted_nodes);
+    nodes_to_remove.insert(
+        nodes_to_remove.end(), stale.nodes.begin(), stale.nodes.end());
+    for (const auto& node_id : nodes_to_remove) {
       if (dsg_->graph->hasNode(node_id)) {
         const SceneGraphNode& to_check = dsg_->graph->getNode(node_id).value();
         for (const auto& child : to_check.children()) {
@@ -422,8 +595,46 @@ void DsgFrontend::processLatestPlacesMsg(const PlacesLayerMsg::ConstPtr& msg) {
       dsg_->graph->removeNode(node_id);
     }
 
+    std::vector<topology::EdgeEndpoints> edges_to_remove(update.removed_edges);
+    edges_to_remove.insert(
+        edges_to_remove.end(), stale.edges.begin(), stale.edges.end());
+    for (const auto& endpoints : edges_to_remove) {
+      if (dsg_->graph->hasEdge(endpoints.first, endpoints.second)) {
+        dsg_->graph->removeEdge(endpoints.first, endpoints.second);
+      }
+    }
+
     // TODO(nathan) figure out reindexing (for more logical node ids)
-    dsg_->graph->updateFromLayer(temp_layer, std::move(edges));
+    // the update is shared with other consumers, so the places are copied in
+    update.mergeInto(*dsg_->graph);
+
+    // unchanged places are still active, but weren't resent with partial updates
+    for (const auto& node_id : active_nodes) {
+      if (!dsg_->graph->hasNode(node_id)) {
+        continue;
+      }
+
+      auto& attrs = dsg_->graph->getNode(node_id)
+                        .value()
+                        .get()
+                        .attributes<PlaceNodeAttributes>();
+      attrs.is_active = true;
+      attrs.last_update_time_ns = msg_time_ns;
+    }
+
+    // merged updates also carry the latest attributes of places they archive
+    for (const auto& node_id : archived_nodes) {
+      if (!update.layer.hasNode(node_id) || !dsg_->graph->hasNode(node_id)) {
+        continue;
+      }
+
+      auto& attrs = dsg_->graph->getNode(node_id)
+                        .value()
+                        .get()
+                        .attributes<PlaceNodeAttributes>();
+      attrs.is_active = false;
+      attrs.last_update_time_ns = msg_time_ns;
+    }
 
     places_nn_finder_.reset(new NearestNodeFinder(places, active_nodes));
 
@@ -449,15 +660,24 @@ void DsgFrontend::addPlaceObjectEdges(NodeIdSet* extra_objects_to_check) {
                             extra_objects_to_check->end());
   }
 
+  std::vector<NodeId> objects;
+  std::vector<Eigen::Vector3d> positions;
   for (const auto& object_id : objects_to_check) {
     if (!dsg_->graph->hasNode(object_id)) {
       continue;
     }
-    const Eigen::Vector3d object_position = dsg_->graph->getPosition(object_id);
-    places_nn_finder_->find(
-        object_position, 1, false, [&](NodeId place_id, size_t, double) {
-          dsg_->graph->insertEdge(place_id, object_id);
-        });
+
+    objects.push_back(object_id);
+    positions.push_back(dsg_->graph->getPosition(object_id));
+  }
+
+  // the graph isn't thread-safe, so edges are only added after the search
+  const auto matches =
+      places_nn_finder_->findBatch(positions, 1, 0.0, config_.place_query_threads);
+  for (size_t i = 0; i < objects.size(); ++i) {
+    for (size_t j = matches.offsets[i]; j < matches.offsets[i + 1]; ++j) {
+      dsg_->graph->insertEdge(matches.nodes[j], objects[i]);
+    }
   }
 
   segmenter_->pruneObjectsToCheckForPlaces(*dsg_->graph);
@@ -469,6 +689,8 @@ void DsgFrontend::addAgentPlaceEdges() {
     return;  // haven't received places yet
   }
 
+  std::vector<NodeId> agent_nodes;
+  std::vector<Eigen::Vector3d> positions;
   for (const auto& pair : dsg_->graph->dynamicLayersOfType(DsgLayers::AGENTS)) {
     const LayerPrefix prefix = pair.first;
     const auto& layer = *pair.second;
@@ -478,34 +700,48 @@ void DsgFrontend::addAgentPlaceEdges() {
     }
 
     for (size_t i = last_agent_edge_index_[prefix]; i < layer.numNodes(); ++i) {
-      places_nn_finder_->find(
-          layer.getPositionByIndex(i), 1, false, [&](NodeId place_id, size_t, double) {
-            CHECK(dsg_->graph->insertEdge(place_id, prefix.makeId(i)));
-          });
+      agent_nodes.push_back(prefix.makeId(i));
+      positions.push_back(layer.getPositionByIndex(i));
     }
     last_agent_edge_index_[prefix] = layer.numNodes();
   }
 
   for (const auto& node : deleted_agent_edge_indices_) {
-    const Eigen::Vector3d pos = dsg_->graph->getPosition(node);
-    places_nn_finder_->find(pos, 1, false, [&](NodeId place_id, size_t, double) {
-      CHECK(dsg_->graph->insertEdge(place_id, node));
-    });
+    agent_nodes.push_back(node);
+    positions.push_back(dsg_->graph->getPosition(node));
   }
 
   deleted_agent_edge_indices_.clear();
+
+  // the graph isn't thread-safe, so edges are only added after the search
+  const auto matches =
+      places_nn_finder_->findBatch(positions, 1, 0.0, config_.place_query_threads);
+  for (size_t i = 0; i < agent_nodes.size(); ++i) {
+    for (size_t j = matches.offsets[i]; j < matches.offsets[i + 1]; ++j) {
+      CHECK(dsg_->graph->insertEdge(matches.nodes[j], agent_nodes[i]));
+    }
+  }
 }
 
 void DsgFrontend::updatePlaceMeshMapping() {
-  std::unique_lock<std::mutex> lock(dsg_->mutex);
+  // the mapping only changes place attributes
+  DsgGuard guard(
+      dsg_->lock, DsgAccess().write(DsgLockLayer::PLACES), "frontend/place_mesh_map");
   const auto& places = dsg_->graph->getLayer(DsgLayers::PLACES);
   const auto& mesh_mappings = mesh_frontend_.getVoxbloxMsgToGraphMapping();
 
   size_t num_invalid = 0;
   size_t num_processed = 0;
   size_t num_vertices_processed = 0;
-  for (const auto& id_node_pair : places.nodes()) {
-    auto& attrs = id_node_pair.second->attributes<PlaceNodeAttributes>();
+  // only active places have connections to the active mesh (and latest_places is
+  // only written by the places thread with the graph locked exclusively)
+  for (const auto& node_id : *dsg_->latest_places) {
+    const auto node = places.getNode(node_id);
+    if (!node) {
+      continue;
+    }
+
+    auto& attrs = node->get().attributes<PlaceNodeAttributes>();
     if (!attrs.is_active) {
       continue;
     }
@@ -520,23 +756,26 @@ void DsgFrontend::updatePlaceMeshMapping() {
     attrs.pcl_mesh_connections.clear();
     attrs.pcl_mesh_connections.reserve(attrs.voxblox_mesh_connections.size());
 
-    for (const auto& connection : attrs.voxblox_mesh_connections) {
-      voxblox::BlockIndex index =
-          Eigen::Map<const voxblox::BlockIndex>(connection.block);
-
-      ++num_vertices_processed;
-      if (!mesh_mappings.count(index)) {
-        num_invalid++;
+    // connections are grouped by block, so each block mapping is only looked up once
+    const auto& connections = attrs.voxblox_mesh_connections;
+    for (const auto& run : topology::getBlockRuns(connections)) {
+      num_vertices_processed += run.size();
+      const auto block_iter = mesh_mappings.find(run.block);
+      if (block_iter == mesh_mappings.end()) {
+        num_invalid += run.size();
         continue;
       }
 
-      const auto& vertex_mapping = mesh_mappings.at(index);
-      if (!vertex_mapping.count(connection.vertex)) {
-        num_invalid++;
-        continue;
-      }
+      const auto& vertex_mapping = block_iter->second;
+      for (size_t i = run.begin; i < run.end; ++i) {
+        const auto vertex_iter = vertex_mapping.find(connections[i].vertex);
+        if (vertex_iter == vertex_mapping.end()) {
+          num_invalid++;
+          continue;
+        }
 
-      attrs.pcl_mesh_connections.push_back(vertex_mapping.at(connection.vertex));
+        attrs.pcl_mesh_connections.push_back(vertex_iter->second);
+      }
     }
   }
 
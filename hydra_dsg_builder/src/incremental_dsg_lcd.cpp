@@ -45,7 +45,10 @@ using hydra::timing::ScopedTimer;
 using lcd::LayerRegistrationConfig;
 
 DsgLcd::DsgLcd(const ros::NodeHandle& nh, const SharedDsgInfo::Ptr& dsg)
-    : nh_(nh), dsg_(dsg), lcd_graph_(new DynamicSceneGraph()) {
+    : nh_(nh),
+      dsg_(dsg),
+      lcd_graph_(new DynamicSceneGraph()),
+      lcd_graph_update_time_(0) {
   // TODO(nathan) rethink
   int robot_id = 0;
   nh_.getParam("robot_id", robot_id);
@@ -60,6 +63,7 @@ void DsgLcd::stop() {
   VLOG(2) << "[DSG LCD] stopping lcd!";
 
   should_shutdown_ = true;
+  dsg_->update_event.notify();
   if (lcd_thread_) {
     VLOG(2) << "[DSG LCD] joining thread";
     lcd_thread_->join();
@@ -73,7 +77,8 @@ void DsgLcd::stop() {
 DsgLcd::~DsgLcd() { stop(); }
 
 void DsgLcd::handleDbowMsg(const pose_graph_tools::BowQueries::ConstPtr& msg) {
-  std::unique_lock<std::mutex> lock(dsg_->mutex);
+  // bow messages are assigned to agents under the same lock
+  DsgGuard guard(dsg_->lock, DsgAccess().write(DsgLockLayer::AGENTS), "lcd/bow_msg");
   for (const auto& query : msg->queries) {
     bow_messages_.push_back(
         pose_graph_tools::BowQuery::ConstPtr(new pose_graph_tools::BowQuery(query)));
@@ -113,7 +118,8 @@ std::optional<NodeId> DsgLcd::getLatestAgentId() {
     return std::nullopt;
   }
 
-  const std::chrono::nanoseconds curr_time(dsg_->last_update_time);
+  // compared against the merge time so that the agent and time are consistent
+  const std::chrono::nanoseconds curr_time(lcd_graph_update_time_);
   std::chrono::duration<double> diff_s = curr_time - prev_time;
   // we consider should_shutdown_ here to make sure we're not waiting on popping from
   // the LCD queue while not getting new place messages
@@ -135,26 +141,20 @@ std::optional<NodeId> DsgLcd::getLatestAgentId() {
 }
 
 void DsgLcd::runLcd() {
-  ros::WallRate r(10);
+  RateThrottle throttle(config_.max_update_rate_hz);
   while (ros::ok()) {
+    // read before merging the graph so that changes while merging aren't missed
+    const uint64_t generation = dsg_->update_event.generation();
     assignBowVectors();
 
-    {  // start critical section
-      std::unique_lock<std::mutex> lock(dsg_->mutex);
-      lcd_graph_->mergeGraph(*dsg_->graph);
-
-      potential_lcd_root_nodes_.insert(potential_lcd_root_nodes_.end(),
-                                       dsg_->archived_places.begin(),
-                                       dsg_->archived_places.end());
-      dsg_->archived_places.clear();
-    }  // end critical section
+    updateLcdGraph();
 
     if (lcd_graph_->getLayer(DsgLayers::PLACES).numNodes() == 0) {
       if (should_shutdown_) {
         break;
       }
 
-      r.sleep();
+      dsg_->update_event.waitForChange(generation);
       continue;
     }
 
@@ -164,10 +164,17 @@ void DsgLcd::runLcd() {
 
     auto latest_agent = getLatestAgentId();
     if (!latest_agent) {
-      r.sleep();
+      if (should_shutdown_) {
+        continue;  // agents are popped unconditionally while draining the queue
+      }
+
+      // agents become ready as the frontend advances last_update_time
+      dsg_->update_event.waitForChange(generation);
       continue;
     }
 
+    throttle.throttle();
+
     const Eigen::Vector3d latest_pos = lcd_graph_->getPosition(*latest_agent);
 
     NodeIdSet to_cache;
@@ -195,10 +202,7 @@ void DsgLcd::runLcd() {
     }
 
     if (results.size() == 0) {
-      if (!should_shutdown_) {
-        r.sleep();
-      }
-      continue;
+      continue;  // more agents may already be ready
     }
 
     {  // start lcd critical section
@@ -212,14 +216,26 @@ void DsgLcd::runLcd() {
       }
     }  // end lcd critical section
 
-    if (!should_shutdown_) {
-      r.sleep();
-    }
+    dsg_->update_event.notify();
   }
 }
 
+void DsgLcd::updateLcdGraph() {
+  // merging in place only copies what changed since the last merge
+  DsgGuard guard(
+      dsg_->lock, DsgAccess::Shared().write(DsgLockLayer::PLACES), "lcd/graph_merge");
+  lcd_graph_->mergeGraph(*dsg_->graph);
+  lcd_graph_update_time_ = dsg_->last_update_time;
+
+  potential_lcd_root_nodes_.insert(potential_lcd_root_nodes_.end(),
+                                   dsg_->archived_places.begin(),
+                                   dsg_->archived_places.end());
+  dsg_->archived_places.clear();
+}
+
 void DsgLcd::assignBowVectors() {
-  std::unique_lock<std::mutex> lock(dsg_->mutex);
+  DsgGuard guard(
+      dsg_->lock, DsgAccess().write(DsgLockLayer::AGENTS), "lcd/bow_vectors");
   const auto& agents = dsg_->graph->getLayer(DsgLayers::AGENTS, robot_prefix_);
 
   const size_t prior_size = bow_messages_.size();
@@ -36,7 +36,6 @@
 
 #include <hydra_utils/timing_utilities.h>
 #include <kimera_semantics_ros/ros_params.h>
-#include <pcl/segmentation/extract_clusters.h>
 #include <pcl_conversions/pcl_conversions.h>
 #include <pcl_ros/point_cloud.h>
 
@@ -49,20 +48,7 @@ using kimera::HashableColor;
 using Clusters = MeshSegmenter::Clusters;
 using LabelClusters = MeshSegmenter::LabelClusters;
 using LabelIndices = MeshSegmenter::LabelIndices;
-
-std::ostream& operator<<(std::ostream& out, const std::set<uint8_t>& labels) {
-  out << "[";
-  auto iter = labels.begin();
-  while (iter != labels.end()) {
-    out << static_cast<int>(*iter);
-    ++iter;
-    if (iter != labels.end()) {
-      out << ", ";
-    }
-  }
-  out << "]";
-  return out;
-}
+using ObjectIndices = MeshSegmenter::ObjectIndices;
 
 std::ostream& operator<<(std::ostream& out, const HashableColor& color) {
   return out << "[" << static_cast<int>(color.r) << ", " << static_cast<int>(color.g)
@@ -70,16 +56,6 @@ std::ostream& operator<<(std::ostream& out, const HashableColor& color) {
              << "]";
 }
 
-bool objectsMatch(const Cluster& cluster, const SceneGraphNode& node) {
-  pcl::PointXYZ centroid;
-  cluster.centroid.get(centroid);
-
-  Eigen::Vector3f point;
-  point << centroid.x, centroid.y, centroid.z;
-
-  return node.attributes<ObjectNodeAttributes>().bounding_box.isInside(point);
-}
-
 std::set<uint8_t> readSemanticLabels(const ros::NodeHandle& nh,
                                      const std::string& param_name) {
   std::vector<int> labels;
@@ -129,6 +105,10 @@ MeshSegmenter::MeshSegmenter(const ros::NodeHandle& nh,
   object_labels_ = readSemanticLabels(nh_, "object_labels");
   for (const auto& label : object_labels_) {
     active_objects_[label] = std::set<NodeId>();
+    clusterers_.emplace(std::piecewise_construct,
+                        std::forward_as_tuple(label),
+                        std::forward_as_tuple(
+                            cluster_tolerance_, min_cluster_size_, max_cluster_size_));
   }
 
   bool use_oriented_bounding_boxes = false;
@@ -155,78 +135,66 @@ MeshSegmenter::~MeshSegmenter() {
   segmented_mesh_vertices_pub_.reset();
 }
 
-using KdTreeT = pcl::search::KdTree<pcl::PointXYZRGBA>;
-
-Clusters MeshSegmenter::findClusters(const MeshVertexCloud::Ptr& cloud,
-                                     const std::vector<size_t>& indices) const {
-  CHECK(cloud);
-
-  // in general, this is unsafe, but PCL doesn't offer us any alternative
-  pcl::IndicesPtr cloud_indices(new std::vector<int>(indices.begin(), indices.end()));
-
-  KdTreeT::Ptr tree(new KdTreeT());
-  tree->setInputCloud(cloud, cloud_indices);
-
-  pcl::EuclideanClusterExtraction<Cluster::PointT> estimator;
-  estimator.setClusterTolerance(cluster_tolerance_);
-  estimator.setMinClusterSize(min_cluster_size_);
-  estimator.setMaxClusterSize(max_cluster_size_);
-  estimator.setSearchMethod(tree);
-  estimator.setInputCloud(cloud);
-  estimator.setIndices(cloud_indices);
-
-  std::vector<pcl::PointIndices> cluster_indices;
-  estimator.extract(cluster_indices);
-
-  Clusters clusters;
-  clusters.resize(cluster_indices.size());
-  for (size_t k = 0; k < clusters.size(); ++k) {
-    clusters.at(k).indices = cluster_indices.at(k);
-    clusters.at(k).cloud.reset(new MeshVertexCloud());
-
-    const auto& object_indices = cluster_indices.at(k).indices;
-    clusters.at(k).cloud->resize(object_indices.size());
-
-    for (size_t i = 0; i < object_indices.size(); ++i) {
-      const auto& cp = cloud->at(object_indices.at(i));
-      clusters.at(k).cloud->at(i) = cp;
-      clusters.at(k).centroid.add(pcl::PointXYZ(cp.x, cp.y, cp.z));
-    }
+Cluster MeshSegmenter::makeCluster(
+    const IncrementalClusterer::ClusterInfo& info) const {
+  Cluster cluster;
+  cluster.id = info.id;
+  cluster.indices.indices.assign(info.indices.begin(), info.indices.end());
+  cluster.cloud.reset(new MeshVertexCloud());
+  cluster.cloud->resize(info.indices.size());
+
+  for (size_t i = 0; i < info.indices.size(); ++i) {
+    const auto& cp = full_mesh_vertices_->at(info.indices[i]);
+    cluster.cloud->at(i) = cp;
+    cluster.centroid.add(pcl::PointXYZ(cp.x, cp.y, cp.z));
   }
 
-  return clusters;
+  return cluster;
 }
 
 LabelClusters MeshSegmenter::findNewObjectClusters(
-    const std::vector<size_t>& active_indices) const {
+    const std::vector<size_t>& active_indices) {
   LabelClusters object_clusters;
 
   if (active_indices.empty()) {
     VLOG(3) << "[Object Detection] No active indices in mesh";
-    return object_clusters;
   }
 
   LabelIndices label_indices = getLabelIndices(active_indices);
   if (label_indices.empty()) {
     VLOG(3) << "[Object Detection] No object vertices found";
-    return object_clusters;
+  } else {
+    publishObjectClouds(label_indices);
   }
-  publishObjectClouds(label_indices);
 
+  const auto get_point = [&](size_t idx) -> Eigen::Vector3f {
+    return full_mesh_vertices_->at(idx).getVector3fMap();
+  };
+
+  // clusterers are updated even without vertices to drop the vertices that left
   VLOG(3) << "[Object Detection] Detecting objects";
+  const std::vector<size_t> no_indices;
   for (const auto label : object_labels_) {
-    if (!label_indices.count(label)) {
+    const auto iter = label_indices.find(label);
+    auto& clusterer = clusterers_.at(label);
+    clusterer.update(iter == label_indices.end() ? no_indices : iter->second,
+                     get_point);
+    live_clusters_[label] = clusterer.getClusterIds();
+
+    // only clusters that changed need to be (re)matched against the graph
+    const auto changed = clusterer.popChangedClusters();
+    if (changed.empty()) {
       continue;
     }
 
-    if (label_indices.at(label).size() < min_cluster_size_) {
-      continue;
+    Clusters clusters;
+    clusters.reserve(changed.size());
+    for (const auto& info : changed) {
+      clusters.push_back(makeCluster(info));
     }
 
-    const auto clusters = findClusters(full_mesh_vertices_, label_indices.at(label));
-
-    VLOG(3) << "[Object Detection]  - Found " << clusters.size() << " objects of label "
-            << static_cast<int>(label);
+    VLOG(3) << "[Object Detection]  - Found " << clusters.size()
+            << " new or changed objects of label " << static_cast<int>(label);
     object_clusters.insert({label, clusters});
   }
   return object_clusters;
@@ -275,6 +243,25 @@ void MeshSegmenter::pruneObjectsToCheckForPlaces(const DynamicSceneGraph& graph)
   }
 }
 
+void MeshSegmenter::refreshActiveObjects(uint64_t timestamp) {
+  // objects whose cluster didn't change aren't re-detected, but are still observed
+  for (auto& label_objects : cluster_objects_) {
+    const auto& live = live_clusters_[label_objects.first];
+    auto iter = label_objects.second.begin();
+    while (iter != label_objects.second.end()) {
+      auto timestamp_iter = active_object_timestamps_.find(iter->second);
+      const bool is_active = timestamp_iter != active_object_timestamps_.end();
+      if (!live.count(iter->first) || !is_active) {
+        iter = label_objects.second.erase(iter);
+        continue;
+      }
+
+      timestamp_iter->second = timestamp;
+      ++iter;
+    }
+  }
+}
+
 void MeshSegmenter::archiveOldObjects(const DynamicSceneGraph& graph,
                                       uint64_t latest_timestamp) {
   for (const auto& label : object_labels_) {
@@ -293,106 +280,199 @@ void MeshSegmenter::archiveOldObjects(const DynamicSceneGraph& graph,
     for (const auto& node_id : removed_nodes) {
       active_objects_[label].erase(node_id);
       active_object_timestamps_.erase(node_id);
+      active_object_index_.remove(node_id);
     }
   }
 }
 
+void MeshSegmenter::updateVertexLabels() {
+  const auto& label_to_color = semantic_config_.semantic_label_to_color_;
+  const size_t num_decoded =
+      vertex_labels_.update(full_mesh_vertices_->size(), [&](size_t idx) -> uint8_t {
+        const pcl::PointXYZRGBA& point = full_mesh_vertices_->at(idx);
+        const HashableColor color(point.r, point.g, point.b, 255);
+        return label_to_color->getSemanticLabelFromColor(color);
+      });
+
+  VLOG(3) << "[Object Detection] Decoded labels for " << num_decoded
+          << " new vertices";
+}
+
 LabelIndices MeshSegmenter::getLabelIndices(const std::vector<size_t>& indices) const {
   LabelIndices label_indices;
+  for (const auto label : object_labels_) {
+    label_indices[label] = std::vector<size_t>();
+  }
 
-  std::set<uint8_t> seen_labels;
+  // labels are decoded when vertices are added, so this is just a lookup per vertex
   for (const auto idx : indices) {
-    if (idx >= full_mesh_vertices_->size()) {
-      LOG(ERROR) << "Invalid indice: " << idx << "(out of "
-                 << full_mesh_vertices_->size() << ")";
+    if (!vertex_labels_.hasLabel(idx)) {
+      LOG(ERROR) << "Invalid indice: " << idx << "(out of " << vertex_labels_.size()
+                 << " labeled vertices)";
       continue;
     }
-    const pcl::PointXYZRGBA& point = full_mesh_vertices_->at(idx);
-    const HashableColor color(point.r, point.g, point.b, 255);
-
-    const uint8_t label =
-        semantic_config_.semantic_label_to_color_->getSemanticLabelFromColor(color);
-    seen_labels.insert(label);
 
-    if (!object_labels_.count(label)) {
-      continue;
+    auto iter = label_indices.find(vertex_labels_.getLabel(idx));
+    if (iter != label_indices.end()) {
+      iter->second.push_back(idx);
     }
+  }
 
-    if (!label_indices.count(label)) {
-      label_indices[label] = std::vector<size_t>();
+  auto iter = label_indices.begin();
+  while (iter != label_indices.end()) {
+    if (iter->second.empty()) {
+      iter = label_indices.erase(iter);
+    } else {
+      ++iter;
     }
-
-    label_indices[label].push_back(idx);
   }
 
-  VLOG(3) << "[Object Detection] Seen labels: " << seen_labels;
+  VLOG(3) << "[Object Detection] Labels with vertices: " << label_indices.size();
 
   return label_indices;
 }
 
-void MeshSegmenter::updateGraph(DynamicSceneGraph& graph,
-                                const LabelClusters& clusters,
-                                uint64_t timestamp) {
+ObjectIndices MeshSegmenter::updateGraph(DynamicSceneGraph& graph,
+                                         const LabelClusters& clusters,
+                                         uint64_t timestamp) {
+  ObjectIndices updated_objects;
+  refreshActiveObjects(timestamp);
   archiveOldObjects(graph, timestamp);
 
   for (const auto& label_clusters : clusters) {
+    const uint8_t label = label_clusters.first;
+    auto& cluster_objects = cluster_objects_[label];
+    // only objects that were matched or added can overlap with new objects
+    std::set<NodeId> to_check;
     for (const auto& cluster : label_clusters.second) {
-      bool matches_prev_object = false;
-      std::vector<NodeId> nodes_not_in_graph;
-      for (const auto& prev_node_id : active_objects_.at(label_clusters.first)) {
-        const SceneGraphNode& prev_node = graph.getNode(prev_node_id).value();
-        if (objectsMatch(cluster, prev_node)) {
-          updateObjectInGraph(graph, cluster, prev_node, timestamp);
-          matches_prev_object = true;
-          break;
-        }
+      pcl::PointXYZ centroid;
+      cluster.centroid.get(centroid);
+      const Eigen::Vector3f centroid_pos(centroid.x, centroid.y, centroid.z);
+
+      // matches are sorted, so the oldest object with a box containing the centroid
+      const auto matches =
+          active_object_index_.findBoxesContaining(label, centroid_pos);
+      NodeId object_id;
+      if (!matches.empty()) {
+        const SceneGraphNode& prev_node = graph.getNode(matches.front()).value();
+        updateObjectInGraph(graph, cluster, prev_node, timestamp);
+        object_id = prev_node.id;
+      } else {
+        object_id = next_node_id_;
+        addObjectToGraph(graph, cluster, label, timestamp);
       }
 
-      if (!matches_prev_object) {
-        addObjectToGraph(graph, cluster, label_clusters.first, timestamp);
-      }
+      cluster_objects[cluster.id] = object_id;
+      to_check.insert(object_id);
+      auto& object_indices = updated_objects[object_id];
+      object_indices.insert(object_indices.end(),
+                            cluster.indices.indices.begin(),
+                            cluster.indices.indices.end());
     }
 
-    auto to_check = active_objects_[label_clusters.first];
-    for (const auto& node_id : to_check) {
-      if (!graph.hasNode(node_id)) {
+    pruneOverlappingObjects(graph, label, to_check);
+  }
+
+  auto iter = updated_objects.begin();
+  while (iter != updated_objects.end()) {
+    if (graph.hasNode(iter->first)) {
+      ++iter;
+    } else {
+      iter = updated_objects.erase(iter);  // pruned after being matched
+    }
+  }
+
+  return updated_objects;
+}
+
+void MeshSegmenter::pruneOverlappingObjects(DynamicSceneGraph& graph,
+                                            uint8_t label,
+                                            const std::set<NodeId>& to_check) {
+  for (const auto& node_id : to_check) {
+    if (!active_object_index_.contains(node_id)) {
+      continue;  // removed while checking a previous node
+    }
+
+    const auto& node =
+        graph.getNode(node_id).value().get().attributes<SemanticNodeAttributes>();
+    const Eigen::Vector3f node_pos = node.position.cast<float>();
+
+    const auto boxes = active_object_index_.findBoxesContaining(label, node_pos);
+    const auto positions =
+        active_object_index_.findPositionsInside(label, node.bounding_box);
+    std::set<NodeId> overlapping(boxes.begin(), boxes.end());
+    overlapping.insert(positions.begin(), positions.end());
+
+    for (const auto& other_id : overlapping) {
+      if (node_id == other_id) {
         continue;
       }
 
-      const auto& node =
-          graph.getNode(node_id).value().get().attributes<SemanticNodeAttributes>();
-
-      for (const auto& other_id : to_check) {
-        if (node_id == other_id) {
-          continue;
-        }
-
-        if (!graph.hasNode(other_id)) {
-          continue;
-        }
-
-        const auto& other =
-            graph.getNode(other_id).value().get().attributes<SemanticNodeAttributes>();
-
-        if (node.bounding_box.isInside(other.position) ||
-            other.bounding_box.isInside(node.position)) {
-          if (node.bounding_box.volume() >= other.bounding_box.volume()) {
-            graph.removeNode(other_id);
-            active_objects_[label_clusters.first].erase(other_id);
-            active_object_timestamps_.erase(other_id);
-            objects_to_check_for_places_.erase(other_id);
-          } else {
-            graph.removeNode(node_id);
-            active_objects_[label_clusters.first].erase(node_id);
-            active_object_timestamps_.erase(node_id);
-            objects_to_check_for_places_.erase(node_id);
-          }
-        }
+      const auto& other =
+          graph.getNode(other_id).value().get().attributes<SemanticNodeAttributes>();
+      // the remaining object covers the clusters of the removed one
+      if (node.bounding_box.volume() >= other.bounding_box.volume()) {
+        reassignClusters(label, other_id, node_id);
+        removeActiveObject(graph, label, other_id);
+      } else {
+        reassignClusters(label, node_id, other_id);
+        removeActiveObject(graph, label, node_id);
+        break;
       }
     }
   }
 }
 
+void MeshSegmenter::removeActiveObject(DynamicSceneGraph& graph,
+                                       uint8_t label,
+                                       NodeId node_id) {
+  graph.removeNode(node_id);
+  active_objects_[label].erase(node_id);
+  active_object_timestamps_.erase(node_id);
+  objects_to_check_for_places_.erase(node_id);
+  active_object_index_.remove(node_id);
+
+  // unchanged clusters are never re-matched, so clusters without an object are
+  // reported as changed by the next detection
+  auto& cluster_objects = cluster_objects_[label];
+  auto iter = cluster_objects.begin();
+  while (iter != cluster_objects.end()) {
+    if (iter->second != node_id) {
+      ++iter;
+      continue;
+    }
+
+    clusterers_.at(label).markChanged(iter->first);
+    iter = cluster_objects.erase(iter);
+  }
+}
+
+void MeshSegmenter::reassignClusters(uint8_t label,
+                                     NodeId from_node,
+                                     NodeId to_node) {
+  for (auto& cluster_object_pair : cluster_objects_[label]) {
+    if (cluster_object_pair.second == from_node) {
+      cluster_object_pair.second = to_node;
+    }
+  }
+}
+
+void MeshSegmenter::removeObject(DynamicSceneGraph& graph, NodeId node_id) {
+  if (!graph.hasNode(node_id)) {
+    return;
+  }
+
+  const auto& attrs =
+      graph.getNode(node_id).value().get().attributes<SemanticNodeAttributes>();
+  const uint8_t label = attrs.semantic_label;
+  if (!clusterers_.count(label)) {
+    graph.removeNode(node_id);
+    return;
+  }
+
+  removeActiveObject(graph, label, node_id);
+}
+
 void MeshSegmenter::updateObjectInGraph(DynamicSceneGraph& graph,
                                         const Cluster& cluster,
                                         const SceneGraphNode& node,
@@ -416,6 +496,8 @@ void MeshSegmenter::updateObjectInGraph(DynamicSceneGraph& graph,
   cluster.centroid.get(centroid);
   attrs.position << centroid.x, centroid.y, centroid.z;
   attrs.bounding_box = new_box;
+  active_object_index_.update(
+      node.id, attrs.semantic_label, attrs.bounding_box, attrs.position.cast<float>());
 }
 
 void MeshSegmenter::addObjectToGraph(DynamicSceneGraph& graph,
@@ -438,6 +520,13 @@ void MeshSegmenter::addObjectToGraph(DynamicSceneGraph& graph,
 
   graph.emplaceNode(DsgLayers::OBJECTS, next_node_id_, std::move(attrs));
 
+  const ObjectNodeAttributes& new_attrs =
+      graph.getNode(next_node_id_).value().get().attributes<ObjectNodeAttributes>();
+  active_object_index_.update(next_node_id_,
+                              label,
+                              new_attrs.bounding_box,
+                              new_attrs.position.cast<float>());
+
   active_objects_.at(label).insert(next_node_id_);
   active_object_timestamps_[next_node_id_] = timestamp;
   objects_to_check_for_places_.insert(next_node_id_);
@@ -793,7 +793,7 @@ void RoomFinder::findRooms(SharedDsgInfo& dsg, const ActiveNodeSet& active_nodes
   RoomMap previous_rooms;
   IsolatedSceneGraphLayer::Ptr active_places;
   {  // start dsg critical section
-    std::unique_lock<std::mutex> graph_lock(dsg.mutex);
+    DsgGuard guard(dsg.lock, DsgAccess::Shared(), "rooms/active_places");
     active_places = getActiveSubgraph(
         *dsg.graph, static_cast<LayerId>(DsgLayers::PLACES), active_nodes);
 
@@ -841,7 +841,7 @@ void RoomFinder::findRooms(SharedDsgInfo& dsg, const ActiveNodeSet& active_nodes
   }
 
   {  // start dsg critical section
-    std::unique_lock<std::mutex> graph_lock(dsg.mutex);
+    DsgGuard guard(dsg.lock, DsgAccess::Exclusive(), "rooms/update");
     if (config_.use_previous_rooms) {
       updateRoomsFromClusters(dsg, clusters, previous_rooms, active_nodes);
     } else {
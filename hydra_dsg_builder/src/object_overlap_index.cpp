@@ -0,0 +1,222 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_dsg_builder/object_overlap_index.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace hydra {
+namespace incremental {
+
+using voxblox::GlobalIndex;
+
+ObjectOverlapIndex::ObjectOverlapIndex(double cell_size) : cell_size_(cell_size) {
+  CHECK_GT(cell_size_, 0.0);
+}
+
+void ObjectOverlapIndex::update(NodeId node,
+                                uint8_t label,
+                                const BoundingBox& bounding_box,
+                                const Eigen::Vector3f& position) {
+  remove(node);
+
+  Eigen::Vector3f min;
+  Eigen::Vector3f max;
+  getWorldBounds(bounding_box, min, max);
+
+  if (!min.allFinite() || !max.allFinite() || !position.allFinite()) {
+    LOG(WARNING) << "Not indexing object " << NodeSymbol(node).getLabel()
+                 << " with invalid bounding box or position";
+    return;
+  }
+
+  Entry entry{label, bounding_box, position, getCell(min), getCell(max)};
+  auto& box_grid = box_cells_[label];
+  for (auto x = entry.min_cell.x(); x <= entry.max_cell.x(); ++x) {
+    for (auto y = entry.min_cell.y(); y <= entry.max_cell.y(); ++y) {
+      for (auto z = entry.min_cell.z(); z <= entry.max_cell.z(); ++z) {
+        box_grid[GlobalIndex(x, y, z)].push_back(node);
+      }
+    }
+  }
+
+  position_cells_[label][getCell(position)].push_back(node);
+  entries_.emplace(node, std::move(entry));
+}
+
+void ObjectOverlapIndex::remove(NodeId node) {
+  const auto iter = entries_.find(node);
+  if (iter == entries_.end()) {
+    return;
+  }
+
+  const Entry& entry = iter->second;
+  auto& box_grid = box_cells_.at(entry.label);
+  for (auto x = entry.min_cell.x(); x <= entry.max_cell.x(); ++x) {
+    for (auto y = entry.min_cell.y(); y <= entry.max_cell.y(); ++y) {
+      for (auto z = entry.min_cell.z(); z <= entry.max_cell.z(); ++z) {
+        eraseFromCell(box_grid, GlobalIndex(x, y, z), node);
+      }
+    }
+  }
+
+  eraseFromCell(position_cells_.at(entry.label), getCell(entry.position), node);
+  entries_.erase(iter);
+}
+
+void ObjectOverlapIndex::clear() {
+  entries_.clear();
+  box_cells_.clear();
+  position_cells_.clear();
+}
+
+std::vector<NodeId> ObjectOverlapIndex::findBoxesContaining(
+    uint8_t label, const Eigen::Vector3f& point) const {
+  std::vector<NodeId> result;
+  const auto grid_iter = box_cells_.find(label);
+  if (grid_iter == box_cells_.end()) {
+    return result;
+  }
+
+  if (!point.allFinite()) {
+    return result;
+  }
+
+  const auto cell_iter = grid_iter->second.find(getCell(point));
+  if (cell_iter == grid_iter->second.end()) {
+    return result;
+  }
+
+  for (const auto node : cell_iter->second) {
+    if (entries_.at(node).bounding_box.isInside(point)) {
+      result.push_back(node);
+    }
+  }
+
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+std::vector<NodeId> ObjectOverlapIndex::findPositionsInside(
+    uint8_t label, const BoundingBox& bounding_box) const {
+  std::vector<NodeId> result;
+  const auto grid_iter = position_cells_.find(label);
+  if (grid_iter == position_cells_.end()) {
+    return result;
+  }
+
+  Eigen::Vector3f min;
+  Eigen::Vector3f max;
+  getWorldBounds(bounding_box, min, max);
+  if (!min.allFinite() || !max.allFinite()) {
+    return result;
+  }
+
+  const GlobalIndex min_cell = getCell(min);
+  const GlobalIndex max_cell = getCell(max);
+
+  const auto& grid = grid_iter->second;
+  for (auto x = min_cell.x(); x <= max_cell.x(); ++x) {
+    for (auto y = min_cell.y(); y <= max_cell.y(); ++y) {
+      for (auto z = min_cell.z(); z <= max_cell.z(); ++z) {
+        const auto cell_iter = grid.find(GlobalIndex(x, y, z));
+        if (cell_iter == grid.end()) {
+          continue;
+        }
+
+        for (const auto node : cell_iter->second) {
+          if (bounding_box.isInside(entries_.at(node).position)) {
+            result.push_back(node);
+          }
+        }
+      }
+    }
+  }
+
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+void ObjectOverlapIndex::getWorldBounds(const BoundingBox& bounding_box,
+                                        Eigen::Vector3f& min,
+                                        Eigen::Vector3f& max) {
+  if (bounding_box.type == BoundingBox::Type::AABB) {
+    min = bounding_box.min;
+    max = bounding_box.max;
+    return;
+  }
+
+  // rotated boxes are stored relative to their center
+  min = Eigen::Vector3f::Constant(std::numeric_limits<float>::max());
+  max = Eigen::Vector3f::Constant(std::numeric_limits<float>::lowest());
+  for (int i = 0; i < 8; ++i) {
+    const Eigen::Vector3f corner((i & 1) ? bounding_box.max.x() : bounding_box.min.x(),
+                                 (i & 2) ? bounding_box.max.y() : bounding_box.min.y(),
+                                 (i & 4) ? bounding_box.max.z() : bounding_box.min.z());
+    const Eigen::Vector3f world_corner =
+        bounding_box.world_R_center * corner + bounding_box.world_P_center;
+    min = min.cwiseMin(world_corner);
+    max = max.cwiseMax(world_corner);
+  }
+}
+
+GlobalIndex ObjectOverlapIndex::getCell(const Eigen::Vector3f& point) const {
+  GlobalIndex cell;
+  for (int i = 0; i < 3; ++i) {
+    cell(i) = static_cast<voxblox::LongIndexElement>(std::floor(point(i) / cell_size_));
+  }
+  return cell;
+}
+
+void ObjectOverlapIndex::eraseFromCell(Grid& grid,
+                                       const GlobalIndex& cell,
+                                       NodeId node) {
+  const auto iter = grid.find(cell);
+  if (iter == grid.end()) {
+    return;
+  }
+
+  auto& nodes = iter->second;
+  nodes.erase(std::remove(nodes.begin(), nodes.end(), node), nodes.end());
+  if (nodes.empty()) {
+    grid.erase(iter);
+  }
+}
+
+}  // namespace incremental
+}  // namespace hydra
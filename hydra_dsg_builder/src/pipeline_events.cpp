@@ -0,0 +1,85 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_dsg_builder/pipeline_events.h"
+
+#include <thread>
+
+namespace hydra {
+namespace incremental {
+
+constexpr PipelineEvent::Duration PipelineEvent::kDefaultTimeout;
+
+void PipelineEvent::notify() {
+  {  // start event critical section
+    std::unique_lock<std::mutex> lock(mutex_);
+    ++generation_;
+  }  // end event critical section
+
+  cv_.notify_all();
+}
+
+uint64_t PipelineEvent::generation() const {
+  std::unique_lock<std::mutex> lock(mutex_);
+  return generation_;
+}
+
+uint64_t PipelineEvent::waitForChange(uint64_t since, Duration timeout) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  cv_.wait_for(lock, timeout, [&] { return generation_ != since; });
+  return generation_;
+}
+
+RateThrottle::RateThrottle(double max_rate_hz)
+    : min_period_(Clock::duration::zero()), last_call_(Clock::time_point::min()) {
+  if (max_rate_hz > 0.0) {
+    min_period_ = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(1.0 / max_rate_hz));
+  }
+}
+
+void RateThrottle::throttle() {
+  if (min_period_ == Clock::duration::zero()) {
+    return;
+  }
+
+  if (last_call_ != Clock::time_point::min()) {
+    std::this_thread::sleep_until(last_call_ + min_period_);
+  }
+
+  last_call_ = Clock::now();
+}
+
+}  // namespace incremental
+}  // namespace hydra
@@ -0,0 +1,67 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra_dsg_builder/active_window_index.h>
+
+namespace hydra {
+namespace incremental {
+
+TEST(ActiveWindowIndexTests, NodesLeaveWithTheirVertices) {
+  ActiveWindowIndex index;
+  index.addConnections(3, {1, 2, 3});
+  index.addConnections(1, {3, 4});
+  index.addConnections(2, {});
+  EXPECT_EQ(std::vector<NodeId>({1, 3}), index.getNodes());
+  EXPECT_FALSE(index.contains(2));
+
+  // node 1 keeps vertex 4, node 3 loses every vertex
+  index.updateActiveVertices({4, 5, 6});
+  EXPECT_EQ(std::vector<NodeId>({1}), index.getNodes());
+
+  // connections can be added to nodes that are already indexed
+  index.addConnections(1, {5, 4});
+  index.addConnections(7, {5});
+  index.updateActiveVertices({5});
+  EXPECT_EQ(std::vector<NodeId>({1, 7}), index.getNodes());
+
+  index.removeNode(1);
+  EXPECT_EQ(std::vector<NodeId>({7}), index.getNodes());
+  index.removeNode(1);
+  index.updateActiveVertices({});
+  EXPECT_EQ(0u, index.size());
+}
+
+}  // namespace incremental
+}  // namespace hydra
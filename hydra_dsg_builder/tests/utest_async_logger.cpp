@@ -0,0 +1,128 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra_dsg_builder/async_logger.h>
+
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace hydra {
+namespace incremental {
+
+std::string readFile(const std::string& filename) {
+  std::ifstream file(filename);
+  std::stringstream ss;
+  ss << file.rdbuf();
+  return ss.str();
+}
+
+TEST(AsyncLoggerTests, WritesInOrder) {
+  const std::string filename = ::testing::TempDir() + "async_logger_test.csv";
+  {  // write a file that should be replaced by the header
+    std::ofstream file(filename);
+    file << "old contents\n";
+  }
+
+  AsyncLogger logger;
+  EXPECT_TRUE(logger.writeHeader(filename, "a,b"));
+  EXPECT_TRUE(logger.appendLine(filename, "1,2"));
+  EXPECT_TRUE(logger.appendLine(filename, "3,4"));
+  logger.flush();
+  EXPECT_EQ("a,b\n1,2\n3,4\n", readFile(filename));
+
+  EXPECT_TRUE(logger.appendLine(filename, "5,6"));
+  logger.stop();
+  EXPECT_EQ("a,b\n1,2\n3,4\n5,6\n", readFile(filename));
+  EXPECT_EQ(0u, logger.numDropped());
+
+  // nothing is written after stopping
+  EXPECT_FALSE(logger.appendLine(filename, "7,8"));
+  EXPECT_EQ(1u, logger.numDropped());
+  std::remove(filename.c_str());
+}
+
+TEST(AsyncLoggerTests, WritesGraphStats) {
+  const std::string directory = ::testing::TempDir();
+  GraphLogStats stats;
+  stats.timestamp_ns = 10;
+  stats.layers = {{"async_objects", 2, 1}, {"async_places", 5, 4}};
+
+  AsyncLogger logger;
+  EXPECT_TRUE(logger.logGraphStats(directory, stats));
+  stats.timestamp_ns = 20;
+  stats.layers[0].num_nodes = 3;
+  EXPECT_TRUE(logger.logGraphStats(directory, stats));
+  logger.stop();
+
+  const std::string objects_file = directory + "/async_objects_layer_stats.csv";
+  const std::string places_file = directory + "/async_places_layer_stats.csv";
+  EXPECT_EQ("timestamp_ns,num_nodes,num_edges\n10,2,1\n20,3,1\n",
+            readFile(objects_file));
+  EXPECT_EQ("timestamp_ns,num_nodes,num_edges\n10,5,4\n20,5,4\n",
+            readFile(places_file));
+  std::remove(objects_file.c_str());
+  std::remove(places_file.c_str());
+}
+
+TEST(AsyncLoggerTests, DropsWhenFull) {
+  AsyncLogger logger(2);
+  std::mutex block_mutex;
+  std::unique_lock<std::mutex> block(block_mutex);
+  std::atomic<bool> started(false);
+  std::atomic<size_t> num_written(0);
+
+  // keep the writer busy so that the queue fills up
+  EXPECT_TRUE(logger.enqueue([&](AsyncLogger::Files&) {
+    started = true;
+    std::unique_lock<std::mutex> lock(block_mutex);
+  }));
+  while (!started) {
+    std::this_thread::yield();
+  }
+
+  for (size_t i = 0; i < 4; ++i) {
+    logger.enqueue([&](AsyncLogger::Files&) { ++num_written; });
+  }
+
+  block.unlock();
+  logger.flush();
+  EXPECT_EQ(2u, num_written);
+  EXPECT_EQ(2u, logger.numDropped());
+}
+
+}  // namespace incremental
+}  // namespace hydra
@@ -0,0 +1,161 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra_dsg_builder/coalescing_queue.h>
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <thread>
+
+namespace hydra {
+namespace incremental {
+
+struct TestUpdate {
+  uint64_t timestamp_ns;
+  std::map<int, int> values;
+};
+
+using TestQueue = CoalescingQueue<TestUpdate>;
+
+TestQueue::ConstPtr makeUpdate(uint64_t timestamp_ns,
+                               const std::map<int, int>& values) {
+  return std::make_shared<TestUpdate>(TestUpdate{timestamp_ns, values});
+}
+
+size_t testSize(const TestUpdate& update) { return 10 * update.values.size(); }
+
+TestQueue::ConstPtr testMerge(const std::vector<TestQueue::ConstPtr>& updates) {
+  auto merged = std::make_shared<TestUpdate>();
+  for (const auto& update : updates) {
+    merged->timestamp_ns = update->timestamp_ns;
+    for (const auto& key_value_pair : update->values) {
+      merged->values[key_value_pair.first] = key_value_pair.second;
+    }
+  }
+  return merged;
+}
+
+TEST(CoalescingQueueTests, PopMergesPendingUpdates) {
+  TestQueue queue(1000, testSize, testMerge);
+  EXPECT_TRUE(queue.empty());
+  EXPECT_EQ(nullptr, queue.popAll());
+  EXPECT_FALSE(queue.oldestTimestamp());
+
+  const auto first = makeUpdate(10, {{1, 1}, {2, 1}});
+  queue.push(first);
+  queue.push(makeUpdate(20, {{2, 2}}));
+  queue.push(makeUpdate(30, {{3, 3}}));
+  EXPECT_EQ(10u, queue.oldestTimestamp().value());
+  EXPECT_EQ(20u, queue.newestTimestampUpTo(25).value());
+  EXPECT_FALSE(queue.newestTimestampUpTo(5));
+
+  // a single update is passed through without merging
+  EXPECT_EQ(first, queue.popUpTo(15));
+
+  const auto merged = queue.popUpTo(30);
+  ASSERT_TRUE(merged != nullptr);
+  EXPECT_EQ(30u, merged->timestamp_ns);
+  EXPECT_EQ((std::map<int, int>{{2, 2}, {3, 3}}), merged->values);
+  EXPECT_TRUE(queue.empty());
+
+  const auto stats = queue.getStats();
+  EXPECT_EQ(0u, stats.depth);
+  EXPECT_EQ(0u, stats.bytes);
+  EXPECT_EQ(3u, stats.num_pushed);
+  EXPECT_EQ(2u, stats.num_popped);
+  EXPECT_EQ(1u, stats.num_coalesced);
+  EXPECT_EQ(0u, stats.num_budget_merges);
+}
+
+TEST(CoalescingQueueTests, BudgetMergesInsteadOfDropping) {
+  TestQueue queue(45, testSize, testMerge);
+  queue.push(makeUpdate(10, {{1, 1}, {2, 1}}));
+  queue.push(makeUpdate(20, {{1, 2}, {2, 2}}));
+  // over budget: every pending update is merged to make room
+  queue.push(makeUpdate(30, {{3, 3}}));
+
+  auto stats = queue.getStats();
+  EXPECT_EQ(1u, stats.depth);
+  EXPECT_EQ(30u, stats.bytes);
+  EXPECT_EQ(1u, stats.num_budget_merges);
+
+  // the merged update is kept even when it doesn't fit
+  queue.push(makeUpdate(40, {{4, 4}, {5, 4}, {6, 4}, {7, 4}}));
+  stats = queue.getStats();
+  EXPECT_EQ(1u, stats.depth);
+  EXPECT_EQ(70u, stats.bytes);
+  EXPECT_EQ(2u, stats.num_budget_merges);
+
+  const auto update = queue.popAll();
+  EXPECT_EQ(40u, update->timestamp_ns);
+  const std::map<int, int> expected{
+      {1, 2}, {2, 2}, {3, 3}, {4, 4}, {5, 4}, {6, 4}, {7, 4}};
+  EXPECT_EQ(expected, update->values);
+
+  stats = queue.getStats();
+  EXPECT_EQ(4u, stats.num_pushed);
+  EXPECT_EQ(1u, stats.num_popped);
+  EXPECT_EQ(3u, stats.num_coalesced);
+}
+
+TEST(CoalescingQueueTests, ProducerWaitsForConsumer) {
+  TestQueue queue(45, testSize, testMerge);
+  queue.push(makeUpdate(10, {{1, 1}, {2, 1}, {3, 1}, {4, 1}, {5, 1}}));
+
+  std::atomic<bool> done(false);
+  std::thread producer([&] {
+    queue.waitForBudget();
+    done = true;
+  });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_FALSE(done);
+  EXPECT_TRUE(queue.popAll() != nullptr);
+  producer.join();
+  EXPECT_TRUE(done);
+  EXPECT_EQ(1u, queue.getStats().num_waits);
+
+  // stopping releases producers even if the budget is exceeded
+  queue.push(makeUpdate(20, {{1, 1}, {2, 1}, {3, 1}, {4, 1}, {5, 1}}));
+  std::thread stopped_producer([&] { queue.waitForBudget(); });
+  queue.stop();
+  stopped_producer.join();
+  queue.waitForBudget();
+  EXPECT_FALSE(queue.empty());
+}
+
+}  // namespace incremental
+}  // namespace hydra
@@ -0,0 +1,125 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra_dsg_builder/dsg_lock.h>
+
+#include <atomic>
+#include <thread>
+
+namespace hydra {
+namespace incremental {
+
+using namespace std::chrono_literals;
+
+TEST(DsgLockTests, ReadersShareLayers) {
+  DsgLock lock;
+  DsgGuard reader(lock, DsgAccess::Shared(), "reader");
+
+  std::atomic<bool> acquired(false);
+  std::thread other([&] {
+    DsgGuard other_reader(lock, DsgAccess::Shared(), "other_reader");
+    acquired = true;
+  });
+  other.join();
+
+  EXPECT_TRUE(acquired);
+  const auto stats = lock.getStats();
+  ASSERT_EQ(1u, stats.count("other_reader"));
+  EXPECT_EQ(1u, stats.at("other_reader").num_acquisitions);
+  EXPECT_EQ(0u, stats.at("other_reader").num_contended);
+}
+
+TEST(DsgLockTests, DisjointWritersDontBlock) {
+  DsgLock lock;
+  DsgGuard places(lock, DsgAccess().write(DsgLockLayer::PLACES), "places");
+
+  std::atomic<bool> acquired(false);
+  std::thread other([&] {
+    DsgGuard objects(lock,
+                     DsgAccess().write(DsgLockLayer::OBJECTS).read(DsgLockLayer::MESH),
+                     "objects");
+    acquired = true;
+  });
+  other.join();
+
+  EXPECT_TRUE(acquired);
+}
+
+TEST(DsgLockTests, ConflictingAccessWaits) {
+  DsgLock lock;
+  std::atomic<bool> acquired(false);
+  std::thread other;
+  {  // start places write
+    DsgGuard places(lock, DsgAccess().write(DsgLockLayer::PLACES), "places");
+    other = std::thread([&] {
+      DsgGuard reader(lock, DsgAccess().read(DsgLockLayer::PLACES), "reader");
+      acquired = true;
+    });
+
+    std::this_thread::sleep_for(20ms);
+    EXPECT_FALSE(acquired);
+  }  // end places write
+
+  other.join();
+  EXPECT_TRUE(acquired);
+
+  {  // a structural change waits for every reader
+    DsgGuard exclusive(lock, DsgAccess::Exclusive(), "exclusive");
+  }
+
+  const auto stats = lock.getStats();
+  ASSERT_EQ(1u, stats.count("reader"));
+  EXPECT_EQ(1u, stats.at("reader").num_contended);
+  EXPECT_GT(stats.at("reader").total_wait_s, 0.0);
+  EXPECT_EQ(stats.at("reader").total_wait_s, stats.at("reader").max_wait_s);
+  EXPECT_EQ(0u, stats.at("exclusive").num_contended);
+}
+
+TEST(DsgLockTests, MultipleGraphs) {
+  DsgLock private_lock;
+  DsgLock shared_lock;
+  {  // the private graph is locked before the shared graph
+    DsgGuard private_guard(private_lock, DsgAccess::Exclusive(), "private");
+    DsgGuard shared_guard(shared_lock, DsgAccess::Shared(), "shared");
+  }
+
+  // released guards can be reacquired by the same thread
+  DsgGuard private_guard(private_lock, DsgAccess::Shared(), "private");
+  EXPECT_EQ(1u, shared_lock.getStats().at("shared").num_acquisitions);
+  EXPECT_EQ(2u, private_lock.getStats().at("private").num_acquisitions);
+}
+
+}  // namespace incremental
+}  // namespace hydra
@@ -0,0 +1,231 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra_dsg_builder/incremental_clustering.h>
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <set>
+
+namespace hydra {
+namespace incremental {
+
+using Partition = std::set<std::set<size_t>>;
+using Points = std::map<size_t, Eigen::Vector3f>;
+
+std::vector<size_t> getIndices(const Points& points) {
+  std::vector<size_t> indices;
+  for (const auto& idx_pos_pair : points) {
+    indices.push_back(idx_pos_pair.first);
+  }
+  return indices;
+}
+
+void updateClusterer(IncrementalClusterer& clusterer, const Points& points) {
+  clusterer.update(getIndices(points), [&](size_t idx) { return points.at(idx); });
+}
+
+// brute-force connected components over all pairs within the tolerance
+Partition bruteForceClusters(const Points& points, double tolerance) {
+  Partition clusters;
+  std::set<size_t> visited;
+  for (const auto& idx_pos_pair : points) {
+    if (visited.count(idx_pos_pair.first)) {
+      continue;
+    }
+
+    std::set<size_t> cluster;
+    std::vector<size_t> frontier{idx_pos_pair.first};
+    visited.insert(idx_pos_pair.first);
+    while (!frontier.empty()) {
+      const size_t curr = frontier.back();
+      frontier.pop_back();
+      cluster.insert(curr);
+      for (const auto& other : points) {
+        if (visited.count(other.first) ||
+            (other.second - points.at(curr)).norm() > tolerance) {
+          continue;
+        }
+        visited.insert(other.first);
+        frontier.push_back(other.first);
+      }
+    }
+
+    clusters.insert(cluster);
+  }
+
+  return clusters;
+}
+
+Partition getPartition(IncrementalClusterer& clusterer, const Points& points) {
+  // a point in every cluster changes when all points are re-inserted
+  IncrementalClusterer copy = clusterer;
+  updateClusterer(copy, {});
+  updateClusterer(copy, points);
+  Partition clusters;
+  for (const auto& cluster : copy.popChangedClusters()) {
+    clusters.insert(std::set<size_t>(cluster.indices.begin(), cluster.indices.end()));
+  }
+  return clusters;
+}
+
+std::map<uint64_t, std::set<size_t>> popChanged(IncrementalClusterer& clusterer) {
+  std::map<uint64_t, std::set<size_t>> changed;
+  for (const auto& cluster : clusterer.popChangedClusters()) {
+    changed[cluster.id] = std::set<size_t>(cluster.indices.begin(), cluster.indices.end());
+  }
+  return changed;
+}
+
+TEST(IncrementalClustering, MatchesBatchClustering) {
+  const double tolerance = 0.3;
+  IncrementalClusterer clusterer(tolerance, 1, 100000);
+
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<float> coord(0.0, 3.0);
+  std::uniform_int_distribution<size_t> index(0, 399);
+
+  Points points;
+  for (size_t i = 0; i < 200; ++i) {
+    points[index(rng)] = Eigen::Vector3f(coord(rng), coord(rng), coord(rng));
+  }
+
+  for (size_t iter = 0; iter < 20; ++iter) {
+    updateClusterer(clusterer, points);
+    clusterer.popChangedClusters();
+
+    // updating with the same points doesn't change anything
+    updateClusterer(clusterer, points);
+    EXPECT_TRUE(clusterer.popChangedClusters().empty());
+
+    IncrementalClusterer batch(tolerance, 1, 100000);
+    updateClusterer(batch, points);
+    Partition expected = bruteForceClusters(points, tolerance);
+    Partition incremental;
+    size_t num_points = 0;
+    for (const auto& cluster : batch.popChangedClusters()) {
+      incremental.insert(std::set<size_t>(cluster.indices.begin(), cluster.indices.end()));
+      num_points += cluster.indices.size();
+    }
+    EXPECT_EQ(expected, incremental);
+    EXPECT_EQ(points.size(), num_points);
+    EXPECT_EQ(expected.size(), clusterer.numClusters());
+    EXPECT_EQ(expected, getPartition(clusterer, points));
+
+    // remove, move and add some points
+    for (size_t i = 0; i < 20; ++i) {
+      points.erase(index(rng));
+      const size_t to_move = index(rng);
+      if (points.count(to_move)) {
+        points[to_move] = Eigen::Vector3f(coord(rng), coord(rng), coord(rng));
+      }
+      points[index(rng)] = Eigen::Vector3f(coord(rng), coord(rng), coord(rng));
+    }
+  }
+}
+
+TEST(IncrementalClustering, ClusterIdsPersist) {
+  IncrementalClusterer clusterer(0.15, 2, 100000);
+
+  // two lines of points that are far apart
+  Points points;
+  for (size_t i = 0; i < 10; ++i) {
+    points[i] = Eigen::Vector3f(0.1 * i, 0.0, 0.0);
+    points[100 + i] = Eigen::Vector3f(0.1 * i, 5.0, 0.0);
+  }
+  updateClusterer(clusterer, points);
+
+  auto changed = popChanged(clusterer);
+  ASSERT_EQ(2u, changed.size());
+  uint64_t first_id = 0;
+  uint64_t second_id = 0;
+  for (const auto& id_cluster_pair : changed) {
+    if (id_cluster_pair.second.count(0)) {
+      first_id = id_cluster_pair.first;
+    } else {
+      second_id = id_cluster_pair.first;
+    }
+  }
+  EXPECT_NE(first_id, second_id);
+
+  // growing one cluster only reports that cluster and keeps its id
+  points[10] = Eigen::Vector3f(1.0, 0.0, 0.0);
+  updateClusterer(clusterer, points);
+  changed = popChanged(clusterer);
+  ASSERT_EQ(1u, changed.size());
+  EXPECT_EQ(first_id, changed.begin()->first);
+  EXPECT_EQ(11u, changed.begin()->second.size());
+
+  // bridging the two clusters keeps the id of the larger cluster
+  for (size_t i = 0; i < 49; ++i) {
+    points[200 + i] = Eigen::Vector3f(0.0, 0.1 * (i + 1), 0.0);
+  }
+  updateClusterer(clusterer, points);
+  changed = popChanged(clusterer);
+  ASSERT_EQ(1u, changed.size());
+  EXPECT_EQ(first_id, changed.begin()->first);
+  EXPECT_EQ(1u, clusterer.numClusters());
+
+  // breaking the bridge keeps the id for the largest piece
+  points.erase(210);
+  updateClusterer(clusterer, points);
+  changed = popChanged(clusterer);
+  ASSERT_EQ(2u, changed.size());
+  EXPECT_EQ(2u, clusterer.getClusterIds().size());
+  ASSERT_EQ(1u, changed.count(first_id));
+  EXPECT_EQ(48u, changed.at(first_id).size());  // 10 in second line, 38 in bridge
+  EXPECT_EQ(0u, changed.count(second_id));
+
+  // unchanged clusters can be reported again on request
+  EXPECT_TRUE(popChanged(clusterer).empty());
+  clusterer.markChanged(first_id);
+  clusterer.markChanged(second_id);  // ids of clusters that are gone are ignored
+  changed = popChanged(clusterer);
+  ASSERT_EQ(1u, changed.size());
+  ASSERT_EQ(1u, changed.count(first_id));
+  EXPECT_EQ(48u, changed.at(first_id).size());
+
+  // clusters below the minimum size are not reported
+  points.clear();
+  points[0] = Eigen::Vector3f::Zero();
+  updateClusterer(clusterer, points);
+  EXPECT_TRUE(popChanged(clusterer).empty());
+  EXPECT_TRUE(clusterer.getClusterIds().empty());
+  EXPECT_EQ(1u, clusterer.numPoints());
+}
+
+}  // namespace incremental
+}  // namespace hydra
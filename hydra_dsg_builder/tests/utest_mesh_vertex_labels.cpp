@@ -0,0 +1,79 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra_dsg_builder/mesh_vertex_labels.h>
+
+namespace hydra {
+namespace incremental {
+
+TEST(MeshVertexLabels, DecodesNewVerticesOnce) {
+  MeshVertexLabels labels;
+
+  std::vector<size_t> decoded;
+  const auto decode = [&](size_t idx) -> uint8_t {
+    decoded.push_back(idx);
+    return idx % 3;
+  };
+
+  EXPECT_EQ(5u, labels.update(5, decode));
+  EXPECT_EQ(5u, labels.size());
+  EXPECT_EQ(std::vector<size_t>({0, 1, 2, 3, 4}), decoded);
+  EXPECT_EQ(std::vector<uint8_t>({0, 1, 2, 0, 1}), labels.getLabels());
+  EXPECT_EQ(0u, labels.getLabel(3));
+  EXPECT_TRUE(labels.hasLabel(4));
+  EXPECT_FALSE(labels.hasLabel(5));
+
+  // only appended vertices are decoded
+  decoded.clear();
+  EXPECT_EQ(0u, labels.update(5, decode));
+  EXPECT_TRUE(decoded.empty());
+  EXPECT_EQ(2u, labels.update(7, decode));
+  EXPECT_EQ(std::vector<size_t>({5, 6}), decoded);
+  EXPECT_EQ(2u, labels.getLabel(5));
+  EXPECT_EQ(0u, labels.getLabel(6));
+}
+
+TEST(MeshVertexLabels, ResetOnShrink) {
+  MeshVertexLabels labels;
+  EXPECT_EQ(4u, labels.update(4, [](size_t) -> uint8_t { return 1; }));
+  EXPECT_EQ(4u, labels.size());
+
+  EXPECT_EQ(2u, labels.update(2, [](size_t) -> uint8_t { return 0; }));
+  EXPECT_EQ(2u, labels.size());
+  EXPECT_EQ(std::vector<uint8_t>({0, 0}), labels.getLabels());
+}
+
+}  // namespace incremental
+}  // namespace hydra
@@ -0,0 +1,141 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra_dsg_builder/object_overlap_index.h>
+
+#include <Eigen/Geometry>
+
+#include <random>
+
+namespace hydra {
+namespace incremental {
+
+struct TestObject {
+  uint8_t label;
+  BoundingBox bounding_box;
+  Eigen::Vector3f position;
+};
+
+TEST(ObjectOverlapIndex, MatchesPairwiseChecks) {
+  std::mt19937 rng(13);
+  std::uniform_real_distribution<float> coord(-5.0, 5.0);
+  std::uniform_real_distribution<float> extent(0.1, 2.5);
+  std::uniform_int_distribution<int> label_dist(0, 2);
+
+  const auto random_object = [&]() {
+    const Eigen::Vector3f center(coord(rng), coord(rng), coord(rng));
+    const Eigen::Vector3f half(extent(rng), extent(rng), extent(rng));
+    return TestObject{static_cast<uint8_t>(label_dist(rng)),
+                      BoundingBox(center - half, center + half),
+                      center};
+  };
+
+  ObjectOverlapIndex index(0.7);
+  std::map<NodeId, TestObject> objects;
+  for (NodeId node = 0; node < 200; ++node) {
+    objects[node] = random_object();
+    const auto& object = objects[node];
+    index.update(node, object.label, object.bounding_box, object.position);
+  }
+
+  // move some objects and remove others
+  for (NodeId node = 0; node < 200; node += 3) {
+    objects[node] = random_object();
+    const auto& object = objects[node];
+    index.update(node, object.label, object.bounding_box, object.position);
+  }
+  for (NodeId node = 1; node < 200; node += 7) {
+    objects.erase(node);
+    index.remove(node);
+  }
+  EXPECT_EQ(objects.size(), index.size());
+
+  for (const auto& id_object_pair : objects) {
+    const auto& object = id_object_pair.second;
+    std::vector<NodeId> expected_boxes;
+    std::vector<NodeId> expected_positions;
+    for (const auto& other : objects) {
+      if (other.second.label != object.label) {
+        continue;
+      }
+
+      if (other.second.bounding_box.isInside(object.position)) {
+        expected_boxes.push_back(other.first);
+      }
+
+      if (object.bounding_box.isInside(other.second.position)) {
+        expected_positions.push_back(other.first);
+      }
+    }
+
+    EXPECT_EQ(expected_boxes, index.findBoxesContaining(object.label, object.position));
+    EXPECT_EQ(expected_positions,
+              index.findPositionsInside(object.label, object.bounding_box));
+  }
+}
+
+TEST(ObjectOverlapIndex, RotatedBoxes) {
+  const Eigen::Quaternionf rotation(
+      Eigen::AngleAxisf(M_PI / 4.0, Eigen::Vector3f::UnitZ()));
+  const BoundingBox box(Eigen::Vector3f(-2.0, -0.1, -0.1),
+                        Eigen::Vector3f(2.0, 0.1, 0.1),
+                        Eigen::Vector3f(10.0, 10.0, 0.0),
+                        rotation);
+
+  Eigen::Vector3f min;
+  Eigen::Vector3f max;
+  ObjectOverlapIndex::getWorldBounds(box, min, max);
+  EXPECT_NEAR(min.x(), 10.0 - 1.4849, 1.0e-3);
+  EXPECT_NEAR(max.y(), 10.0 + 1.4849, 1.0e-3);
+  EXPECT_NEAR(max.z(), 0.1, 1.0e-6);
+
+  ObjectOverlapIndex index(0.5);
+  index.update(1, 0, box, Eigen::Vector3f(10.0, 10.0, 0.0));
+  // along the diagonal of the box
+  EXPECT_EQ(std::vector<NodeId>({1}),
+            index.findBoxesContaining(0, Eigen::Vector3f(11.2, 11.2, 0.0)));
+  // inside the world bounds but outside the box
+  EXPECT_TRUE(index.findBoxesContaining(0, Eigen::Vector3f(11.2, 8.8, 0.0)).empty());
+  // different label
+  EXPECT_TRUE(index.findBoxesContaining(1, Eigen::Vector3f(10.0, 10.0, 0.0)).empty());
+
+  index.remove(1);
+  EXPECT_FALSE(index.contains(1));
+  EXPECT_TRUE(index.findBoxesContaining(0, Eigen::Vector3f(10.0, 10.0, 0.0)).empty());
+  EXPECT_TRUE(index.findPositionsInside(0, box).empty());
+}
+
+}  // namespace incremental
+}  // namespace hydra
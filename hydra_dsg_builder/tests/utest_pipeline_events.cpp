@@ -0,0 +1,98 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra_dsg_builder/pipeline_events.h>
+
+#include <atomic>
+#include <thread>
+
+namespace hydra {
+namespace incremental {
+
+using namespace std::chrono_literals;
+
+TEST(PipelineEventTests, NotifyWakesWaiter) {
+  PipelineEvent event;
+  std::atomic<bool> ready(false);
+
+  std::thread producer([&] {
+    std::this_thread::sleep_for(10ms);
+    ready = true;
+    event.notify();
+  });
+
+  const auto start = std::chrono::steady_clock::now();
+  EXPECT_TRUE(event.wait([&] { return ready.load(); }, 10s));
+  EXPECT_LT(std::chrono::steady_clock::now() - start, 5s);
+  producer.join();
+
+  // the condition is checked before waiting
+  EXPECT_TRUE(event.wait([&] { return ready.load(); }, 0ms));
+  EXPECT_FALSE(event.wait([] { return false; }, 1ms));
+}
+
+TEST(PipelineEventTests, ChangesAreNotLost) {
+  PipelineEvent event;
+  const uint64_t generation = event.generation();
+
+  // a notification between reading the generation and waiting is still seen
+  event.notify();
+  const auto start = std::chrono::steady_clock::now();
+  EXPECT_EQ(generation + 1, event.waitForChange(generation, 10s));
+  EXPECT_LT(std::chrono::steady_clock::now() - start, 5s);
+
+  // nothing changed since the latest generation
+  EXPECT_EQ(generation + 1, event.waitForChange(generation + 1, 1ms));
+}
+
+TEST(PipelineEventTests, ThrottleLimitsRate) {
+  RateThrottle unlimited(0.0);
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < 5; ++i) {
+    unlimited.throttle();
+  }
+  EXPECT_LT(std::chrono::steady_clock::now() - start, 50ms);
+
+  RateThrottle limited(50.0);
+  const auto limited_start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < 4; ++i) {
+    limited.throttle();
+  }
+  // the first call doesn't wait, the next three wait for 20 ms each
+  EXPECT_GE(std::chrono::steady_clock::now() - limited_start, 60ms);
+}
+
+}  // namespace incremental
+}  // namespace hydra
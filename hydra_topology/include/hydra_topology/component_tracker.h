@@ -0,0 +1,100 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <hydra_utils/dsg_types.h>
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace hydra {
+namespace topology {
+
+/**
+ * @brief Incrementally tracks the connected components of the extracted graph
+ *
+ * Insertions are merged with union-find. Deletions only mark the component they
+ * happened in, and the marked components are rebuilt from the graph on the next call
+ * to update. Components that were merged or rebuilt are reported as changed until
+ * clearChanged is called.
+ */
+class ComponentTracker {
+ public:
+  void addNode(NodeId node);
+
+  void addEdge(NodeId source, NodeId target);
+
+  //! Mark the component of the node for a rebuild (the node is dropped then)
+  void removeNode(NodeId node);
+
+  //! Mark the component of the edge for a rebuild
+  void removeEdge(NodeId source, NodeId target);
+
+  //! Rebuild every component that had a deletion since the last update
+  void update(const SceneGraphLayer& graph);
+
+  //! Representative node of the component containing the node
+  NodeId getComponent(NodeId node);
+
+  size_t getComponentSize(NodeId node);
+
+  bool hasChanged(NodeId node);
+
+  //! Report the component of the node as changed (e.g., to retry bridging it)
+  void markChanged(NodeId node);
+
+  inline void clearChanged() { changed_.clear(); }
+
+  inline bool hasNode(NodeId node) const { return parents_.count(node); }
+
+  inline size_t numNodes() const { return parents_.size(); }
+
+  inline size_t numComponents() const { return members_.size(); }
+
+  size_t getMemorySize() const;
+
+ private:
+  NodeId find(NodeId node);
+
+  void merge(NodeId lhs, NodeId rhs);
+
+  std::unordered_map<NodeId, NodeId> parents_;
+  std::unordered_map<NodeId, std::vector<NodeId>> members_;
+  std::unordered_set<NodeId> to_rebuild_;
+  std::unordered_set<NodeId> changed_;
+};
+
+}  // namespace topology
+}  // namespace hydra
@@ -34,6 +34,8 @@
  * -------------------------------------------------------------------------- */
 #pragma once
 #include "hydra_topology/gvd_integrator.h"
+#include "hydra_topology/memory_governor.h"
+#include "hydra_topology/update_scheduler.h"
 
 #include <hydra_utils/config.h>
 #include <voxblox_ros/mesh_vis.h>
@@ -74,6 +76,14 @@ struct TopologyServerConfig {
   bool clear_distant_blocks = true;
   double dense_representation_radius_m = 5.0;
   bool publish_archived = true;
+  bool publish_active_topics = true;
+  bool pipeline_graph_extraction = false;
+  //! Publish every active place once per this many updates (otherwise only changes)
+  size_t places_full_update_period = 20;
+  //! Send places with the binary layer encoding (instead of JSON)
+  bool binary_layer_encoding = true;
+  MemoryGovernorConfig memory_governor;
+  UpdateSchedulerConfig update_scheduler;
 
   voxblox::ColorMode mesh_color_mode = voxblox::ColorMode::kLambertColor;
   std::string world_frame = "world";
@@ -95,6 +105,7 @@ void visit_config(const Visitor& v, GraphExtractorConfig& config) {
   v.visit("node_merge_distance_m", config.node_merge_distance_m);
   v.visit("edge_splitting_merge_nodes", config.edge_splitting_merge_nodes);
   v.visit("max_edge_split_iterations", config.max_edge_split_iterations);
+  v.visit("edge_splitting_threads", config.edge_splitting_threads);
   v.visit("max_edge_deviation", config.max_edge_deviation);
   v.visit("add_freespace_edges", config.add_freespace_edges);
   v.visit("freespace_active_neighborhood_hops",
@@ -107,6 +118,7 @@ void visit_config(const Visitor& v, GraphExtractorConfig& config) {
   v.visit("component_nearest_neighbors", config.component_nearest_neighbors);
   v.visit("component_max_edge_length_m", config.component_max_edge_length_m);
   v.visit("component_min_clearance_m", config.component_min_clearance_m);
+  v.visit("sphere_trace_edges", config.sphere_trace_edges);
   v.visit("remove_isolated_nodes", config.remove_isolated_nodes);
 }
 
@@ -128,12 +140,39 @@ void visit_config(const Visitor& v, GvdIntegratorConfig& config) {
   v.visit("mesh_only", config.mesh_only);
 }
 
+template <typename Visitor>
+void visit_config(const Visitor& v, MemoryGovernorConfig& config) {
+  v.visit("budget_mb", config.budget_mb);
+  v.visit("restore_fraction", config.restore_fraction);
+  v.visit("shrink_factor", config.shrink_factor);
+  v.visit("grow_factor", config.grow_factor);
+  v.visit("min_radius_m", config.min_radius_m);
+  v.visit("max_archived_blocks", config.max_archived_blocks);
+}
+
+template <typename Visitor>
+void visit_config(const Visitor& v, UpdateSchedulerConfig& config) {
+  v.visit("enable", config.enable);
+  v.visit("min_period_s", config.min_period_s);
+  v.visit("max_period_s", config.max_period_s);
+  v.visit("target_cpu_fraction", config.target_cpu_fraction);
+  v.visit("min_changed_blocks", config.min_changed_blocks);
+  v.visit("urgent_changed_blocks", config.urgent_changed_blocks);
+  v.visit("cost_alpha", config.cost_alpha);
+}
+
 template <typename Visitor>
 void visit_config(const Visitor& v, TopologyServerConfig& config) {
   v.visit("update_period_s", config.update_period_s);
   v.visit("show_stats", config.show_stats);
   v.visit("dense_representation_radius_m", config.dense_representation_radius_m);
   v.visit("publish_archived", config.publish_archived);
+  v.visit("publish_active_topics", config.publish_active_topics);
+  v.visit("pipeline_graph_extraction", config.pipeline_graph_extraction);
+  v.visit("places_full_update_period", config.places_full_update_period);
+  v.visit("binary_layer_encoding", config.binary_layer_encoding);
+  v.visit("memory_governor", config.memory_governor);
+  v.visit("update_scheduler", config.update_scheduler);
   v.visit("mesh_color_mode", config.mesh_color_mode);
   v.visit("world_frame", config.world_frame);
 }
@@ -143,6 +182,8 @@ void visit_config(const Visitor& v, TopologyServerConfig& config) {
 
 DECLARE_CONFIG_OSTREAM_OPERATOR(voxblox, MeshIntegratorConfig)
 DECLARE_CONFIG_OSTREAM_OPERATOR(hydra::topology, TopologyServerConfig)
+DECLARE_CONFIG_OSTREAM_OPERATOR(hydra::topology, MemoryGovernorConfig)
+DECLARE_CONFIG_OSTREAM_OPERATOR(hydra::topology, UpdateSchedulerConfig)
 DECLARE_CONFIG_OSTREAM_OPERATOR(hydra::topology, VoronoiCheckConfig)
 DECLARE_CONFIG_OSTREAM_OPERATOR(hydra::topology, GraphExtractorConfig)
 DECLARE_CONFIG_OSTREAM_OPERATOR(hydra::topology, GvdIntegratorConfig)
@@ -0,0 +1,317 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace hydra {
+namespace topology {
+
+/**
+ * @brief Sorted set of ids that stores up to N entries without allocating
+ *
+ * Most GVD edges and nodes only touch a handful of other edges, so the node-based
+ * std::set previously used for this bookkeeping spent most of its time in the
+ * allocator. Iteration order is ascending (same as std::set).
+ */
+template <typename T, size_t N = 4>
+class SmallIdSet {
+ public:
+  using value_type = T;
+  using const_iterator = const T*;
+  using iterator = const_iterator;
+
+  SmallIdSet() = default;
+
+  SmallIdSet(const SmallIdSet& other) = default;
+
+  SmallIdSet(SmallIdSet&& other) noexcept { *this = std::move(other); }
+
+  SmallIdSet& operator=(const SmallIdSet& other) = default;
+
+  SmallIdSet& operator=(SmallIdSet&& other) noexcept {
+    size_ = other.size_;
+    on_heap_ = other.on_heap_;
+    inline_ = other.inline_;
+    heap_ = std::move(other.heap_);
+    other.size_ = 0;
+    other.on_heap_ = false;
+    other.heap_.clear();
+    return *this;
+  }
+
+  inline const_iterator begin() const { return data(); }
+
+  inline const_iterator end() const { return data() + size_; }
+
+  inline size_t size() const { return size_; }
+
+  inline bool empty() const { return size_ == 0; }
+
+  inline size_t count(const T& value) const {
+    return std::binary_search(begin(), end(), value) ? 1 : 0;
+  }
+
+  std::pair<const_iterator, bool> insert(const T& value) {
+    const_iterator pos = std::lower_bound(begin(), end(), value);
+    const size_t offset = pos - begin();
+    if (pos != end() && *pos == value) {
+      return {pos, false};
+    }
+
+    if (!on_heap_ && size_ < N) {
+      std::copy_backward(inline_.begin() + offset,
+                         inline_.begin() + size_,
+                         inline_.begin() + size_ + 1);
+      inline_[offset] = value;
+    } else {
+      if (!on_heap_) {
+        heap_.reserve(2 * N);
+        heap_.assign(inline_.begin(), inline_.begin() + size_);
+        on_heap_ = true;
+      }
+      heap_.insert(heap_.begin() + offset, value);
+    }
+
+    ++size_;
+    return {begin() + offset, true};
+  }
+
+  size_t erase(const T& value) {
+    const_iterator pos = std::lower_bound(begin(), end(), value);
+    if (pos == end() || *pos != value) {
+      return 0;
+    }
+
+    const size_t offset = pos - begin();
+    if (on_heap_) {
+      heap_.erase(heap_.begin() + offset);
+    } else {
+      std::copy(inline_.begin() + offset + 1,
+                inline_.begin() + size_,
+                inline_.begin() + offset);
+    }
+
+    --size_;
+    return 1;
+  }
+
+  void clear() {
+    size_ = 0;
+    on_heap_ = false;
+    heap_.clear();
+  }
+
+  //! bytes allocated outside of the object itself
+  inline size_t getMemorySize() const { return heap_.capacity() * sizeof(T); }
+
+ private:
+  inline const T* data() const { return on_heap_ ? heap_.data() : inline_.data(); }
+
+  size_t size_ = 0;
+  bool on_heap_ = false;
+  std::array<T, N> inline_{};
+  std::vector<T> heap_;
+};
+
+/**
+ * @brief Map that keeps values contiguous and indirects keys through a slot table
+ *
+ * The slot table is an open-addressing (linear probing) array of slot indices, so
+ * lookups only touch a flat array and the dense keys. Erasing moves the last value
+ * into the freed slot, so references and slots are only stable until the next
+ * insertion or erasure.
+ */
+template <typename Key, typename Value>
+class SlotMap {
+ public:
+  using const_iterator = typename std::vector<Value>::const_iterator;
+
+  Value& operator[](const Key& key) {
+    const size_t slot = findSlot(key);
+    if (slot != kEmpty) {
+      return values_[slot];
+    }
+
+    // keep the table at most half full so probe sequences stay short
+    if (2 * (values_.size() + 1) > table_.size()) {
+      rehash(std::max(kMinTableSize, 2 * table_.size()));
+    }
+
+    table_[findBucket(key)] = values_.size();
+    keys_.push_back(key);
+    values_.emplace_back();
+    return values_.back();
+  }
+
+  inline Value& at(const Key& key) { return values_[checkedSlot(key)]; }
+
+  inline const Value& at(const Key& key) const { return values_[checkedSlot(key)]; }
+
+  inline Value* find(const Key& key) {
+    const size_t slot = findSlot(key);
+    return slot == kEmpty ? nullptr : &values_[slot];
+  }
+
+  inline const Value* find(const Key& key) const {
+    const size_t slot = findSlot(key);
+    return slot == kEmpty ? nullptr : &values_[slot];
+  }
+
+  inline size_t count(const Key& key) const { return findSlot(key) == kEmpty ? 0 : 1; }
+
+  size_t erase(const Key& key) {
+    if (table_.empty()) {
+      return 0;
+    }
+
+    const size_t bucket = findBucket(key);
+    const size_t slot = table_[bucket];
+    if (slot == kEmpty) {
+      return 0;
+    }
+
+    removeBucket(bucket);
+
+    const size_t last = values_.size() - 1;
+    if (slot != last) {
+      values_[slot] = std::move(values_[last]);
+      keys_[slot] = keys_[last];
+      table_[findBucket(keys_[slot])] = slot;
+    }
+
+    values_.pop_back();
+    keys_.pop_back();
+    return 1;
+  }
+
+  inline void clear() {
+    std::fill(table_.begin(), table_.end(), kEmpty);
+    keys_.clear();
+    values_.clear();
+  }
+
+  inline size_t size() const { return values_.size(); }
+
+  inline bool empty() const { return values_.empty(); }
+
+  //! keys in slot order (i.e. keys()[i] owns values()[i])
+  inline const std::vector<Key>& keys() const { return keys_; }
+
+  inline const std::vector<Value>& values() const { return values_; }
+
+  //! bytes used by the slot table and dense storage (not by the values' contents)
+  size_t getMemorySize() const {
+    return table_.capacity() * sizeof(size_t) + keys_.capacity() * sizeof(Key) +
+           values_.capacity() * sizeof(Value);
+  }
+
+ private:
+  static constexpr size_t kEmpty = std::numeric_limits<size_t>::max();
+  static constexpr size_t kMinTableSize = 16;
+
+  inline size_t getHomeBucket(const Key& key) const {
+    // std::hash is the identity for integers, so the bits are mixed before masking
+    const uint64_t hash = static_cast<uint64_t>(std::hash<Key>()(key));
+    return (hash * 0x9e3779b97f4a7c15ull) >> hash_shift_;
+  }
+
+  //! bucket that holds the slot of the key (or the empty bucket it would go into)
+  size_t findBucket(const Key& key) const {
+    const size_t mask = table_.size() - 1;
+    size_t bucket = getHomeBucket(key);
+    while (table_[bucket] != kEmpty && !(keys_[table_[bucket]] == key)) {
+      bucket = (bucket + 1) & mask;
+    }
+    return bucket;
+  }
+
+  inline size_t findSlot(const Key& key) const {
+    return table_.empty() ? kEmpty : table_[findBucket(key)];
+  }
+
+  inline size_t checkedSlot(const Key& key) const {
+    const size_t slot = findSlot(key);
+    if (slot == kEmpty) {
+      throw std::out_of_range("key not in slot map");
+    }
+    return slot;
+  }
+
+  //! empty the bucket and shift back later entries of the probe sequence
+  void removeBucket(size_t bucket) {
+    const size_t mask = table_.size() - 1;
+    size_t next = (bucket + 1) & mask;
+    while (table_[next] != kEmpty) {
+      // entries can only move back if that doesn't put them before their home
+      const size_t home = getHomeBucket(keys_[table_[next]]);
+      if (((next - home) & mask) >= ((next - bucket) & mask)) {
+        table_[bucket] = table_[next];
+        bucket = next;
+      }
+
+      next = (next + 1) & mask;
+    }
+
+    table_[bucket] = kEmpty;
+  }
+
+  void rehash(size_t table_size) {
+    table_.assign(table_size, kEmpty);
+    hash_shift_ = 64;
+    for (size_t i = table_size; i > 1; i >>= 1) {
+      --hash_shift_;
+    }
+
+    for (size_t slot = 0; slot < keys_.size(); ++slot) {
+      table_[findBucket(keys_[slot])] = slot;
+    }
+  }
+
+  //! power-of-two sized (or empty) table of slot indices
+  std::vector<size_t> table_;
+  //! the home bucket uses the top log2(table size) bits of the mixed hash
+  size_t hash_shift_ = 64;
+  std::vector<Key> keys_;
+  std::vector<Value> values_;
+};
+
+}  // namespace topology
+}  // namespace hydra
@@ -38,6 +38,7 @@
 
 #include <hydra_utils/dsg_types.h>
 
+#include <array>
 #include <bitset>
 #include <iostream>
 
@@ -46,10 +47,22 @@ namespace topology {
 
 std::bitset<27> convertRowMajorFlags(std::bitset<27> flags_row_major);
 
+/**
+ * @brief Get which voxels in the 26-connected neighborhood (plus the center) are GVD
+ * voxels, with bit order matching the voxblox neighborhood offsets
+ *
+ * Reads the voxels directly from the block when the neighborhood doesn't cross a
+ * block boundary
+ */
 std::bitset<27> extractNeighborhoodFlags(const Layer<GvdVoxel>& layer,
                                          const GlobalIndex& index,
                                          uint8_t min_extra_basis = 1);
 
+//! Same as extractNeighborhoodFlags, but looks up each voxel by global index
+std::bitset<27> extractNeighborhoodFlagsByIndex(const Layer<GvdVoxel>& layer,
+                                                const GlobalIndex& index,
+                                                uint8_t min_extra_basis = 1);
+
 struct GvdCornerTemplate {
   using MaskArray = std::array<std::bitset<27>, 4>;
 
@@ -100,6 +113,30 @@ struct CornerFinder {
   GvdCornerTemplate positive_z_template;
 };
 
+/**
+ * @brief Lookup-table version of CornerFinder::match
+ *
+ * Each template rotation only constrains the bits outside of its unused mask, so the
+ * rules can be checked independently for each 9-bit slice of the neighborhood. Each
+ * table entry stores which of the 24 rules the slice value satisfies, and a
+ * neighborhood matches a corner if any rule is satisfied by all three slices.
+ */
+class CornerClassifier {
+ public:
+  CornerClassifier();
+
+  explicit CornerClassifier(const CornerFinder& finder);
+
+  inline bool match(std::bitset<27> values) const {
+    const uint32_t bits = values.to_ulong();
+    return (tables_[0][bits & 0x1FF] & tables_[1][(bits >> 9) & 0x1FF] &
+            tables_[2][bits >> 18]) != 0;
+  }
+
+ private:
+  std::array<std::array<uint32_t, 512>, 3> tables_;
+};
+
 voxblox::AlignedVector<GlobalIndex> makeBresenhamLine(const GlobalIndex& start,
                                                       const GlobalIndex& end);
 
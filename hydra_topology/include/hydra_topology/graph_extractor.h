@@ -33,10 +33,13 @@
  * purposes notwithstanding any copyright notation herein.
  * -------------------------------------------------------------------------- */
 #pragma once
+#include "hydra_topology/component_tracker.h"
 #include "hydra_topology/graph_extraction_utilities.h"
 #include "hydra_topology/graph_extractor_types.h"
 #include "hydra_topology/gvd_voxel.h"
+#include "hydra_topology/nearest_neighbor_utilities.h"
 #include "hydra_topology/voxblox_types.h"
+#include "hydra_topology/worker_pool.h"
 
 #include <queue>
 
@@ -69,6 +72,8 @@ struct GraphExtractorConfig {
   bool edge_splitting_merge_nodes = true;
   //! Number of maximum iterations to run edges splitting (set to 0 to disable)
   size_t max_edge_split_iterations = 5;
+  //! Number of threads used to find the best split for each candidate edge
+  size_t edge_splitting_threads = 1;
   //! Maximum squared voxel distance an edge can be from supporting voxels at any point
   int64_t max_edge_deviation = 4;
   //! Add edges between nodes that have overlapping free-space regions
@@ -93,6 +98,10 @@ struct GraphExtractorConfig {
   double component_max_edge_length_m = 5.0;
   //! Minimum distance from obstacle for a straight-line edge
   double component_min_clearance_m = 0.2;
+  /** @brief Use the GVD distance to skip ahead when checking straight-line edges
+   *  @warning Skipped voxels are not checked for being observed
+   */
+  bool sphere_trace_edges = false;
   //! Remove nodes with no edges
   bool remove_isolated_nodes = true;
 };
@@ -104,13 +113,14 @@ class GraphExtractor {
 
   // TODO(nathan) may need aligned allocator
   using NodeIdRootMap = std::unordered_map<NodeId, GlobalIndex>;
-  using NodeIdIndexMap = std::unordered_map<NodeId, voxblox::LongIndexSet>;
+  using NodeIdIndexMap = SlotMap<NodeId, voxblox::LongIndexSet>;
+  using NodeIdEdgeMap = SlotMap<NodeId, EdgeIdSet>;
   using IndexGraphInfoMap = voxblox::LongIndexHashMapType<VoxelGraphInfo>::type;
   using EdgeInfoMap = std::unordered_map<size_t, EdgeInfo>;
   using EdgeSplitQueue =
       std::priority_queue<EdgeSplitSeed, voxblox::AlignedVector<EdgeSplitSeed>>;
   using PseudoEdgeInfoMap = std::map<size_t, PseudoEdgeInfo>;
-  using PseudoEdgeMap = voxblox::LongIndexHashMapType<std::unordered_set<size_t>>::type;
+  using PseudoEdgeMap = voxblox::LongIndexHashMapType<EdgeIdSet>::type;
   using Components = std::vector<std::vector<NodeId>>;
 
   explicit GraphExtractor(const GraphExtractorConfig& config);
@@ -125,9 +135,25 @@ class GraphExtractor {
 
   void extract(const GvdLayer& layer);
 
-  void assignMeshVertices(const GvdLayer& gvd,
-                          const GvdParentMap& parents,
-                          const GvdVertexMap& parent_vertices);
+  /**
+   * @brief Update the mesh connections of every node whose inputs changed
+   *
+   * Nodes are reassigned if they are new, if their root voxel is in a block passed to
+   * markBlockChanged, or if they use a parent passed to markParentVertexChanged
+   *
+   * @returns Number of nodes that were reassigned
+   */
+  size_t assignMeshVertices(const GvdLayer& gvd,
+                            const GvdParentMap& parents,
+                            const GvdVertexMap& parent_vertices);
+
+  inline void markBlockChanged(const BlockIndex& block) {
+    changed_mesh_blocks_.insert(block);
+  }
+
+  inline void markParentVertexChanged(const GlobalIndex& parent) {
+    changed_parent_vertices_.insert(parent);
+  }
 
   std::unordered_set<NodeId> getActiveNodes() const;
 
@@ -135,12 +161,33 @@ class GraphExtractor {
 
   void clearDeletedNodes();
 
+  //! Nodes and edges that changed since the last call to clearGraphChanges
+  inline const GraphChanges& getGraphChanges() const { return graph_changes_; }
+
+  void clearGraphChanges();
+
+  inline bool isActive(NodeId node_id) const {
+    return node_id_root_map_.count(node_id);
+  }
+
   inline const SceneGraphLayer& getGraph() const { return *graph_; }
 
+  /**
+   * @brief Get a read-only handle to the current graph that is safe to use from
+   * other threads
+   *
+   * The graph is copied on the next modification while any handle is still alive
+   */
+  inline std::shared_ptr<const SceneGraphLayer> getGraphSnapshot() const {
+    return graph_;
+  }
+
   inline const EdgeInfoMap& getGvdEdgeInfo() const { return edge_info_map_; }
 
   inline const NodeIdRootMap& getNodeRootMap() const { return node_id_root_map_; }
 
+  size_t getMemorySize() const;
+
  protected:
   void clearNodeInfo(NodeId node_id);
 
@@ -152,6 +199,23 @@ class GraphExtractor {
 
   void clearPseudoEdgeInfo(const GlobalIndex& index);
 
+  void clearNodeMeshInfo(NodeId node_id);
+
+  void removeParentLookup(NodeId node_id, const NodeMeshInfo& info);
+
+  void insertGraphEdge(NodeId source, NodeId target, EdgeAttributes::Ptr&& attrs);
+
+  void recordEdgeInsertion(NodeId source, NodeId target);
+
+  void removeGraphEdge(NodeId source, NodeId target);
+
+  void removeGraphNode(NodeId node_id);
+
+  void assignNodeMeshVertices(const GvdLayer& gvd,
+                              NodeId node_id,
+                              const GvdParentMap& parents,
+                              const GvdVertexMap& parent_vertices);
+
   void addNeighborToFrontier(const VoxelGraphInfo& info,
                              const GlobalIndex& neighbor_index);
 
@@ -170,7 +234,12 @@ class GraphExtractor {
                       const VoxelGraphInfo& curr_info,
                       const VoxelGraphInfo& neighbor_info);
 
-  void findBadEdgeIndices(const EdgeInfo& info);
+  void findEdgeSplitCandidates(const EdgeInfo& info);
+
+  FurthestIndexResult checkEdgeSplitCandidate(
+      const EdgeSplitCandidate& candidate) const;
+
+  void findBadEdgeIndices();
 
   void findNewVertices(const GvdLayer& layer);
 
@@ -190,14 +259,19 @@ class GraphExtractor {
 
   bool addPseudoEdge(const GvdLayer& layer, NodeId source, NodeId target);
 
+  //! Retry bridging components whose bridges were blocked in a block that changed
+  void retryBlockedBridges();
+
   void findComponentConnections(const GvdLayer& layer);
 
   void filterIsolatedNodes();
 
+  void detachGraphSnapshot();
+
  protected:
   GraphExtractorConfig config_;
 
-  CornerFinder corner_finder_;
+  CornerClassifier corner_classifier_;
 
   AlignedQueue<GlobalIndex> modified_voxel_queue_;
   AlignedQueue<GlobalIndex> floodfill_frontier_;
@@ -209,13 +283,16 @@ class GraphExtractor {
 
   size_t next_edge_id_;
   EdgeInfoMap edge_info_map_;
-  std::map<NodeId, std::set<size_t>> node_edge_id_map_;
-  std::map<NodeId, std::set<size_t>> node_edge_connections_;
+  NodeIdEdgeMap node_edge_id_map_;
+  NodeIdEdgeMap node_edge_connections_;
 
   EdgeSplitQueue edge_split_queue_;
+  std::vector<EdgeSplitCandidate> edge_split_candidates_;
+  //! Kept alive between split iterations (null if splitting is single-threaded)
+  std::unique_ptr<WorkerPool> edge_split_workers_;
 
   // TODO(nathan) rename these
-  std::map<size_t, std::set<size_t>> checked_edges_;
+  std::unordered_map<size_t, EdgeIdSet> checked_edges_;
   std::set<size_t> connected_edges_;
   std::unordered_set<NodeId> visited_nodes_;
   std::unordered_set<NodeId> deleted_nodes_;
@@ -225,8 +302,19 @@ class GraphExtractor {
   PseudoEdgeMap pseudo_edge_map_;
   std::list<std::unordered_set<NodeId>> pseudo_edge_window_;
   std::list<std::pair<NodeId, NodeId>> removed_pseudo_edges_;
+  ComponentTracker component_tracker_;
+  //! Blocks where bridges from the node were rejected for clearance
+  std::unordered_map<NodeId, voxblox::IndexSet> blocked_bridges_;
+  GraphChanges graph_changes_;
+
+  std::unordered_set<NodeId> mesh_dirty_nodes_;
+  voxblox::IndexSet changed_mesh_blocks_;
+  voxblox::LongIndexSet changed_parent_vertices_;
+  std::unordered_map<NodeId, NodeMeshInfo> node_mesh_info_;
+  voxblox::AnyIndexHashMapType<std::unordered_set<NodeId>>::type block_nodes_;
+  voxblox::LongIndexHashMapType<std::unordered_set<NodeId>>::type parent_nodes_;
 
-  IsolatedSceneGraphLayer::Ptr graph_;
+  std::shared_ptr<IsolatedSceneGraphLayer> graph_;
 
  protected:
   inline GlobalIndex popFromModifiedGvd() {
@@ -258,7 +346,7 @@ class GraphExtractor {
 
     std::bitset<27> gvd_flags =
         extractNeighborhoodFlags(layer, index, config_.min_extra_basis);
-    if (corner_finder_.match(gvd_flags)) {
+    if (corner_classifier_.match(gvd_flags)) {
       return true;
     }
 
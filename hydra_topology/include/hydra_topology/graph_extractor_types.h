@@ -33,13 +33,20 @@
  * purposes notwithstanding any copyright notation herein.
  * -------------------------------------------------------------------------- */
 #pragma once
+#include "hydra_topology/flat_containers.h"
 #include "hydra_topology/voxblox_types.h"
 
 #include <hydra_utils/dsg_types.h>
 
+#include <set>
+#include <unordered_set>
+
 namespace hydra {
 namespace topology {
 
+using EdgeIdSet = SmallIdSet<size_t>;
+using NodeIdSet = SmallIdSet<NodeId>;
+
 struct VoxelGraphInfo {
   // TODO(nathan) consider copy constructor-eqsue cleanup of extract edges
   VoxelGraphInfo();
@@ -58,9 +65,10 @@ struct EdgeInfo {
 
   size_t id;
   NodeId source;
-  voxblox::LongIndexSet indices;
-  std::set<NodeId> node_connections;
-  std::set<size_t> connections;
+  //! flood-filled voxels (each voxel belongs to at most one edge)
+  voxblox::AlignedVector<GlobalIndex> indices;
+  NodeIdSet node_connections;
+  EdgeIdSet connections;
 };
 
 struct EdgeSplitSeed {
@@ -75,10 +83,47 @@ struct EdgeSplitSeed {
 
 bool operator<(const EdgeSplitSeed& lhs, const EdgeSplitSeed& rhs);
 
+//! Pair of connected GVD edges (or a GVD edge and a node) to check for a split
+struct EdgeSplitCandidate {
+  size_t edge_id;
+  bool to_node;
+  size_t other_edge;
+  NodeId other_node;
+};
+
+//! Inputs that the mesh connections of a node were last derived from
+struct NodeMeshInfo {
+  BlockIndex block;
+  voxblox::AlignedVector<GlobalIndex> parents;
+};
+
 struct PseudoEdgeInfo {
   std::vector<NodeId> nodes;
   voxblox::AlignedVector<GlobalIndex> indices;
 };
 
+//! Edge endpoints, with the smaller node id first
+using EdgeEndpoints = std::pair<NodeId, NodeId>;
+
+/**
+ * @brief Changes to the extracted graph since the changes were last cleared
+ *
+ * Deleted nodes are tracked separately by the extractor
+ */
+struct GraphChanges {
+  //! New nodes and nodes with updated attributes
+  std::unordered_set<NodeId> modified_nodes;
+  //! Nodes that left the active window (but are still in the graph)
+  std::unordered_set<NodeId> archived_nodes;
+  std::set<EdgeEndpoints> inserted_edges;
+  std::set<EdgeEndpoints> removed_edges;
+
+  void insertEdge(NodeId source, NodeId target);
+
+  void removeEdge(NodeId source, NodeId target);
+
+  void clear();
+};
+
 }  // namespace topology
 }  // namespace hydra
@@ -39,6 +39,7 @@
 #include "hydra_topology/voxblox_types.h"
 #include "hydra_topology/voxel_aware_mesh_integrator.h"
 
+#include <optional>
 #include <utility>
 
 namespace hydra {
@@ -74,10 +75,51 @@ struct UpdateStatistics {
   size_t number_lower_updated;
   size_t number_fixed_no_parent;
   size_t number_force_lowered;
+  size_t number_mesh_assignments;
 
   void clear();
 };
 
+/**
+ * @brief Changes from GVD integration that graph extraction has not processed yet
+ *
+ * Allows graph extraction to run against a private copy of the GVD layer and the
+ * parent maps while integration continues with the next update
+ */
+struct GvdExtractionFrame {
+  using Ptr = std::unique_ptr<GvdExtractionFrame>;
+  using BlockMap = voxblox::AnyIndexHashMapType<Block<GvdVoxel>::Ptr>::type;
+
+  enum class EventType : uint8_t {
+    PUSH,
+    CLEAR,
+    REMOVE,
+  };
+
+  struct Event {
+    EventType type;
+    GlobalIndex index;
+  };
+
+  //! Graph extractor updates in the order that the integrator made them
+  voxblox::AlignedVector<Event> events;
+  BlockIndexList archived_blocks;
+  //! Copies of every GVD block that changed
+  BlockMap gvd_blocks;
+  //! Current parents of every voronoi voxel whose parents changed
+  GvdParentMap parents;
+  voxblox::LongIndexSet removed_parents;
+  //! Current vertex info of every changed parent that still has one
+  GvdVertexMap parent_vertices;
+  //! Parents whose vertex info was added, changed or removed (removed if missing
+  //! from parent_vertices)
+  voxblox::LongIndexSet changed_vertices;
+
+  BlockIndexList getUpdatedBlocks() const;
+
+  void merge(GvdExtractionFrame&& newer);
+};
+
 /**
  * An ESDF and GVD integrator based on https://arxiv.org/abs/1611.03631
  */
@@ -102,8 +144,33 @@ class GvdIntegrator {
 
   inline GraphExtractor& getGraphExtractor() const { return *graph_extractor_; }
 
+  inline const UpdateStatistics& getUpdateStatistics() const { return update_stats_; }
+
   BlockIndexList removeDistantBlocks(const voxblox::Point& center, double max_distance);
 
+  BlockIndexList archiveBlocks(const BlockIndexList& blocks);
+
+  inline const BlockIndexList& getUpdatedBlocks() const { return updated_blocks_; }
+
+  size_t getParentMemorySize() const;
+
+  /**
+   * @brief Record changes for graph extraction instead of extracting the graph
+   * inside updateFromTsdfLayer (see popExtractionFrame and extractGraph)
+   */
+  void setDeferredExtraction(bool defer_extraction);
+
+  GvdExtractionFrame::Ptr popExtractionFrame();
+
+  void extractGraph(const GvdExtractionFrame& frame);
+
+  //! GVD layer that graph extraction uses (a private copy if extraction is deferred)
+  inline const Layer<GvdVoxel>& getExtractionLayer() const {
+    return defer_extraction_ ? *extraction_layer_ : *gvd_layer_;
+  }
+
+  size_t getExtractionMemorySize() const;
+
  protected:
   void processTsdfBlock(const Block<TsdfVoxel>& block, const BlockIndex& index);
 
@@ -156,6 +223,9 @@ class GvdIntegrator {
 
   void markNewGvdParent(const GlobalIndex& parent);
 
+  void notifyGraphExtractor(GvdExtractionFrame::EventType type,
+                            const GlobalIndex& index);
+
  protected:
   std::unique_ptr<VoxelAwareMeshIntegrator> mesh_integrator_;
 
@@ -178,14 +248,42 @@ class GvdIntegrator {
 
   GraphExtractor::Ptr graph_extractor_;
 
+  BlockIndexList updated_blocks_;
+
+  // book-keeping for incremental and deferred graph extraction
+  bool defer_extraction_;
+  GvdExtractionFrame::Ptr extraction_frame_;
+  IndexSet dirty_blocks_;
+  std::optional<BlockIndex> last_dirty_block_;
+  voxblox::LongIndexSet changed_parents_;
+  voxblox::LongIndexSet changed_vertices_;
+  // only used by extractGraph
+  Layer<GvdVoxel>::Ptr extraction_layer_;
+  GvdParentMap extraction_parents_;
+  GvdVertexMap extraction_parent_vertices_;
+
   BucketQueue<GlobalIndex> lower_;
 
   AlignedQueue<GlobalIndex> raise_;
 
   FloatingPoint voxel_size_;
+  FloatingPoint voxels_per_side_inv_;
 
  protected:
+  inline void markBlockDirty(const GlobalIndex& index) {
+    const BlockIndex block_index =
+        voxblox::getBlockIndexFromGlobalVoxelIndex(index, voxels_per_side_inv_);
+    // consecutive updates are usually from the same block
+    if (last_dirty_block_ && *last_dirty_block_ == block_index) {
+      return;
+    }
+
+    last_dirty_block_ = block_index;
+    dirty_blocks_.insert(block_index);
+  }
+
   inline void pushToQueue(const GlobalIndex& index, GvdVoxel& voxel, PushType action) {
+    markBlockDirty(index);
     switch (action) {
       case PushType::NEW:
         voxel.in_queue = true;
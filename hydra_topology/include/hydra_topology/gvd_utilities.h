@@ -65,6 +65,15 @@ inline void setGvdSurfaceVoxel(GvdVoxel& voxel) {
   resetGvdParent(voxel);
 }
 
+inline Block<GvdVoxel>::Ptr copyGvdBlock(const Block<GvdVoxel>& block) {
+  Block<GvdVoxel>::Ptr copy(
+      new Block<GvdVoxel>(block.voxels_per_side(), block.voxel_size(), block.origin()));
+  for (size_t i = 0; i < block.num_voxels(); ++i) {
+    copy->getVoxelByLinearIndex(i) = block.getVoxelByLinearIndex(i);
+  }
+  return copy;
+}
+
 struct DistancePotential {
   bool is_lower;
   double distance;
@@ -78,5 +78,9 @@ visualization_msgs::Marker makeBlocksMarker(const Layer<TsdfVoxel>& layer,
 
 visualization_msgs::Marker makeBlocksMarker(const Layer<GvdVoxel>& layer, double scale);
 
+visualization_msgs::Marker makeBlocksMarker(const BlockIndexList& blocks,
+                                            double block_size,
+                                            double scale);
+
 }  // namespace topology
 }  // namespace hydra
@@ -0,0 +1,73 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <hydra_utils/dsg_types.h>
+
+#include <memory>
+#include <string>
+#include <unordered_set>
+
+namespace hydra {
+namespace topology {
+
+enum class LayerEncoding { JSON, BINARY };
+
+/**
+ * @brief Encode places and every edge with at least one endpoint in the places
+ *
+ * The binary encoding is versioned. It packs the place attributes that the topology
+ * server sets (position, distance, basis points and voxblox mesh connections), and
+ * stores node ids and edges as varint deltas. Mesh connections are stored as per-block
+ * runs of vertex intervals, and their positions (only used for visualization) as
+ * millimeter deltas. The JSON encoding is serializeLayer.
+ */
+std::string encodeLayer(const SceneGraphLayer& layer,
+                        const std::unordered_set<NodeId>& nodes,
+                        LayerEncoding encoding = LayerEncoding::BINARY);
+
+//! Check whether the contents were produced by the binary encoding
+bool isBinaryLayer(const std::string& contents);
+
+/**
+ * @brief Decode places encoded by encodeLayer (or by serializeLayer) into a layer
+ * @returns The edges to add alongside the layer (see deserializeLayer), or nullptr if
+ * the contents are malformed or use an unsupported version (the layer may then hold
+ * some of the places)
+ */
+std::unique_ptr<SceneGraphLayer::Edges> decodeLayer(const std::string& contents,
+                                                    IsolatedSceneGraphLayer& layer);
+
+}  // namespace topology
+}  // namespace hydra
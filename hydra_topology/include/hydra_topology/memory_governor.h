@@ -0,0 +1,131 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include "hydra_topology/voxblox_types.h"
+
+#include <ostream>
+
+namespace hydra {
+namespace topology {
+
+struct MemoryGovernorConfig {
+  //! Memory budget for the dense representation in MiB (disabled if not positive)
+  double budget_mb = 0.0;
+  //! Fraction of the budget that usage has to drop below before the radius can grow
+  double restore_fraction = 0.8;
+  //! Factor to shrink the dense representation radius by when over budget
+  double shrink_factor = 0.8;
+  //! Factor to grow the dense representation radius by when there is headroom
+  double grow_factor = 1.1;
+  //! Smallest dense representation radius the governor is allowed to use
+  double min_radius_m = 3.0;
+  //! Maximum number of blocks to archive by age per update once at the minimum radius
+  size_t max_archived_blocks = 20;
+};
+
+/**
+ * @brief Approximate memory (in bytes) held by the dense representation and the
+ * bookkeeping required for graph extraction
+ */
+struct MemoryUsage {
+  size_t tsdf_bytes = 0;
+  size_t gvd_bytes = 0;
+  size_t mesh_bytes = 0;
+  size_t parent_bytes = 0;
+  size_t extractor_bytes = 0;
+
+  size_t total() const;
+};
+
+std::ostream& operator<<(std::ostream& out, const MemoryUsage& usage);
+
+template <typename Container>
+size_t getContainerMemorySize(const Container& container) {
+  // node-based containers carry (roughly) two pointers of overhead per entry
+  return container.size() *
+         (sizeof(typename Container::value_type) + 2 * sizeof(void*));
+}
+
+template <typename Map>
+size_t getHashMapMemorySize(const Map& map) {
+  return getContainerMemorySize(map) + map.bucket_count() * sizeof(void*);
+}
+
+/**
+ * @brief Keeps the dense representation within a memory budget
+ *
+ * Shrinks the radius of the dense representation while over budget, archives the
+ * least recently updated blocks if the radius is already as small as allowed, and
+ * grows the radius back to its nominal value once usage drops under the restore
+ * threshold.
+ */
+class MemoryGovernor {
+ public:
+  MemoryGovernor(const MemoryGovernorConfig& config,
+                 double nominal_radius_m,
+                 double block_size);
+
+  inline bool enabled() const { return config_.budget_mb > 0.0; }
+
+  inline double getRadius() const { return radius_m_; }
+
+  void updateBlockTimes(const BlockIndexList& blocks, uint64_t timestamp_ns);
+
+  //! Stop tracking blocks that were archived (needs to happen before selecting more)
+  void removeBlocks(const BlockIndexList& blocks);
+
+  double update(uint64_t timestamp_ns, const MemoryUsage& usage);
+
+  /**
+   * @brief Select the least recently updated blocks to bring usage back under budget
+   *
+   * Candidates are the tracked blocks (i.e., the ones still inside the dense radius
+   * once distant blocks are removed) other than the blocks touching the sensor's block
+   */
+  BlockIndexList getBlocksToArchive(uint64_t timestamp_ns,
+                                    const MemoryUsage& usage,
+                                    const voxblox::Point& center) const;
+
+ private:
+  MemoryGovernorConfig config_;
+  double nominal_radius_m_;
+  double radius_m_;
+  double block_size_;
+
+  voxblox::AnyIndexHashMapType<uint64_t>::type block_update_times_;
+};
+
+}  // namespace topology
+}  // namespace hydra
@@ -0,0 +1,84 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <hydra_utils/dsg_types.h>
+
+#include <voxblox/core/common.h>
+
+#include <vector>
+
+namespace hydra {
+namespace topology {
+
+using MeshConnections = std::vector<NearestVertexInfo>;
+
+//! Half-open range [start, end) of consecutive vertices in a mesh block
+struct VertexInterval {
+  size_t start;
+  size_t end;
+
+  inline size_t size() const { return end - start; }
+};
+
+//! Contiguous connections [begin, end) that share a mesh block
+struct MeshBlockRun {
+  voxblox::BlockIndex block;
+  size_t begin;
+  size_t end;
+
+  inline size_t size() const { return end - begin; }
+};
+
+/**
+ * @brief Sort connections by block and vertex and drop repeated vertices
+ *
+ * Compacted connections form one run per block with sorted vertices, which keeps the
+ * per-block lookups and the interval encoding of the connections cheap. The first
+ * connection to a repeated vertex is kept.
+ */
+void compactMeshConnections(MeshConnections& connections);
+
+//! Add the connections in other to (compacted) connections
+void mergeMeshConnections(const MeshConnections& other, MeshConnections& connections);
+
+//! Split connections into runs of consecutive connections to the same block
+std::vector<MeshBlockRun> getBlockRuns(const MeshConnections& connections);
+
+//! Get the intervals of consecutive vertices in a run, in the order they appear
+std::vector<VertexInterval> getVertexIntervals(const MeshConnections& connections,
+                                               const MeshBlockRun& run);
+
+}  // namespace topology
+}  // namespace hydra
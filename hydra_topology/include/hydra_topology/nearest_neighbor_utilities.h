@@ -43,6 +43,21 @@
 namespace hydra {
 namespace topology {
 
+//! Matches for a batch of nearest node queries
+struct NearestNodeMatches {
+  //! Matches for query i are in [offsets[i], offsets[i + 1]), closest first
+  std::vector<size_t> offsets;
+  std::vector<NodeId> nodes;
+  //! Euclidean distances (unlike the squared distances passed to find callbacks)
+  std::vector<double> distances;
+
+  inline size_t numQueries() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+
+  inline size_t numMatches(size_t query) const {
+    return offsets.at(query + 1) - offsets.at(query);
+  }
+};
+
 // TODO(nathan) this probably belongs in spark_dsg
 class NearestNodeFinder {
  public:
@@ -60,6 +75,21 @@ class NearestNodeFinder {
             bool skip_first,
             const Callback& callback);
 
+  /**
+   * @brief Find the nearest nodes to every query position
+   *
+   * Queries are sorted by spatial locality and split between threads in contiguous
+   * chunks. The layer must not be modified while searching.
+   *
+   * @param num_to_find Maximum number of matches per query
+   * @param max_distance_m Drop matches that are further away (if positive)
+   * @param num_threads Maximum number of threads to search with
+   */
+  NearestNodeMatches findBatch(const std::vector<Eigen::Vector3d>& positions,
+                               size_t num_to_find,
+                               double max_distance_m = 0.0,
+                               size_t num_threads = 1) const;
+
  private:
   struct Detail;
 
@@ -0,0 +1,153 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include "hydra_topology/gvd_voxel.h"
+#include "hydra_topology/voxblox_types.h"
+
+#include <cmath>
+#include <limits>
+
+namespace hydra {
+namespace topology {
+
+/**
+ * @brief Walk the voxels crossed by the segment between two voxel centers
+ *
+ * Uses Amanatides-Woo stepping (every voxel the segment passes through is visited)
+ * and excludes the start and end voxels. The visitor is called as
+ * visitor(const GlobalIndex&) and returns the radius (in voxels) around the current
+ * voxel that is known not to matter to the caller: negative stops the walk, and
+ * anything large enough lets the walk jump ahead along the segment.
+ */
+template <typename Visitor>
+void walkVoxelLine(const GlobalIndex& start, const GlobalIndex& end, Visitor&& visitor) {
+  // segment points within this distance of a visited voxel's center are inside the
+  // voxel or its neighbors (two half voxel diagonals)
+  constexpr double kJumpMargin = 1.7320508075688772;
+  constexpr double kInf = std::numeric_limits<double>::infinity();
+
+  const Eigen::Vector3d dir = (end - start).cast<double>();
+  const double length = dir.norm();
+  if (length == 0.0) {
+    return;
+  }
+
+  GlobalIndex step;
+  Eigen::Vector3d t_delta;
+  for (int i = 0; i < 3; ++i) {
+    step(i) = dir(i) > 0.0 ? 1 : (dir(i) < 0.0 ? -1 : 0);
+    t_delta(i) = step(i) == 0 ? kInf : 1.0 / std::abs(dir(i));
+  }
+
+  // the walk starts at the center of the start voxel, so the first boundary on each
+  // axis is half a voxel away
+  GlobalIndex curr = start;
+  Eigen::Vector3d t_max = 0.5 * t_delta;
+  double t_enter = 0.0;
+
+  auto advance = [&]() {
+    int axis;
+    t_enter = t_max.minCoeff(&axis);
+    curr(axis) += step(axis);
+    t_max(axis) += t_delta(axis);
+  };
+
+  advance();
+  while (curr != end && t_enter < 1.0) {
+    const double free_radius = visitor(static_cast<const GlobalIndex&>(curr));
+    if (free_radius < 0.0) {
+      return;
+    }
+
+    const double jump = free_radius - kJumpMargin;
+    if (jump <= 1.0) {
+      advance();
+      continue;
+    }
+
+    // re-seat the walk at the voxel containing the segment point after the jump
+    t_enter += jump / length;
+    if (t_enter >= 1.0) {
+      return;
+    }
+
+    for (int i = 0; i < 3; ++i) {
+      const double pos = start(i) + t_enter * dir(i);
+      curr(i) = static_cast<GlobalIndex::Scalar>(std::floor(pos + 0.5));
+      t_max(i) = step(i) == 0 ? kInf : (curr(i) + 0.5 * step(i) - start(i)) / dir(i);
+    }
+  }
+}
+
+//! Get every voxel walkVoxelLine visits between start and end
+voxblox::AlignedVector<GlobalIndex> makeVoxelLine(const GlobalIndex& start,
+                                                  const GlobalIndex& end);
+
+/**
+ * @brief Walks a line through a GVD layer, only looking up a block when the line
+ * enters it
+ *
+ * The visitor is called as visitor(const GlobalIndex&, const GvdVoxel*) where the
+ * voxel is null if unallocated, and returns the radius (in meters) around the voxel
+ * that can be skipped (negative to stop). Returning the voxel distance minus whatever
+ * clearance the caller cares about gives sphere tracing.
+ */
+class GvdRayMarcher {
+ public:
+  explicit GvdRayMarcher(const Layer<GvdVoxel>& layer);
+
+  template <typename Visitor>
+  void march(const GlobalIndex& start, const GlobalIndex& end, Visitor&& visitor) {
+    walkVoxelLine(start, end, [&](const GlobalIndex& index) {
+      const double free_radius_m = visitor(index, getVoxel(index));
+      return free_radius_m < 0.0 ? -1.0 : free_radius_m * voxel_size_inv_;
+    });
+  }
+
+  const GvdVoxel* getVoxel(const GlobalIndex& index);
+
+ private:
+  const Layer<GvdVoxel>& layer_;
+  const int voxels_per_side_;
+  const FloatingPoint voxels_per_side_inv_;
+  const double voxel_size_inv_;
+
+  bool has_block_;
+  BlockIndex block_index_;
+  Block<GvdVoxel>::ConstPtr block_;
+};
+
+}  // namespace topology
+}  // namespace hydra
@@ -0,0 +1,202 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include "hydra_topology/graph_extractor_types.h"
+
+#include <hydra_utils/dsg_types.h>
+#include <voxblox_msgs/Mesh.h>
+
+#include <functional>
+#include <memory>
+#include <unordered_set>
+#include <vector>
+
+namespace hydra {
+namespace topology {
+
+/**
+ * @brief Changes to the places layer produced by a single topology update
+ *
+ * Shared between consumers as an immutable object (instead of being serialized).
+ * Full updates contain every active place, while all other updates only contain the
+ * places and edges that changed since the previous update.
+ */
+struct ActivePlacesUpdate {
+  using Ptr = std::shared_ptr<ActivePlacesUpdate>;
+  using ConstPtr = std::shared_ptr<const ActivePlacesUpdate>;
+
+  uint64_t timestamp_ns = 0;
+  //! Incremented for every update (used to detect missing updates)
+  uint64_t sequence_number = 0;
+  //! Number of consecutive updates merged into this one (ending at sequence_number)
+  uint64_t num_merged = 1;
+  bool is_full_update = true;
+  //! Active places (all of them for full updates, otherwise new or modified places)
+  IsolatedSceneGraphLayer layer{DsgLayers::PLACES};
+  //! Edges with at least one place in the layer (only new edges for partial updates)
+  SceneGraphLayer::Edges edges;
+  std::vector<NodeId> deleted_nodes;
+  //! Places that left the active window since the previous (full) update
+  std::vector<NodeId> archived_nodes;
+  //! Edges between remaining places that were removed since the previous update
+  std::vector<EdgeEndpoints> removed_edges;
+
+  /**
+   * @brief Merge the places and edges into the places layer of a scene graph
+   *
+   * The update stays untouched for other consumers, so every sent place is copied
+   * once: places that are already in the graph are assigned in place (reusing their
+   * allocations) and new places are cloned directly into the graph
+   */
+  void mergeInto(DynamicSceneGraph& graph) const;
+};
+
+/**
+ * @brief Make a full update with every active place
+ *
+ * Clones every active place, as the extracted graph keeps changing after the update
+ * is shared (see places_full_update_period to bound how often this happens)
+ */
+ActivePlacesUpdate::Ptr makeActivePlacesUpdate(
+    uint64_t timestamp_ns,
+    const SceneGraphLayer& graph,
+    const std::unordered_set<NodeId>& active_nodes,
+    const std::unordered_set<NodeId>& deleted_nodes);
+
+/**
+ * @brief Make a partial update with the places and edges that changed
+ *
+ * Also fills the archived places and removed edges (see addRemovedElements)
+ */
+ActivePlacesUpdate::Ptr makeActivePlacesDelta(
+    uint64_t timestamp_ns,
+    const SceneGraphLayer& graph,
+    const GraphChanges& changes,
+    const std::unordered_set<NodeId>& deleted_nodes);
+
+//! Copy the archived places and the removed edges that still matter to the update
+void addRemovedElements(const SceneGraphLayer& graph,
+                        const GraphChanges& changes,
+                        ActivePlacesUpdate& update);
+
+//! Active places and edges that are missing from a full update
+struct StalePlaces {
+  std::vector<NodeId> nodes;
+  std::vector<EdgeEndpoints> edges;
+};
+
+/**
+ * @brief Find the active places and edges that a full update no longer contains
+ *
+ * Full updates are authoritative for the active window: previously active places
+ * that are neither sent nor archived, and edges of sent places that aren't part of
+ * the update, were removed by an update that never arrived (e.g., a dropped message)
+ *
+ * @param graph Places layer that the previous updates were applied to
+ * @param active_nodes Active places after the previous update
+ * @param update Full update (or merged update containing a full update)
+ */
+StalePlaces findStalePlaces(const SceneGraphLayer& graph,
+                            const std::unordered_set<NodeId>& active_nodes,
+                            const ActivePlacesUpdate& update);
+
+/**
+ * @brief Merge consecutive updates (oldest first) into a single update
+ *
+ * Applying the merged update has the same effect as applying every update in order:
+ * the newest version of a place or edge wins, deleting a place or removing an edge
+ * cancels earlier insertions, and places that were added and then archived (or left
+ * out of a later full update) are sent alongside the archived places so that their
+ * latest attributes still reach the graph.
+ */
+ActivePlacesUpdate::Ptr mergeActivePlacesUpdates(
+    const std::vector<ActivePlacesUpdate::ConstPtr>& updates);
+
+//! Approximate memory used by an update
+size_t estimateMemoryUsage(const ActivePlacesUpdate& update);
+
+/**
+ * @brief Active mesh produced by a single topology update
+ */
+struct ActiveMeshUpdate {
+  using Ptr = std::shared_ptr<ActiveMeshUpdate>;
+  using ConstPtr = std::shared_ptr<const ActiveMeshUpdate>;
+
+  //! Block of a mesh message (shares the message instead of copying the block)
+  struct BlockRef {
+    voxblox_msgs::Mesh::ConstPtr source;
+    size_t index;
+
+    inline const voxblox_msgs::MeshBlock& get() const {
+      return source->mesh_blocks.at(index);
+    }
+  };
+
+  uint64_t timestamp_ns = 0;
+  //! Updated blocks (merged updates only set the header, see merged_blocks)
+  voxblox_msgs::Mesh::ConstPtr mesh;
+  //! Blocks that have left the active window (only the indices are set)
+  voxblox_msgs::Mesh::ConstPtr archived_blocks;
+  //! Newest version of every updated block of a merged update
+  std::vector<BlockRef> merged_blocks;
+
+  /**
+   * @brief Get a message with every updated block
+   *
+   * Returns mesh for updates that weren't merged. Otherwise the blocks are copied
+   * once into a new message (merging only passes references around).
+   */
+  voxblox_msgs::Mesh::ConstPtr getMesh() const;
+};
+
+/**
+ * @brief Merge consecutive mesh updates (oldest first) into a single update
+ *
+ * Only the newest version of every block is kept (including empty blocks, which
+ * delete the block). Blocks that were archived stay archived unless a later update
+ * sends them again, and their last version is still sent so it reaches the mesh.
+ * Blocks are referenced in the original messages instead of being copied.
+ */
+ActiveMeshUpdate::Ptr mergeActiveMeshUpdates(
+    const std::vector<ActiveMeshUpdate::ConstPtr>& updates);
+
+//! Approximate memory used by an update (including the messages it keeps alive)
+size_t estimateMemoryUsage(const ActiveMeshUpdate& update);
+
+using PlacesUpdateCallback = std::function<void(const ActivePlacesUpdate::ConstPtr&)>;
+using MeshUpdateCallback = std::function<void(const ActiveMeshUpdate::ConstPtr&)>;
+
+}  // namespace topology
+}  // namespace hydra
@@ -34,11 +34,15 @@
  * -------------------------------------------------------------------------- */
 #pragma once
 #include "hydra_topology/configs.h"
+#include "hydra_topology/layer_encoding.h"
+#include "hydra_topology/mesh_connections.h"
+#include "hydra_topology/topology_outputs.h"
 #include "hydra_topology/topology_server_visualizer.h"
 
 #include <hydra_msgs/ActiveLayer.h>
 #include <hydra_msgs/ActiveMesh.h>
 #include <hydra_utils/display_utils.h>
+#include <hydra_utils/metric_utilities.h>
 #include <std_msgs/Time.h>
 #include <voxblox_ros/conversions.h>
 #include <voxblox_ros/mesh_vis.h>
@@ -47,6 +51,13 @@
 #include <glog/logging.h>
 #include <ros/ros.h>
 
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 namespace hydra {
 namespace topology {
 
@@ -75,23 +86,76 @@ class TopologyServer {
       time_pub.publish(msg);
     }
 
+    virtual void integratePointcloud(const voxblox::Transformation& T_G_C,
+                                     const voxblox::Pointcloud& ptcloud_C,
+                                     const voxblox::Colors& colors,
+                                     const bool is_freespace_pointcloud) override {
+      BaseTsdfServerType::integratePointcloud(
+          T_G_C, ptcloud_C, colors, is_freespace_pointcloud);
+
+      // approximates the ESDF-updated blocks by the blocks containing a measurement
+      // (cleared free space is picked up by the next update that sees a surface)
+      const auto& layer = BaseTsdfServerType::getTsdfMapPtr()->getTsdfLayer();
+      BlockIndex prev_index;
+      bool has_prev = false;
+      for (const auto& point_C : ptcloud_C) {
+        const BlockIndex index =
+            layer.computeBlockIndexFromCoordinates(T_G_C * point_C);
+        // consecutive points usually fall into the same block
+        if (has_prev && index == prev_index) {
+          continue;
+        }
+
+        updated_blocks.insert(index);
+        prev_index = index;
+        has_prev = true;
+      }
+    }
+
     bool has_pose;
     voxblox::Transformation T_G_C_last;
     ros::Publisher time_pub;
+    //! Blocks touched by integration since the last topology update
+    voxblox::IndexSet updated_blocks;
 
    protected:
     using BaseTsdfServerType::nh_;
   };
 
-  explicit TopologyServer(const ros::NodeHandle& nh) : nh_(nh) {
-    setupConfig("~");
+  /**
+   * @brief Construct the topology server
+   *
+   * Parameters are read from the namespace of nh and every ROS callback (including
+   * the TSDF server's subscriptions) runs on the callback queue of nh
+   */
+  explicit TopologyServer(const ros::NodeHandle& nh)
+      : nh_(nh),
+        should_shutdown_(false),
+        extraction_bytes_(0),
+        extraction_cost_ns_(0) {
+    setupConfig(nh_.getNamespace());
     setupLayers();
 
-    visualizer_.reset(new TopologyServerVisualizer("~"));
+    // GVD updates can propagate up to the max distance past the updated TSDF blocks,
+    // but extraction frames track exactly which GVD blocks changed
+    const size_t dirty_block_padding =
+        config_.pipeline_graph_extraction
+            ? 0
+            : std::ceil(gvd_config_.max_distance_m / tsdf_layer_->block_size());
+    visualizer_.reset(
+        new TopologyServerVisualizer(nh_.getNamespace(), dirty_block_padding));
+    visualizer_->start();
+
+    if (config_.pipeline_graph_extraction) {
+      gvd_integrator_->setDeferredExtraction(true);
+      extraction_thread_.reset(new std::thread(&TopologyServer::spinExtraction, this));
+    }
 
     // we need two publishers for the mesh: voxblox offers no way to distinguish between
     // deleted blocks and blocks that were cleared by observation
-    if (config_.publish_archived) {
+    if (!config_.publish_active_topics) {
+      // outputs only go to in-process consumers
+    } else if (config_.publish_archived) {
       mesh_pub_ = nh_.advertise<hydra_msgs::ActiveMesh>("active_mesh", 1, true);
     } else {
       mesh_pub_ = nh_.advertise<voxblox_msgs::Mesh>("active_mesh", 1, true);
@@ -99,21 +163,57 @@ class TopologyServer {
 
     mesh_viz_pub_ = nh_.advertise<voxblox_msgs::Mesh>("mesh_viz", 1, true);
 
-    layer_pub_ = nh_.advertise<hydra_msgs::ActiveLayer>("active_layer", 2, false);
+    if (config_.publish_active_topics) {
+      layer_pub_ = nh_.advertise<hydra_msgs::ActiveLayer>("active_layer", 2, false);
+    }
 
+    // the scheduler polls at its shortest allowed period and decides when to update
+    update_scheduler_.reset(new UpdateScheduler(config_.update_scheduler));
+    const double timer_period_s = update_scheduler_->enabled()
+                                      ? update_scheduler_->getPollPeriod()
+                                      : config_.update_period_s;
     update_timer_ = nh_.createTimer(
-        ros::Duration(config_.update_period_s),
-        [&](const ros::TimerEvent& event) { runUpdate(event.current_real); });
+        ros::Duration(timer_period_s),
+        [&](const ros::TimerEvent& event) { handleUpdateTimer(event.current_real); });
+  }
+
+  ~TopologyServer() {
+    // no more frames can be pushed once the timer is stopped
+    update_timer_.stop();
+
+    {  // start frame critical section
+      // set under the mutex so the extraction thread can't miss the notification
+      std::unique_lock<std::mutex> lock(frame_mutex_);
+      should_shutdown_ = true;
+    }  // end frame critical section
+
+    frame_cv_.notify_all();
+    if (extraction_thread_) {
+      extraction_thread_->join();
+      extraction_thread_.reset();
+    }
   }
 
   void spin() const { ros::spin(); }
 
+  //! Register an in-process consumer of places updates (call before spinning)
+  void addPlacesCallback(const PlacesUpdateCallback& callback) {
+    places_callbacks_.push_back(callback);
+  }
+
+  //! Register an in-process consumer of mesh updates (call before spinning)
+  void addMeshCallback(const MeshUpdateCallback& callback) {
+    mesh_callbacks_.push_back(callback);
+  }
+
  private:
   void setupLayers() {
     // this intentionally disables marching cubes in the native voxblox server
     nh_.setParam("update_mesh_every_n_sec", 0.0);
     // TODO(nathan) explicit configs
-    tsdf_server_.reset(new TsdfServerType(ros::NodeHandle(), nh_));
+    ros::NodeHandle tsdf_nh;
+    tsdf_nh.setCallbackQueue(nh_.getCallbackQueue());
+    tsdf_server_.reset(new TsdfServerType(tsdf_nh, nh_));
 
     tsdf_layer_ = tsdf_server_->getTsdfMapPtr()->getTsdfLayerPtr();
     CHECK_NOTNULL(tsdf_layer_);
@@ -124,6 +224,10 @@ class TopologyServer {
 
     gvd_integrator_.reset(
         new GvdIntegrator(gvd_config_, tsdf_layer_, gvd_layer_, mesh_layer_));
+
+    memory_governor_.reset(new MemoryGovernor(config_.memory_governor,
+                                              config_.dense_representation_radius_m,
+                                              tsdf_layer_->block_size()));
   }
 
   void setupConfig(const std::string& config_ns) {
@@ -134,90 +238,266 @@ class TopologyServer {
   }
 
   void publishMesh(const ros::Time& timestamp, const BlockIndexList& archived_blocks) {
-    voxblox_msgs::Mesh mesh_msg;
-    generateVoxbloxMeshMsg(mesh_layer_, config_.mesh_color_mode, &mesh_msg);
-    mesh_msg.header.frame_id = config_.world_frame;
-    mesh_msg.header.stamp = timestamp;
-    mesh_viz_pub_.publish(mesh_msg);
-
-    auto iter = mesh_msg.mesh_blocks.begin();
-    while (iter != mesh_msg.mesh_blocks.end()) {
+    voxblox_msgs::Mesh::Ptr mesh_msg(new voxblox_msgs::Mesh());
+    generateVoxbloxMeshMsg(mesh_layer_, config_.mesh_color_mode, mesh_msg.get());
+    mesh_msg->header.frame_id = config_.world_frame;
+    mesh_msg->header.stamp = timestamp;
+    mesh_viz_pub_.publish(*mesh_msg);
+
+    auto iter = mesh_msg->mesh_blocks.begin();
+    while (iter != mesh_msg->mesh_blocks.end()) {
       // we can't just check if the message is empty (it's valid for an observed and
       // active block to be empty), so we have to check if the GVD layer has pruned the
       // corresponding block yet)
       BlockIndex idx(iter->index[0], iter->index[1], iter->index[2]);
       if (!gvd_layer_->hasBlock(idx)) {
-        iter = mesh_msg.mesh_blocks.erase(iter);
+        iter = mesh_msg->mesh_blocks.erase(iter);
         continue;
       }
 
       ++iter;
     }
 
-    if (!config_.publish_archived) {
-      mesh_pub_.publish(mesh_msg);
+    if (config_.publish_active_topics && !config_.publish_archived) {
+      mesh_pub_.publish(*mesh_msg);
+    }
+
+    if (!config_.publish_archived && mesh_callbacks_.empty()) {
       return;
     }
 
-    voxblox_msgs::Mesh archived_msg;
+    voxblox_msgs::Mesh::Ptr archived_msg(new voxblox_msgs::Mesh());
     for (const auto& block_idx : archived_blocks) {
       voxblox_msgs::MeshBlock block;
       block.index[0] = block_idx.x();
       block.index[1] = block_idx.y();
       block.index[2] = block_idx.z();
-      archived_msg.mesh_blocks.push_back(block);
+      archived_msg->mesh_blocks.push_back(block);
+    }
+
+    if (!mesh_callbacks_.empty()) {
+      // in-process consumers share the messages instead of copying them
+      auto update = std::make_shared<ActiveMeshUpdate>();
+      update->timestamp_ns = timestamp.toNSec();
+      update->mesh = mesh_msg;
+      update->archived_blocks = archived_msg;
+      for (const auto& callback : mesh_callbacks_) {
+        callback(update);
+      }
+    }
+
+    if (!config_.publish_active_topics || !config_.publish_archived) {
+      return;
     }
 
     hydra_msgs::ActiveMesh msg;
     msg.header.stamp = timestamp;
-    msg.mesh = mesh_msg;
-    msg.archived_blocks = archived_msg;
+    msg.mesh = *mesh_msg;
+    msg.archived_blocks = *archived_msg;
     mesh_pub_.publish(msg);
   }
 
-  void publishActiveLayer(const ros::Time& timestamp) const {
+  ActivePlacesUpdate::Ptr makePlacesUpdate(const ros::Time& timestamp) {
+    // non-const, as clearing the changes modifies internal state
+    GraphExtractor& extractor = gvd_integrator_->getGraphExtractor();
+    const SceneGraphLayer& graph = extractor.getGraph();
+    const GraphChanges& changes = extractor.getGraphChanges();
+
+    const size_t period = config_.places_full_update_period;
+    const bool full_update = period <= 1 || places_sequence_number_ % period == 0;
+
+    ActivePlacesUpdate::Ptr update;
+    if (full_update) {
+      update = makeActivePlacesUpdate(timestamp.toNSec(),
+                                      graph,
+                                      extractor.getActiveNodes(),
+                                      extractor.getDeletedNodes());
+      addRemovedElements(graph, changes, *update);
+      // places missing from a full update are deleted by consumers unless archived
+      update->archived_nodes.insert(update->archived_nodes.end(),
+                                    archived_since_full_update_.begin(),
+                                    archived_since_full_update_.end());
+      archived_since_full_update_.clear();
+    } else {
+      update = makeActivePlacesDelta(
+          timestamp.toNSec(), graph, changes, extractor.getDeletedNodes());
+      archived_since_full_update_.insert(archived_since_full_update_.end(),
+                                         update->archived_nodes.begin(),
+                                         update->archived_nodes.end());
+    }
+
+    update->sequence_number = places_sequence_number_;
+    ++places_sequence_number_;
+
+    extractor.clearDeletedNodes();
+    extractor.clearGraphChanges();
+    return update;
+  }
+
+  void publishLayerMsg(const ros::Time& timestamp, const ActivePlacesUpdate& update) {
+    const GraphExtractor& extractor = gvd_integrator_->getGraphExtractor();
+
+    // new edges to unchanged places are serialized through their endpoints
+    std::unordered_set<NodeId> nodes;
+    for (const auto& id_node_pair : update.layer.nodes()) {
+      nodes.insert(id_node_pair.first);
+    }
+
+    for (const auto& id_edge_pair : update.edges) {
+      const auto& edge = id_edge_pair.second;
+      if (extractor.isActive(edge.source)) {
+        nodes.insert(edge.source);
+      }
+      if (extractor.isActive(edge.target)) {
+        nodes.insert(edge.target);
+      }
+    }
+
     hydra_msgs::ActiveLayer msg;
     msg.header.stamp = timestamp;
     msg.header.frame_id = config_.world_frame;
+    msg.sequence_number = update.sequence_number;
+    msg.is_full_update = update.is_full_update;
+    msg.layer_contents = encodeLayer(extractor.getGraph(),
+                                     nodes,
+                                     config_.binary_layer_encoding
+                                         ? LayerEncoding::BINARY
+                                         : LayerEncoding::JSON);
+    msg.deleted_nodes.insert(msg.deleted_nodes.begin(),
+                             update.deleted_nodes.begin(),
+                             update.deleted_nodes.end());
+    msg.archived_nodes.insert(msg.archived_nodes.begin(),
+                              update.archived_nodes.begin(),
+                              update.archived_nodes.end());
+    for (const auto& endpoints : update.removed_edges) {
+      msg.removed_edge_sources.push_back(endpoints.first);
+      msg.removed_edge_targets.push_back(endpoints.second);
+    }
 
-    // non-const, as clearDeletedNodes modifies internal state
-    GraphExtractor& extractor = gvd_integrator_->getGraphExtractor();
-    std::unordered_set<NodeId> active_nodes = extractor.getActiveNodes();
-    std::unordered_set<NodeId> removed_nodes = extractor.getDeletedNodes();
-    extractor.clearDeletedNodes();
-    msg.layer_contents = extractor.getGraph().serializeLayer(active_nodes);
-    msg.deleted_nodes.insert(
-        msg.deleted_nodes.begin(), removed_nodes.begin(), removed_nodes.end());
     layer_pub_.publish(msg);
+  }
+
+  void publishActiveLayer(const ros::Time& timestamp) {
+    if (places_callbacks_.empty() && !config_.publish_active_topics) {
+      // keep the deleted nodes and changes from growing without bound
+      GraphExtractor& extractor = gvd_integrator_->getGraphExtractor();
+      extractor.clearDeletedNodes();
+      extractor.clearGraphChanges();
+      return;
+    }
+
+    const ActivePlacesUpdate::ConstPtr update = makePlacesUpdate(timestamp);
+    for (const auto& callback : places_callbacks_) {
+      callback(update);
+    }
+
+    if (config_.publish_active_topics) {
+      publishLayerMsg(timestamp, *update);
+    }
 
-    for (const auto& id : active_nodes) {
-      auto& attr =
-          extractor.getGraph().getNode(id)->get().attributes<PlaceNodeAttributes>();
-      for (const auto& connection : attr.voxblox_mesh_connections) {
-        BlockIndex idx = Eigen::Map<const BlockIndex>(connection.block);
+    if (config_.pipeline_graph_extraction) {
+      // the mesh is concurrently being updated for the next frame
+      return;
+    }
+
+    // only the places in the update can have new mesh connections
+    for (const auto& id_node_pair : update->layer.nodes()) {
+      const NodeId id = id_node_pair.first;
+      const auto& attrs = id_node_pair.second->attributes<PlaceNodeAttributes>();
+      const auto& connections = attrs.voxblox_mesh_connections;
+      for (const auto& run : getBlockRuns(connections)) {
+        const BlockIndex& idx = run.block;
         // mesh api is stupid and logs warnings...
         if (!gvd_layer_->hasBlock(idx)) {
           continue;
         }
-        CHECK(connection.vertex < mesh_layer_->getMeshByIndex(idx).size())
-            << "invalid vertex @ " << idx.transpose() << " -> " << connection.vertex
-            << " >= " << mesh_layer_->getMeshByIndex(idx).size() << " for "
-            << NodeSymbol(id).getLabel();
+
+        const size_t mesh_size = mesh_layer_->getMeshByIndex(idx).size();
+        for (size_t i = run.begin; i < run.end; ++i) {
+          CHECK(connections[i].vertex < mesh_size)
+              << "invalid vertex @ " << idx.transpose() << " -> "
+              << connections[i].vertex << " >= " << mesh_size << " for "
+              << NodeSymbol(id).getLabel();
+        }
       }
     }
   }
 
-  void showStats(const ros::Time& timestamp) const {
+  MemoryUsage getMemoryUsage() const {
+    MemoryUsage usage;
+    usage.tsdf_bytes = tsdf_layer_->getMemorySize();
+    usage.gvd_bytes = gvd_layer_->getMemorySize();
+    usage.mesh_bytes = mesh_layer_->getMemorySize();
+    usage.parent_bytes = gvd_integrator_->getParentMemorySize();
+    // pipelined extraction reports its memory after each frame
+    usage.extractor_bytes = config_.pipeline_graph_extraction
+                                ? extraction_bytes_.load()
+                                : gvd_integrator_->getExtractionMemorySize();
+    return usage;
+  }
+
+  void showStats(const ros::Time& timestamp, const MemoryUsage& usage) const {
     LOG(INFO) << "Timings: (stamp: " << timestamp.toNSec() << ")" << std::endl
               << voxblox::timing::Timing::Print();
-    const std::string tsdf_memory_str =
-        hydra_utils::getHumanReadableMemoryString(tsdf_layer_->getMemorySize());
-    const std::string gvd_memory_str =
-        hydra_utils::getHumanReadableMemoryString(gvd_layer_->getMemorySize());
-    const std::string mesh_memory_str =
-        hydra_utils::getHumanReadableMemoryString(mesh_layer_->getMemorySize());
-    LOG(INFO) << "Memory used: [TSDF=" << tsdf_memory_str << ", GVD=" << gvd_memory_str
-              << ", Mesh= " << mesh_memory_str << "]";
+    LOG(INFO) << "Memory used: " << usage
+              << " (dense radius: " << memory_governor_->getRadius() << " [m])";
+  }
+
+  BlockIndexList archiveBlocks(const ros::Time& timestamp, const MemoryUsage& usage) {
+    const voxblox::Point position = tsdf_server_->T_G_C_last.getPosition();
+    const double radius_m = memory_governor_->update(timestamp.toNSec(), usage);
+
+    BlockIndexList archived_blocks =
+        gvd_integrator_->removeDistantBlocks(position, radius_m);
+
+    // this needs to be paired with publishMesh (i.e. generateVoxbloxMeshMsg)
+    // to actual remove allocated blocks (instead of getting rid of the contents).
+    // handled through publishMesh
+    mesh_layer_->clearDistantMesh(position, radius_m);
+    memory_governor_->removeBlocks(archived_blocks);
+
+    // only archive by age if shrinking the radius wasn't enough
+    const MemoryUsage remaining_usage =
+        archived_blocks.empty() ? usage : getMemoryUsage();
+    const BlockIndexList oldest_blocks = memory_governor_->getBlocksToArchive(
+        timestamp.toNSec(), remaining_usage, position);
+    const BlockIndexList aged_blocks = gvd_integrator_->archiveBlocks(oldest_blocks);
+    for (const auto& idx : aged_blocks) {
+      mesh_layer_->removeMesh(idx);
+      archived_blocks.push_back(idx);
+    }
+
+    memory_governor_->removeBlocks(aged_blocks);
+    if (memory_governor_->enabled()) {
+      // otherwise archiving only follows the fixed radius
+      metrics::MetricRecorder::instance().record(
+          "topology/memory/num_archived", timestamp.toNSec(), archived_blocks.size());
+    }
+    return archived_blocks;
+  }
+
+  void handleUpdateTimer(const ros::Time& timestamp) {
+    if (!tsdf_layer_) {
+      return;
+    }
+
+    // tracked during integration so that polling doesn't walk every allocated block
+    auto& changed_blocks = tsdf_server_->updated_blocks;
+    if (update_scheduler_->enabled() &&
+        !update_scheduler_->shouldUpdate(timestamp.toNSec(), changed_blocks.size())) {
+      return;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    runUpdate(timestamp);
+    const auto end = std::chrono::steady_clock::now();
+    // the update consumes every ESDF-updated block
+    changed_blocks.clear();
+
+    // pipelined extraction runs concurrently, but still counts against the budget
+    const double cost_s = std::chrono::duration<double>(end - start).count() +
+                          extraction_cost_ns_.load() * 1.0e-9;
+    update_scheduler_->recordCost(timestamp.toNSec(), cost_s);
   }
 
   void runUpdate(const ros::Time& timestamp) {
@@ -226,30 +506,96 @@ class TopologyServer {
     }
 
     gvd_integrator_->updateFromTsdfLayer(true);
+    memory_governor_->updateBlockTimes(gvd_integrator_->getUpdatedBlocks(),
+                                       timestamp.toNSec());
+
+    if (config_.pipeline_graph_extraction) {
+      // hand off before archiving: archived blocks belong to the next frame
+      pushExtractionFrame(timestamp);
+    }
+
+    MemoryUsage usage;
+    if (memory_governor_->enabled() || config_.show_stats) {
+      usage = getMemoryUsage();
+    }
 
     BlockIndexList archived_blocks;
     if (config_.clear_distant_blocks && tsdf_server_->has_pose) {
-      archived_blocks =
-          gvd_integrator_->removeDistantBlocks(tsdf_server_->T_G_C_last.getPosition(),
-                                               config_.dense_representation_radius_m);
-
-      // this needs to be paired with publishMesh (i.e. generateVoxbloxMeshMsg)
-      // to actual remove allocated blocks (instead of getting rid of the contents).
-      // handled through publishMesh
-      mesh_layer_->clearDistantMesh(tsdf_server_->T_G_C_last.getPosition(),
-                                    config_.dense_representation_radius_m);
+      archived_blocks = archiveBlocks(timestamp, usage);
     }
 
     publishMesh(timestamp, archived_blocks);
-    publishActiveLayer(timestamp);
 
-    visualizer_->visualize(gvd_integrator_->getGraphExtractor(),
-                           gvd_integrator_->getGraph(),
-                           *gvd_layer_,
-                           *tsdf_layer_);
+    if (!config_.pipeline_graph_extraction) {
+      publishActiveLayer(timestamp);
+      visualizer_->update(timestamp.toNSec(),
+                          gvd_integrator_->getGraphExtractor(),
+                          *gvd_layer_,
+                          tsdf_layer_,
+                          gvd_integrator_->getUpdatedBlocks(),
+                          archived_blocks);
+    }
 
     if (config_.show_stats) {
-      showStats(timestamp);
+      showStats(timestamp, usage);
+    }
+  }
+
+  void pushExtractionFrame(const ros::Time& timestamp) {
+    auto frame = gvd_integrator_->popExtractionFrame();
+
+    bool merged = false;
+    {  // start frame critical section
+      std::unique_lock<std::mutex> lock(frame_mutex_);
+      if (pending_frame_) {
+        // extraction is behind: fold the changes into the waiting frame
+        pending_frame_->merge(std::move(*frame));
+        merged = true;
+      } else {
+        pending_frame_ = std::move(frame);
+      }
+      pending_stamp_ = timestamp;
+    }  // end frame critical section
+
+    if (merged) {
+      metrics::MetricRecorder::instance().increment("topology/pipeline/merged_frames",
+                                                    timestamp.toNSec());
+    }
+
+    frame_cv_.notify_one();
+  }
+
+  void spinExtraction() {
+    while (!should_shutdown_) {
+      GvdExtractionFrame::Ptr frame;
+      ros::Time timestamp;
+      {  // start frame critical section
+        std::unique_lock<std::mutex> lock(frame_mutex_);
+        frame_cv_.wait(lock, [&] { return should_shutdown_ || pending_frame_; });
+        frame = std::move(pending_frame_);
+        timestamp = pending_stamp_;
+      }  // end frame critical section
+
+      if (!frame) {
+        continue;
+      }
+
+      const auto start = std::chrono::steady_clock::now();
+      gvd_integrator_->extractGraph(*frame);
+      extraction_bytes_ = gvd_integrator_->getExtractionMemorySize();
+      publishActiveLayer(timestamp);
+
+      // the tsdf layer belongs to the update thread, so outlines come from the GVD
+      visualizer_->update(timestamp.toNSec(),
+                          gvd_integrator_->getGraphExtractor(),
+                          gvd_integrator_->getExtractionLayer(),
+                          nullptr,
+                          frame->getUpdatedBlocks(),
+                          frame->archived_blocks);
+
+      const auto end = std::chrono::steady_clock::now();
+      extraction_cost_ns_ =
+          std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
     }
   }
 
@@ -271,8 +617,27 @@ class TopologyServer {
 
   std::unique_ptr<TsdfServerType> tsdf_server_;
   std::unique_ptr<GvdIntegrator> gvd_integrator_;
+  std::unique_ptr<MemoryGovernor> memory_governor_;
+  std::unique_ptr<UpdateScheduler> update_scheduler_;
+
+  std::vector<PlacesUpdateCallback> places_callbacks_;
+  std::vector<MeshUpdateCallback> mesh_callbacks_;
 
   ros::Timer update_timer_;
+
+  // graph extraction for frame N runs on this thread while frame N+1 is integrated
+  std::atomic<bool> should_shutdown_;
+  std::atomic<size_t> extraction_bytes_;
+  std::atomic<uint64_t> extraction_cost_ns_;
+  std::unique_ptr<std::thread> extraction_thread_;
+  std::mutex frame_mutex_;
+  std::condition_variable frame_cv_;
+  GvdExtractionFrame::Ptr pending_frame_;
+  ros::Time pending_stamp_;
+
+  uint64_t places_sequence_number_ = 0;
+  //! Resent with the next full update in case the delta archiving them was dropped
+  std::vector<NodeId> archived_since_full_update_;
 };
 
 }  // namespace topology
@@ -43,6 +43,11 @@
 #include <dynamic_reconfigure/server.h>
 #include <hydra_topology/GvdVisualizerConfig.h>
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 namespace hydra {
 namespace topology {
 
@@ -55,6 +60,7 @@ struct TopologyVisualizerConfig {
   bool show_block_outlines = false;
   bool use_gvd_block_outlines = false;
   double outline_scale = 0.01;
+  double visualization_period_s = 1.0;
 
   ColormapConfig colormap;
   GvdVisualizerConfig gvd;
@@ -69,30 +75,104 @@ void visit_config(const Visitor& v, TopologyVisualizerConfig& config) {
   v.visit("show_block_outlines", config.show_block_outlines);
   v.visit("use_gvd_block_outlines", config.use_gvd_block_outlines);
   v.visit("outline_scale", config.outline_scale);
+  v.visit("visualization_period_s", config.visualization_period_s);
 }
 
+/**
+ * @brief Changes to the topology server state since the last snapshot that the
+ * visualizer needs to draw an update without touching the live layers or graph
+ */
+struct TopologyVisualizerSnapshot {
+  using Ptr = std::unique_ptr<TopologyVisualizerSnapshot>;
+  using GvdBlockMap = voxblox::AnyIndexHashMapType<Block<GvdVoxel>::Ptr>::type;
+
+  FloatingPoint voxel_size;
+  size_t voxels_per_side;
+  //! Whether gvd_blocks contains every block (instead of just the changed blocks)
+  bool full_update = false;
+  //! Copies of the GVD blocks that have changed since the last snapshot
+  GvdBlockMap gvd_blocks;
+  BlockIndexList archived_blocks;
+  //! Block outlines to draw (empty if not requested)
+  BlockIndexList outline_blocks;
+  //! Whether to draw the outlines of the GVD blocks instead of outline_blocks
+  bool use_gvd_outlines = false;
+  //! Read-only handle to the graph (null if not requested)
+  std::shared_ptr<const SceneGraphLayer> graph;
+  //! Graph extraction book-keeping (null if not requested)
+  std::unique_ptr<GraphExtractor::EdgeInfoMap> edge_info;
+  std::unique_ptr<GraphExtractor::NodeIdRootMap> root_map;
+
+  void merge(TopologyVisualizerSnapshot&& newer);
+};
+
+/**
+ * @brief Visualizes the topology server state from a dedicated low-priority thread
+ *
+ * The update thread only records which blocks changed and periodically hands off a
+ * snapshot; marker generation happens on the visualization thread against a mirror
+ * of the GVD layer.
+ */
 class TopologyServerVisualizer {
  public:
-  explicit TopologyServerVisualizer(const std::string& ns);
+  /**
+   * @param ns Namespace for publishers and configs
+   * @param dirty_block_padding Number of blocks around each updated TSDF block that
+   *        the GVD update could have modified
+   */
+  TopologyServerVisualizer(const std::string& ns, size_t dirty_block_padding = 1);
+
+  virtual ~TopologyServerVisualizer();
+
+  void start();
+
+  void stop();
+
+  /**
+   * @brief Record changes and periodically hand off a snapshot for drawing
+   *
+   * tsdf may be null if it is not safe to read from the calling thread, in which
+   * case the GVD layer is used for block outlines
+   */
+  void update(uint64_t timestamp_ns,
+              const GraphExtractor& extractor,
+              const Layer<GvdVoxel>& gvd,
+              const Layer<TsdfVoxel>* tsdf,
+              const BlockIndexList& updated_blocks,
+              const BlockIndexList& archived_blocks);
+
+ private:
+  void markDirtyBlocks(const Layer<GvdVoxel>& gvd,
+                       const BlockIndexList& updated_blocks,
+                       const BlockIndexList& archived_blocks);
 
-  virtual ~TopologyServerVisualizer() = default;
+  TopologyVisualizerSnapshot::Ptr makeSnapshot(const TopologyVisualizerConfig& config,
+                                               const GraphExtractor& extractor,
+                                               const Layer<GvdVoxel>& gvd,
+                                               const Layer<TsdfVoxel>* tsdf);
 
-  void visualize(const GraphExtractor& extractor,
-                 const SceneGraphLayer& graph,
-                 const Layer<GvdVoxel>& gvd,
-                 const Layer<TsdfVoxel>& tsdf);
+  void spin();
 
- private:
-  void visualizeGraph(const SceneGraphLayer& graph);
+  void visualize(TopologyVisualizerSnapshot& snapshot);
+
+  void visualizeGraph(const TopologyVisualizerConfig& config,
+                      const SceneGraphLayer& graph);
 
-  void visualizeGvd(const Layer<GvdVoxel>& gvd) const;
+  void visualizeGvd(const TopologyVisualizerConfig& config,
+                    const Layer<GvdVoxel>& gvd) const;
 
-  void visualizeGvdEdges(const GraphExtractor& extractor,
+  void visualizeGvdEdges(const TopologyVisualizerConfig& config,
+                         const TopologyVisualizerSnapshot& snapshot,
                          const Layer<GvdVoxel>& gvd) const;
 
-  void visualizeBlocks(const Layer<GvdVoxel>& gvd, const Layer<TsdfVoxel>& tsdf) const;
+  void visualizeBlocks(const TopologyVisualizerConfig& config,
+                       const TopologyVisualizerSnapshot& snapshot,
+                       const Layer<GvdVoxel>& gvd) const;
 
-  void publishGraphLabels(const SceneGraphLayer& graph);
+  void publishGraphLabels(const TopologyVisualizerConfig& config,
+                          const SceneGraphLayer& graph);
+
+  TopologyVisualizerConfig getConfig() const;
 
   void gvdConfigCb(GvdVisualizerConfig& config, uint32_t level);
 
@@ -119,9 +199,27 @@ class TopologyServerVisualizer {
   ros::Publisher gvd_edge_viz_pub_;
   ros::Publisher block_viz_pub_;
 
+  mutable std::mutex config_mutex_;
   TopologyVisualizerConfig config_;
   std::set<int> previous_labels_;
 
+  // only touched by the update thread
+  size_t dirty_block_padding_;
+  IndexSet dirty_blocks_;
+  BlockIndexList archived_blocks_;
+  bool needs_full_update_;
+  uint64_t last_snapshot_ns_;
+  bool have_snapshot_;
+
+  // only touched by the visualization thread
+  Layer<GvdVoxel>::Ptr gvd_;
+
+  std::atomic<bool> should_shutdown_;
+  std::unique_ptr<std::thread> spin_thread_;
+  std::mutex snapshot_mutex_;
+  std::condition_variable snapshot_cv_;
+  TopologyVisualizerSnapshot::Ptr pending_snapshot_;
+
   std::unique_ptr<dynamic_reconfigure::Server<GvdVisualizerConfig>> gvd_config_server_;
   std::unique_ptr<dynamic_reconfigure::Server<LayerConfig>> graph_config_server_;
   std::unique_ptr<dynamic_reconfigure::Server<ColormapConfig>> colormap_server_;
@@ -0,0 +1,94 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace hydra {
+namespace topology {
+
+struct UpdateSchedulerConfig {
+  //! Adapt the time between updates to the scene (otherwise use update_period_s)
+  bool enable = false;
+  //! Shortest allowed time between updates (bounds the update latency)
+  double min_period_s = 0.2;
+  //! Longest allowed time between updates (even if nothing changed)
+  double max_period_s = 2.0;
+  //! Fraction of wall time that updates are allowed to take
+  double target_cpu_fraction = 0.5;
+  //! Number of changed TSDF blocks required to update before max_period_s
+  size_t min_changed_blocks = 1;
+  //! Number of changed TSDF blocks that justifies updating as soon as possible
+  size_t urgent_changed_blocks = 50;
+  //! Weight of the newest measurement in the update cost estimate
+  double cost_alpha = 0.3;
+};
+
+/**
+ * @brief Decides when to run topology updates
+ *
+ * The time between updates shrinks from max_period_s towards the shortest period
+ * allowed by the cost budget as the number of changed TSDF blocks grows
+ */
+class UpdateScheduler {
+ public:
+  explicit UpdateScheduler(const UpdateSchedulerConfig& config);
+
+  inline bool enabled() const { return config_.enable; }
+
+  //! Time between calls to shouldUpdate that the caller should use
+  inline double getPollPeriod() const { return config_.min_period_s; }
+
+  inline double getCostEstimate() const { return cost_s_; }
+
+  //! Shortest period that keeps updates within the target CPU fraction
+  double getMinPeriod() const;
+
+  double getTargetPeriod(size_t num_changed_blocks) const;
+
+  bool shouldUpdate(uint64_t timestamp_ns, size_t num_changed_blocks);
+
+  void recordCost(uint64_t timestamp_ns, double cost_s);
+
+ private:
+  UpdateSchedulerConfig config_;
+  bool has_update_;
+  uint64_t last_update_ns_;
+  bool has_cost_;
+  double cost_s_;
+};
+
+}  // namespace topology
+}  // namespace hydra
@@ -0,0 +1,188 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_topology/component_tracker.h"
+#include "hydra_topology/memory_governor.h"
+
+namespace hydra {
+namespace topology {
+
+void ComponentTracker::addNode(NodeId node) {
+  if (parents_.count(node)) {
+    return;
+  }
+
+  parents_[node] = node;
+  members_[node] = {node};
+  changed_.insert(node);
+}
+
+void ComponentTracker::addEdge(NodeId source, NodeId target) {
+  addNode(source);
+  addNode(target);
+  merge(source, target);
+}
+
+void ComponentTracker::removeNode(NodeId node) {
+  if (parents_.count(node)) {
+    to_rebuild_.insert(node);
+  }
+}
+
+void ComponentTracker::removeEdge(NodeId source, NodeId target) {
+  if (parents_.count(source)) {
+    to_rebuild_.insert(source);
+  } else if (parents_.count(target)) {
+    to_rebuild_.insert(target);
+  }
+}
+
+void ComponentTracker::update(const SceneGraphLayer& graph) {
+  if (to_rebuild_.empty()) {
+    return;
+  }
+
+  // nodes can be merged after being marked, so resolve the components now
+  std::unordered_set<NodeId> roots;
+  for (const auto node : to_rebuild_) {
+    roots.insert(find(node));
+  }
+  to_rebuild_.clear();
+
+  std::vector<NodeId> to_connect;
+  for (const auto root : roots) {
+    auto iter = members_.find(root);
+    const std::vector<NodeId> members = std::move(iter->second);
+    members_.erase(iter);
+    changed_.erase(root);
+
+    for (const auto node : members) {
+      if (!graph.hasNode(node)) {
+        parents_.erase(node);
+        continue;
+      }
+
+      parents_[node] = node;
+      members_[node] = {node};
+      changed_.insert(node);
+      to_connect.push_back(node);
+    }
+  }
+
+  // edges never leave a component, so reconnecting the members is enough
+  for (const auto node : to_connect) {
+    for (const auto sibling : graph.getNode(node).value().get().siblings()) {
+      if (parents_.count(sibling)) {
+        merge(node, sibling);
+      }
+    }
+  }
+}
+
+NodeId ComponentTracker::getComponent(NodeId node) { return find(node); }
+
+size_t ComponentTracker::getComponentSize(NodeId node) {
+  return members_.at(find(node)).size();
+}
+
+bool ComponentTracker::hasChanged(NodeId node) {
+  if (!parents_.count(node)) {
+    return false;
+  }
+
+  return changed_.count(find(node));
+}
+
+void ComponentTracker::markChanged(NodeId node) {
+  if (!parents_.count(node)) {
+    return;
+  }
+
+  changed_.insert(find(node));
+}
+
+size_t ComponentTracker::getMemorySize() const {
+  size_t num_bytes = getHashMapMemorySize(parents_) + getHashMapMemorySize(members_);
+  for (const auto& root_members_pair : members_) {
+    num_bytes += root_members_pair.second.capacity() * sizeof(NodeId);
+  }
+
+  num_bytes += getHashMapMemorySize(to_rebuild_) + getHashMapMemorySize(changed_);
+  return num_bytes;
+}
+
+NodeId ComponentTracker::find(NodeId node) {
+  NodeId root = node;
+  while (true) {
+    const NodeId parent = parents_.at(root);
+    if (parent == root) {
+      break;
+    }
+    root = parent;
+  }
+
+  // path compression
+  while (node != root) {
+    NodeId& parent = parents_.at(node);
+    node = parent;
+    parent = root;
+  }
+
+  return root;
+}
+
+void ComponentTracker::merge(NodeId lhs, NodeId rhs) {
+  NodeId lhs_root = find(lhs);
+  NodeId rhs_root = find(rhs);
+  if (lhs_root == rhs_root) {
+    return;
+  }
+
+  if (members_.at(lhs_root).size() < members_.at(rhs_root).size()) {
+    std::swap(lhs_root, rhs_root);
+  }
+
+  // merge the smaller member list into the larger one
+  auto& root_members = members_.at(lhs_root);
+  auto& other_members = members_.at(rhs_root);
+  root_members.insert(root_members.end(), other_members.begin(), other_members.end());
+  members_.erase(rhs_root);
+  parents_[rhs_root] = lhs_root;
+
+  changed_.erase(rhs_root);
+  changed_.insert(lhs_root);
+}
+
+}  // namespace topology
+}  // namespace hydra
@@ -73,6 +73,38 @@ inline bool isValidPoint(const GvdVoxel* voxel, uint8_t min_extra_basis) {
 std::bitset<27> extractNeighborhoodFlags(const Layer<GvdVoxel>& layer,
                                          const GlobalIndex& index,
                                          uint8_t min_extra_basis) {
+  const int vps = static_cast<int>(layer.voxels_per_side());
+  const VoxelIndex local = voxblox::getLocalFromGlobalVoxelIndex(index, vps);
+  if (local.minCoeff() < 1 || local.maxCoeff() > vps - 2) {
+    // neighborhood spans multiple blocks
+    return extractNeighborhoodFlagsByIndex(layer, index, min_extra_basis);
+  }
+
+  const auto block = layer.getBlockPtrByIndex(
+      voxblox::getBlockIndexFromGlobalVoxelIndex(index, 1.0f / vps));
+  if (!block) {
+    return std::bitset<27>(0);
+  }
+
+  // the whole neighborhood is inside the block: read voxels by linear offset
+  const IndexOffsets26Connected& offsets = Neighborhood26Connected::kOffsets;
+  const int64_t center = block->computeLinearIndexFromVoxelIndex(local);
+
+  uint32_t flags = 0;
+  for (int n = 0; n < offsets.cols(); ++n) {
+    const int64_t offset = offsets(0, n) + vps * (offsets(1, n) + vps * offsets(2, n));
+    const GvdVoxel& voxel = block->getVoxelByLinearIndex(center + offset);
+    flags |= static_cast<uint32_t>(voxel.num_extra_basis >= min_extra_basis) << n;
+  }
+
+  const GvdVoxel& voxel = block->getVoxelByLinearIndex(center);
+  flags |= static_cast<uint32_t>(voxel.num_extra_basis >= min_extra_basis) << 26;
+  return std::bitset<27>(flags);
+}
+
+std::bitset<27> extractNeighborhoodFlagsByIndex(const Layer<GvdVoxel>& layer,
+                                                const GlobalIndex& index,
+                                                uint8_t min_extra_basis) {
   // TODO(nathan) this is a lot of memory to keep pushing onto the stack
   Neighborhood<>::IndexMatrix neighbor_indices;
   Neighborhood<>::getFromGlobalIndex(index, &neighbor_indices);
@@ -167,6 +199,44 @@ CornerFinder::CornerFinder() {
                           0b000'000'000'000'001'011'000'001'011}};
 }
 
+CornerClassifier::CornerClassifier() : CornerClassifier(CornerFinder()) {}
+
+CornerClassifier::CornerClassifier(const CornerFinder& finder) {
+  const std::array<const GvdCornerTemplate*, 6> templates{
+      &finder.negative_x_template,
+      &finder.positive_x_template,
+      &finder.negative_y_template,
+      &finder.positive_y_template,
+      &finder.negative_z_template,
+      &finder.positive_z_template};
+
+  for (auto& table : tables_) {
+    table.fill(0);
+  }
+
+  // every template rotation requires that the state agrees with the foreground mask
+  // on all bits not in the unused mask. This decomposes over the three 9-bit slices
+  // of the neighborhood, so each slice table records which rules the slice satisfies
+  size_t rule = 0;
+  for (const auto corner_template : templates) {
+    const uint32_t fg = corner_template->fg_mask.to_ulong();
+    for (const auto& unused_mask : corner_template->unused_mask_array) {
+      const uint32_t care = ~static_cast<uint32_t>(unused_mask.to_ulong());
+      for (size_t slice = 0; slice < tables_.size(); ++slice) {
+        const size_t shift = 9 * slice;
+        const uint32_t slice_care = (care >> shift) & 0x1FF;
+        const uint32_t slice_fg = (fg >> shift) & 0x1FF;
+        for (uint32_t value = 0; value < 512; ++value) {
+          if ((value & slice_care) == (slice_fg & slice_care)) {
+            tables_[slice][value] |= (1u << rule);
+          }
+        }
+      }
+      ++rule;
+    }
+  }
+}
+
 // implementation loosely based on: https://gist.github.com/yamamushi/5823518
 voxblox::AlignedVector<GlobalIndex> makeBresenhamLine(const GlobalIndex& start,
                                                       const GlobalIndex& end) {
@@ -33,7 +33,12 @@
  * purposes notwithstanding any copyright notation herein.
  * -------------------------------------------------------------------------- */
 #include "hydra_topology/graph_extractor.h"
-#include "hydra_topology/nearest_neighbor_utilities.h"
+#include "hydra_topology/memory_governor.h"
+#include "hydra_topology/mesh_connections.h"
+#include "hydra_topology/ray_marching.h"
+
+#include <algorithm>
+#include <list>
 
 namespace hydra {
 namespace topology {
@@ -66,7 +71,11 @@ GraphExtractor::GraphExtractor(const GraphExtractorConfig& config)
       next_node_id_('p', 0),
       next_edge_id_(0),
       next_pseudo_edge_id_(0),
-      graph_(new IsolatedSceneGraphLayer(DsgLayers::PLACES)) {}
+      graph_(new IsolatedSceneGraphLayer(DsgLayers::PLACES)) {
+  if (config_.edge_splitting_threads > 1) {
+    edge_split_workers_.reset(new WorkerPool(config_.edge_splitting_threads));
+  }
+}
 
 std::unordered_set<NodeId> GraphExtractor::getActiveNodes() const {
   std::unordered_set<NodeId> nodes;
@@ -82,12 +91,102 @@ std::unordered_set<NodeId> GraphExtractor::getDeletedNodes() const {
 
 void GraphExtractor::clearDeletedNodes() { deleted_nodes_.clear(); }
 
+void GraphExtractor::clearGraphChanges() { graph_changes_.clear(); }
+
+size_t GraphExtractor::getMemorySize() const {
+  // the graph itself is not included, as it is owned by the scene graph layer
+  size_t num_bytes = getHashMapMemorySize(index_graph_info_map_);
+  num_bytes += node_id_index_map_.getMemorySize();
+  for (const auto& indices : node_id_index_map_.values()) {
+    num_bytes += getHashMapMemorySize(indices);
+  }
+
+  num_bytes += getHashMapMemorySize(node_id_root_map_);
+  num_bytes += getHashMapMemorySize(edge_info_map_);
+  for (const auto& id_info_pair : edge_info_map_) {
+    num_bytes += id_info_pair.second.indices.capacity() * sizeof(GlobalIndex);
+    num_bytes += id_info_pair.second.node_connections.getMemorySize();
+    num_bytes += id_info_pair.second.connections.getMemorySize();
+  }
+
+  num_bytes += node_edge_id_map_.getMemorySize();
+  for (const auto& edges : node_edge_id_map_.values()) {
+    num_bytes += edges.getMemorySize();
+  }
+
+  num_bytes += node_edge_connections_.getMemorySize();
+  for (const auto& edges : node_edge_connections_.values()) {
+    num_bytes += edges.getMemorySize();
+  }
+
+  num_bytes += getContainerMemorySize(pseudo_edge_info_);
+  for (const auto& id_info_pair : pseudo_edge_info_) {
+    num_bytes += id_info_pair.second.nodes.capacity() * sizeof(NodeId);
+    num_bytes += id_info_pair.second.indices.capacity() * sizeof(GlobalIndex);
+  }
+
+  num_bytes += getHashMapMemorySize(pseudo_edge_map_);
+  for (const auto& index_edges_pair : pseudo_edge_map_) {
+    num_bytes += index_edges_pair.second.getMemorySize();
+  }
+
+  num_bytes += getHashMapMemorySize(node_mesh_info_);
+  for (const auto& id_info_pair : node_mesh_info_) {
+    num_bytes += id_info_pair.second.parents.capacity() * sizeof(GlobalIndex);
+  }
+
+  num_bytes += getHashMapMemorySize(block_nodes_);
+  for (const auto& block_nodes_pair : block_nodes_) {
+    num_bytes += getHashMapMemorySize(block_nodes_pair.second);
+  }
+
+  num_bytes += getHashMapMemorySize(parent_nodes_);
+  for (const auto& parent_nodes_pair : parent_nodes_) {
+    num_bytes += getHashMapMemorySize(parent_nodes_pair.second);
+  }
+
+  num_bytes += component_tracker_.getMemorySize();
+  num_bytes += getHashMapMemorySize(blocked_bridges_);
+  for (const auto& node_blocks_pair : blocked_bridges_) {
+    num_bytes += getHashMapMemorySize(node_blocks_pair.second);
+  }
+  num_bytes += getHashMapMemorySize(graph_changes_.modified_nodes);
+  num_bytes += getHashMapMemorySize(graph_changes_.archived_nodes);
+  num_bytes += getContainerMemorySize(graph_changes_.inserted_edges);
+  num_bytes += getContainerMemorySize(graph_changes_.removed_edges);
+
+  return num_bytes;
+}
+
+void GraphExtractor::detachGraphSnapshot() {
+  if (graph_.use_count() == 1) {
+    return;
+  }
+
+  // someone is still reading the previous graph: mutate a copy instead (cloning
+  // the attributes directly to keep the copy cheap)
+  auto graph_copy = std::make_shared<IsolatedSceneGraphLayer>(DsgLayers::PLACES);
+  for (const auto& id_node_pair : graph_->nodes()) {
+    graph_copy->emplaceNode(id_node_pair.first,
+                            id_node_pair.second->attributes().clone());
+  }
+
+  for (const auto& id_edge_pair : graph_->edges()) {
+    const auto& edge = id_edge_pair.second;
+    graph_copy->insertEdge(edge.source, edge.target, edge.info->clone());
+  }
+
+  graph_ = graph_copy;
+}
+
 void GraphExtractor::clearGvdIndex(const GlobalIndex& index) {
   const auto& info_iter = index_graph_info_map_.find(index);
   if (info_iter == index_graph_info_map_.end()) {
     return;
   }
 
+  detachGraphSnapshot();
+
   if (info_iter->second.is_node) {
     clearNodeInfo(info_iter->second.id);
   } else {
@@ -103,7 +202,7 @@ void GraphExtractor::clearNodeInfo(NodeId node_id) {
       visited_nodes_.insert(sibling);  // unclear why this is required
     }
   }
-  graph_->removeNode(node_id);
+  removeGraphNode(node_id);
   deleted_nodes_.insert(node_id);
   modified_voxel_queue_.push(node_id_root_map_.at(node_id));
 
@@ -127,6 +226,8 @@ void GraphExtractor::clearNodeInfo(NodeId node_id) {
     edge_info_map_.at(edge_id).node_connections.erase(node_id);
   }
   node_edge_connections_.erase(node_id);
+
+  clearNodeMeshInfo(node_id);
 }
 
 void GraphExtractor::clearEdgeInfo(size_t edge_id, bool clear_indices) {
@@ -147,13 +248,13 @@ void GraphExtractor::clearEdgeInfo(size_t edge_id, bool clear_indices) {
 
     for (size_t other_edge_id : info.connections) {
       visited_nodes_.insert(edge_info_map_.at(other_edge_id).source);
-      graph_->removeEdge(info.source, edge_info_map_.at(other_edge_id).source);
+      removeGraphEdge(info.source, edge_info_map_.at(other_edge_id).source);
       edge_info_map_.at(other_edge_id).connections.erase(edge_id);
     }
 
     for (NodeId node_id : info.node_connections) {
       visited_nodes_.insert(node_id);
-      graph_->removeEdge(info.source, node_id);
+      removeGraphEdge(info.source, node_id);
       node_edge_connections_.at(node_id).erase(edge_id);
     }
 
@@ -179,12 +280,12 @@ void GraphExtractor::clearPseudoEdgeInfo(const GlobalIndex& root_index) {
     return;
   }
 
-  std::unordered_set<size_t> edges_to_erase = info_iter->second;
+  const EdgeIdSet edges_to_erase = info_iter->second;
   for (const auto edge_id : edges_to_erase) {
     const PseudoEdgeInfo& edge_info = pseudo_edge_info_.at(edge_id);
 
     for (const auto node : edge_info.nodes) {
-      graph_->removeNode(node);
+      removeGraphNode(node);
     }
 
     for (const auto index : edge_info.indices) {
@@ -205,6 +306,8 @@ void GraphExtractor::removeDistantIndex(const GlobalIndex& index) {
     return;
   }
 
+  detachGraphSnapshot();
+
   if (info_iter->second.is_node) {
     removeNodeIndex(info_iter->second.id);
   } else {
@@ -215,6 +318,10 @@ void GraphExtractor::removeDistantIndex(const GlobalIndex& index) {
 }
 
 void GraphExtractor::removeNodeIndex(NodeId node_id) {
+  // the node stays in the graph, but is no longer updated
+  graph_changes_.modified_nodes.erase(node_id);
+  graph_changes_.archived_nodes.insert(node_id);
+
   index_graph_info_map_.erase(node_id_root_map_.at(node_id));
   node_id_root_map_.erase(node_id);
 
@@ -232,6 +339,8 @@ void GraphExtractor::removeNodeIndex(NodeId node_id) {
     edge_info_map_.at(edge_id).node_connections.erase(node_id);
   }
   node_edge_connections_.erase(node_id);
+
+  clearNodeMeshInfo(node_id);
 }
 
 void GraphExtractor::removeEdgeIndices(size_t edge_id, bool clear_indices) {
@@ -277,7 +386,7 @@ void GraphExtractor::addNeighborToFrontier(const VoxelGraphInfo& info,
     next_edge_id_++;
   }
 
-  edge_info_map_[neighbor_info.edge_id].indices.insert(neighbor_index);
+  edge_info_map_[neighbor_info.edge_id].indices.push_back(neighbor_index);
 
   index_graph_info_map_[neighbor_index] = neighbor_info;
   node_id_index_map_[info.id].insert(neighbor_index);
@@ -303,10 +412,13 @@ void GraphExtractor::addPlaceToGraph(const GvdLayer& layer,
   index_graph_info_map_.emplace(index, VoxelGraphInfo(next_node_id_, is_from_split));
   node_id_index_map_[next_node_id_] = voxblox::LongIndexSet();
   node_id_root_map_[next_node_id_] = index;
-  node_edge_id_map_[next_node_id_] = std::set<size_t>();
-  node_edge_connections_[next_node_id_] = std::set<size_t>();
+  node_edge_id_map_[next_node_id_] = EdgeIdSet();
+  node_edge_connections_[next_node_id_] = EdgeIdSet();
+  mesh_dirty_nodes_.insert(next_node_id_);
 
   graph_->emplaceNode(next_node_id_, std::move(attributes));
+  component_tracker_.addNode(next_node_id_);
+  graph_changes_.modified_nodes.insert(next_node_id_);
   next_node_id_++;
 }
 
@@ -329,6 +441,36 @@ bool GraphExtractor::updateEdgeMaps(const VoxelGraphInfo& info,
       .second;
 }
 
+void GraphExtractor::insertGraphEdge(NodeId source,
+                                     NodeId target,
+                                     EdgeAttributes::Ptr&& attrs) {
+  if (graph_->insertEdge(source, target, std::move(attrs))) {
+    recordEdgeInsertion(source, target);
+  }
+}
+
+void GraphExtractor::recordEdgeInsertion(NodeId source, NodeId target) {
+  component_tracker_.addEdge(source, target);
+  graph_changes_.insertEdge(source, target);
+}
+
+void GraphExtractor::removeGraphEdge(NodeId source, NodeId target) {
+  if (!graph_->removeEdge(source, target)) {
+    return;
+  }
+
+  component_tracker_.removeEdge(source, target);
+  graph_changes_.removeEdge(source, target);
+}
+
+void GraphExtractor::removeGraphNode(NodeId node_id) {
+  // edges are implicitly removed with the node
+  graph_->removeNode(node_id);
+  component_tracker_.removeNode(node_id);
+  blocked_bridges_.erase(node_id);
+  graph_changes_.modified_nodes.erase(node_id);
+}
+
 EdgeAttributes::Ptr GraphExtractor::makeEdgeInfo(const GvdLayer& layer,
                                                  NodeId source_id,
                                                  NodeId target_id) const {
@@ -341,23 +483,22 @@ EdgeAttributes::Ptr GraphExtractor::makeEdgeInfo(const GvdLayer& layer,
 
   const GlobalIndex source = node_id_root_map_.at(source_id);
   const GlobalIndex target = node_id_root_map_.at(target_id);
-  GlobalIndexVector path = makeBresenhamLine(source, target);
-  if (path.empty()) {
+  if ((target - source).cwiseAbs().maxCoeff() <= 1) {
     // edge is smaller than voxel size, so we just take the min distance between two
     // voxels
     return std::make_unique<EdgeAttributes>(min_weight);
   }
 
-  for (const auto& index : path) {
-    const GvdVoxel* voxel = layer.getVoxelPtrByGlobalIndex(index);
+  GvdRayMarcher marcher(layer);
+  marcher.march(source, target, [&](const GlobalIndex&, const GvdVoxel* voxel) {
     if (!voxel) {
-      continue;
+      return 0.0;
     }
 
-    if (voxel->distance < min_weight) {
-      min_weight = voxel->distance;
-    }
-  }
+    min_weight = std::min(min_weight, static_cast<double>(voxel->distance));
+    // nothing closer than the current minimum can be inside the free sphere
+    return config_.sphere_trace_edges ? voxel->distance - min_weight : 0.0;
+  });
 
   return std::make_unique<EdgeAttributes>(min_weight);
 }
@@ -368,9 +509,9 @@ void GraphExtractor::addEdgeToGraph(const GvdLayer& layer,
   if (curr_info.is_node && neighbor_info.is_node) {
     // this case can happen (potentially frequently) if the basis count is noisy
     // ideally adjacent vertices get clustered downstream and pruned
-    graph_->insertEdge(curr_info.id,
-                       neighbor_info.id,
-                       makeEdgeInfo(layer, curr_info.id, neighbor_info.id));
+    insertGraphEdge(curr_info.id,
+                    neighbor_info.id,
+                    makeEdgeInfo(layer, curr_info.id, neighbor_info.id));
     return;
   }
 
@@ -381,9 +522,9 @@ void GraphExtractor::addEdgeToGraph(const GvdLayer& layer,
   // TODO(nathan) check if we really need symmetric lookup
   updateEdgeMaps(neighbor_info, curr_info);
 
-  graph_->insertEdge(curr_info.id,
-                     neighbor_info.id,
-                     makeEdgeInfo(layer, curr_info.id, neighbor_info.id));
+  insertGraphEdge(curr_info.id,
+                  neighbor_info.id,
+                  makeEdgeInfo(layer, curr_info.id, neighbor_info.id));
 
   if (!curr_info.is_node) {
     connected_edges_.insert(curr_info.edge_id);
@@ -394,10 +535,7 @@ void GraphExtractor::addEdgeToGraph(const GvdLayer& layer,
   }
 }
 
-void GraphExtractor::findBadEdgeIndices(const EdgeInfo& info) {
-  const GlobalIndex start = node_id_root_map_.at(info.source);
-  voxblox::AlignedVector<GlobalIndex> indices(info.indices.begin(), info.indices.end());
-
+void GraphExtractor::findEdgeSplitCandidates(const EdgeInfo& info) {
   checked_edges_[info.id] = info.connections;
   for (auto other_edge : info.connections) {
     if (checked_edges_.count(other_edge) &&
@@ -405,31 +543,65 @@ void GraphExtractor::findBadEdgeIndices(const EdgeInfo& info) {
       continue;  // we've seen this before from the other direction
     }
 
-    const NodeId other_node = edge_info_map_.at(other_edge).source;
-    const GlobalIndex end = node_id_root_map_.at(other_node);
+    edge_split_candidates_.push_back({info.id, false, other_edge, NodeId()});
+  }
 
-    voxblox::AlignedVector<GlobalIndex> curr_indices(indices);
-    curr_indices.insert(curr_indices.end(),
-                        edge_info_map_.at(other_edge).indices.begin(),
-                        edge_info_map_.at(other_edge).indices.end());
+  for (auto other_node : info.node_connections) {
+    edge_split_candidates_.push_back({info.id, true, 0, other_node});
+  }
+}
 
-    FurthestIndexResult result =
-        findFurthestIndexFromLine(curr_indices, start, end, indices.size());
+FurthestIndexResult GraphExtractor::checkEdgeSplitCandidate(
+    const EdgeSplitCandidate& candidate) const {
+  const EdgeInfo& info = edge_info_map_.at(candidate.edge_id);
+  const GlobalIndex start = node_id_root_map_.at(info.source);
+  if (candidate.to_node) {
+    const GlobalIndex end = node_id_root_map_.at(candidate.other_node);
+    return findFurthestIndexFromLine(info.indices, start, end);
+  }
 
-    if (result.distance > config_.max_edge_deviation && result.valid) {
-      edge_split_queue_.emplace(
-          result.index, result.distance, result.from_source ? info.id : other_edge);
+  const EdgeInfo& other_info = edge_info_map_.at(candidate.other_edge);
+  const GlobalIndex end = node_id_root_map_.at(other_info.source);
+
+  GlobalIndexVector curr_indices(info.indices);
+  curr_indices.insert(
+      curr_indices.end(), other_info.indices.begin(), other_info.indices.end());
+
+  return findFurthestIndexFromLine(curr_indices, start, end, info.indices.size());
+}
+
+void GraphExtractor::findBadEdgeIndices() {
+  // candidates only read the extractor state, so they can be checked in parallel.
+  // Results are queued in candidate order to keep the splits deterministic
+  const size_t num_candidates = edge_split_candidates_.size();
+  voxblox::AlignedVector<FurthestIndexResult> results(num_candidates);
+
+  const auto check_candidate = [&](size_t i) {
+    results[i] = checkEdgeSplitCandidate(edge_split_candidates_[i]);
+  };
+
+  if (edge_split_workers_) {
+    edge_split_workers_->run(num_candidates, check_candidate);
+  } else {
+    for (size_t i = 0; i < num_candidates; ++i) {
+      check_candidate(i);
     }
   }
 
-  for (auto other_node : info.node_connections) {
-    const GlobalIndex end = node_id_root_map_.at(other_node);
-    FurthestIndexResult result = findFurthestIndexFromLine(indices, start, end);
-
-    if (result.distance > config_.max_edge_deviation && result.valid) {
-      edge_split_queue_.emplace(result.index, result.distance, info.id);
+  for (size_t i = 0; i < num_candidates; ++i) {
+    const FurthestIndexResult& result = results[i];
+    if (result.distance <= config_.max_edge_deviation || !result.valid) {
+      continue;
     }
+
+    const EdgeSplitCandidate& candidate = edge_split_candidates_[i];
+    const size_t edge_id = (candidate.to_node || result.from_source)
+                               ? candidate.edge_id
+                               : candidate.other_edge;
+    edge_split_queue_.emplace(result.index, result.distance, edge_id);
   }
+
+  edge_split_candidates_.clear();
 }
 
 void GraphExtractor::findNewVertices(const GvdLayer& layer) {
@@ -585,9 +757,11 @@ void GraphExtractor::splitEdges(const GvdLayer& layer) {
         LOG(WARNING) << "[Graph Extractor] edge " << edge_id << "does not exists";
         continue;
       }
-      findBadEdgeIndices(edge_info_map_.at(edge_id));
+      findEdgeSplitCandidates(edge_info_map_.at(edge_id));
     }
 
+    findBadEdgeIndices();
+
     clearNewConnections(false);  // clear new edges that we processed
 
     if (edge_split_queue_.empty()) {
@@ -662,8 +836,15 @@ void GraphExtractor::findFreespaceEdges() {
         num_to_find,
         true,
         [&](NodeId neighbor, size_t, double) {
+          if (graph_->hasEdge(node, neighbor)) {
+            return;
+          }
+
           addFreespaceEdge(
               *graph_, node, neighbor, config_.freespace_edge_min_clearance_m);
+          if (graph_->hasEdge(node, neighbor)) {
+            recordEdgeInsertion(node, neighbor);
+          }
         });
   }
 }
@@ -712,8 +893,7 @@ bool GraphExtractor::addPseudoEdge(const GvdLayer& layer,
   }
 
   // TODO(nathan) projective edge finding
-  GlobalIndexVector path = makeBresenhamLine(source, target);
-  if (path.empty()) {
+  if ((target - source).cwiseAbs().maxCoeff() <= 1) {
     return false;
   }
 
@@ -724,37 +904,41 @@ bool GraphExtractor::addPseudoEdge(const GvdLayer& layer,
   double min_weight = std::min(source_dist, target_dist);
 
   bool valid_path = true;
-  for (const auto& index : path) {
-    const GvdVoxel* voxel = layer.getVoxelPtrByGlobalIndex(index);
-    if (!voxel) {
-      return false;  // avoid adding edges along removed voxels
+  GlobalIndex blocked_index;
+  GvdRayMarcher marcher(layer);
+  marcher.march(source, target, [&](const GlobalIndex& index, const GvdVoxel* voxel) {
+    // avoid adding edges along removed voxels
+    if (!voxel || voxel->distance <= config_.component_min_clearance_m ||
+        !voxel->observed) {
+      valid_path = false;
+      blocked_index = index;
+      return -1.0;
     }
 
-    if (voxel->distance < min_weight) {
-      min_weight = voxel->distance;
+    min_weight = std::min(min_weight, static_cast<double>(voxel->distance));
+    if (!config_.sphere_trace_edges) {
+      return 0.0;
     }
 
-    if (voxel->distance <= config_.component_min_clearance_m || !voxel->observed) {
-      valid_path = false;
-      break;
-    }
-  }
+    // skipped voxels can't be below the clearance or change the minimum
+    return voxel->distance - std::max(min_weight, config_.component_min_clearance_m);
+  });
 
   if (!valid_path) {
+    // the path may clear once the gvd around the blocking voxel changes
+    blocked_bridges_[node].insert(voxblox::getBlockIndexFromGlobalVoxelIndex(
+        blocked_index, 1.0f / layer.voxels_per_side()));
     return false;
   }
 
-  graph_->insertEdge(node, other_node, std::make_unique<EdgeAttributes>(min_weight));
+  insertGraphEdge(node, other_node, std::make_unique<EdgeAttributes>(min_weight));
 
   // no split nodes yet
   PseudoEdgeInfo info;
-  info.indices = path;
+  info.indices = makeVoxelLine(source, target);
   pseudo_edge_info_[next_pseudo_edge_id_] = info;
 
-  for (const auto& index : path) {
-    if (!pseudo_edge_map_.count(index)) {
-      pseudo_edge_map_[index] = std::unordered_set<size_t>();
-    }
+  for (const auto& index : info.indices) {
     pseudo_edge_map_[index].insert(next_pseudo_edge_id_);
   }
 
@@ -763,17 +947,42 @@ bool GraphExtractor::addPseudoEdge(const GvdLayer& layer,
   return true;
 }
 
+void GraphExtractor::retryBlockedBridges() {
+  auto iter = blocked_bridges_.begin();
+  while (iter != blocked_bridges_.end()) {
+    const auto& blocks = iter->second;
+    const bool changed =
+        std::any_of(blocks.begin(), blocks.end(), [&](const BlockIndex& idx) {
+          return changed_mesh_blocks_.count(idx);
+        });
+
+    if (!changed) {
+      ++iter;
+      continue;
+    }
+
+    component_tracker_.markChanged(iter->first);
+    iter = blocked_bridges_.erase(iter);
+  }
+}
+
 void GraphExtractor::findComponentConnections(const GvdLayer& layer) {
+  bool component_changed = false;
   std::unordered_set<NodeId> root_nodes;
   for (const auto& node_set : pseudo_edge_window_) {
     for (const auto node : node_set) {
       // previous passes may delete nodes that we visited
       if (node_id_root_map_.count(node)) {
         root_nodes.insert(node);
+        component_changed |= component_tracker_.hasChanged(node);
       }
     }
   }
 
+  if (!component_changed) {
+    return;  // bridging was already attempted for the current components
+  }
+
   Components components = graph_utilities::getConnectedComponents<SceneGraphLayer>(
       *graph_, config_.connected_component_hops, root_nodes);
 
@@ -783,13 +992,21 @@ void GraphExtractor::findComponentConnections(const GvdLayer& layer) {
   }
 
   std::vector<NodeId> largest_component = filtered_components.front();
+  const bool largest_changed = std::any_of(
+      largest_component.begin(), largest_component.end(), [&](NodeId node) {
+        return component_tracker_.hasChanged(node);
+      });
 
   for (size_t i = 1; i < filtered_components.size(); ++i) {
+    const auto& component = filtered_components[i];
+    if (!largest_changed && !component_tracker_.hasChanged(component.front())) {
+      continue;  // neither side changed since the last attempt
+    }
+
     // TODO(nathan) this is potentially expensive (rebuilds the KD tree index every
     // time)
     NearestNodeFinder node_finder(*graph_, largest_component);
 
-    const auto& component = filtered_components[i];
     const size_t num_to_check = component.size() < config_.component_nodes_to_check
                                     ? component.size()
                                     : config_.component_nodes_to_check;
@@ -839,16 +1056,11 @@ void GraphExtractor::filterIsolatedNodes() {
   for (const auto node : to_delete) {
     clearNodeInfo(node);
   }
-  // check on isolated nodes
-  std::list<NodeId> isolated;
-  for (const auto& id_node_pair : graph_->nodes()) {
-    if (!id_node_pair.second->hasSiblings()) {
-      isolated.push_back(id_node_pair.first);
-    }
-  }
 }
 
 void GraphExtractor::extract(const GvdLayer& layer) {
+  detachGraphSnapshot();
+
   // find initial sparse graph
   findNewVertices(layer);
   extractEdges(layer, config_.merge_new_nodes);
@@ -867,6 +1079,9 @@ void GraphExtractor::extract(const GvdLayer& layer) {
     findFreespaceEdges();
   }
 
+  // tracked even without bridging so that removals don't pile up
+  component_tracker_.update(*graph_);
+
   // heuristically add global connectivity
   if (config_.add_component_connection_edges) {
     pseudo_edge_window_.push_back(visited_nodes_);
@@ -874,9 +1089,13 @@ void GraphExtractor::extract(const GvdLayer& layer) {
       pseudo_edge_window_.pop_front();
     }
 
+    retryBlockedBridges();
     findComponentConnections(layer);
   }
 
+  // bridging only needs to revisit components that change after this point
+  component_tracker_.clearChanged();
+
   if (config_.remove_isolated_nodes) {
     filterIsolatedNodes();
   }
@@ -896,40 +1115,130 @@ void GraphExtractor::extract(const GvdLayer& layer) {
   CHECK_EQ(num_valid, num_total) << num_valid << " / " << num_total;
 }
 
-void GraphExtractor::assignMeshVertices(const GvdLayer& gvd,
-                                        const GvdParentMap& parents,
-                                        const GvdVertexMap& parent_vertices) {
-  for (const auto& id_index_pair : node_id_root_map_) {
-    const NodeId node_id = id_index_pair.first;
-    const GlobalIndex& node_index = id_index_pair.second;
-
-    auto& attrs = graph_->getNode(node_id)->get().attributes<PlaceNodeAttributes>();
-    attrs.voxblox_mesh_connections.clear();
-
-    const GvdVoxel* voxel = CHECK_NOTNULL(gvd.getVoxelPtrByGlobalIndex(node_index));
-    const GlobalIndex curr_parent = Eigen::Map<const GlobalIndex>(voxel->parent);
-    auto iter = parent_vertices.find(curr_parent);
-    if (iter != parent_vertices.end()) {
-      const auto& parent_info = iter->second;
-      NearestVertexInfo info;
-      std::memcpy(info.block, parent_info.block, sizeof(info.block));
-      std::memcpy(info.voxel_pos, parent_info.pos, sizeof(info.voxel_pos));
-      info.vertex = parent_info.vertex;
-      attrs.voxblox_mesh_connections.push_back(info);
-    }
-
-    CHECK(parents.count(node_index));
-    for (const auto& parent : parents.at(node_index)) {
-      if (!parent_vertices.count(parent)) {
-        continue;
-      }
+size_t GraphExtractor::assignMeshVertices(const GvdLayer& gvd,
+                                          const GvdParentMap& parents,
+                                          const GvdVertexMap& parent_vertices) {
+  std::unordered_set<NodeId> to_assign;
+  to_assign.swap(mesh_dirty_nodes_);
+
+  for (const auto& block : changed_mesh_blocks_) {
+    const auto iter = block_nodes_.find(block);
+    if (iter != block_nodes_.end()) {
+      to_assign.insert(iter->second.begin(), iter->second.end());
+    }
+  }
+  changed_mesh_blocks_.clear();
+
+  for (const auto& parent : changed_parent_vertices_) {
+    const auto iter = parent_nodes_.find(parent);
+    if (iter != parent_nodes_.end()) {
+      to_assign.insert(iter->second.begin(), iter->second.end());
+    }
+  }
+  changed_parent_vertices_.clear();
+
+  if (to_assign.empty()) {
+    return 0;
+  }
+
+  detachGraphSnapshot();
+
+  size_t num_assigned = 0;
+  for (const auto node_id : to_assign) {
+    if (!node_id_root_map_.count(node_id)) {
+      continue;  // removed after being marked
+    }
+
+    assignNodeMeshVertices(gvd, node_id, parents, parent_vertices);
+    ++num_assigned;
+  }
+
+  return num_assigned;
+}
+
+void GraphExtractor::assignNodeMeshVertices(const GvdLayer& gvd,
+                                            NodeId node_id,
+                                            const GvdParentMap& parents,
+                                            const GvdVertexMap& parent_vertices) {
+  const GlobalIndex& node_index = node_id_root_map_.at(node_id);
+  auto& attrs = graph_->getNode(node_id)->get().attributes<PlaceNodeAttributes>();
+  attrs.voxblox_mesh_connections.clear();
+  graph_changes_.modified_nodes.insert(node_id);
+
+  // drop the previous parents from the reverse lookup
+  auto info_iter = node_mesh_info_.find(node_id);
+  if (info_iter == node_mesh_info_.end()) {
+    NodeMeshInfo info;
+    info.block = voxblox::getBlockIndexFromGlobalVoxelIndex(
+        node_index, 1.0f / static_cast<FloatingPoint>(gvd.voxels_per_side()));
+    block_nodes_[info.block].insert(node_id);
+    info_iter = node_mesh_info_.emplace(node_id, info).first;
+  } else {
+    removeParentLookup(node_id, info_iter->second);
+  }
+
+  NodeMeshInfo& mesh_info = info_iter->second;
+  mesh_info.parents.clear();
+
+  const GvdVoxel* voxel = CHECK_NOTNULL(gvd.getVoxelPtrByGlobalIndex(node_index));
+  mesh_info.parents.push_back(Eigen::Map<const GlobalIndex>(voxel->parent));
+
+  CHECK(parents.count(node_index));
+  const auto& node_parents = parents.at(node_index);
+  mesh_info.parents.insert(
+      mesh_info.parents.end(), node_parents.begin(), node_parents.end());
+
+  for (const auto& parent : mesh_info.parents) {
+    // parents without a vertex yet still need to trigger a reassignment later
+    parent_nodes_[parent].insert(node_id);
+
+    const auto iter = parent_vertices.find(parent);
+    if (iter == parent_vertices.end()) {
+      continue;
+    }
+
+    const auto& parent_info = iter->second;
+    NearestVertexInfo info;
+    std::memcpy(info.block, parent_info.block, sizeof(info.block));
+    std::memcpy(info.voxel_pos, parent_info.pos, sizeof(info.voxel_pos));
+    info.vertex = parent_info.vertex;
+    attrs.voxblox_mesh_connections.push_back(info);
+  }
+
+  // neighboring parents often share vertices and blocks
+  compactMeshConnections(attrs.voxblox_mesh_connections);
+}
+
+void GraphExtractor::clearNodeMeshInfo(NodeId node_id) {
+  mesh_dirty_nodes_.erase(node_id);
+
+  auto iter = node_mesh_info_.find(node_id);
+  if (iter == node_mesh_info_.end()) {
+    return;
+  }
+
+  auto block_iter = block_nodes_.find(iter->second.block);
+  if (block_iter != block_nodes_.end()) {
+    block_iter->second.erase(node_id);
+    if (block_iter->second.empty()) {
+      block_nodes_.erase(block_iter);
+    }
+  }
+
+  removeParentLookup(node_id, iter->second);
+  node_mesh_info_.erase(iter);
+}
+
+void GraphExtractor::removeParentLookup(NodeId node_id, const NodeMeshInfo& info) {
+  for (const auto& parent : info.parents) {
+    auto parent_iter = parent_nodes_.find(parent);
+    if (parent_iter == parent_nodes_.end()) {
+      continue;
+    }
 
-      const auto& parent_info = parent_vertices.at(parent);
-      NearestVertexInfo info;
-      std::memcpy(info.block, parent_info.block, sizeof(info.block));
-      std::memcpy(info.voxel_pos, parent_info.pos, sizeof(info.voxel_pos));
-      info.vertex = parent_info.vertex;
-      attrs.voxblox_mesh_connections.push_back(info);
+    parent_iter->second.erase(node_id);
+    if (parent_iter->second.empty()) {
+      parent_nodes_.erase(parent_iter);
     }
   }
 }
@@ -53,5 +53,33 @@ bool operator<(const EdgeSplitSeed& lhs, const EdgeSplitSeed& rhs) {
   return lhs.distance_to_edge < rhs.distance_to_edge;
 }
 
+namespace {
+
+inline EdgeEndpoints makeEdgeEndpoints(NodeId source, NodeId target) {
+  return source < target ? EdgeEndpoints(source, target)
+                         : EdgeEndpoints(target, source);
+}
+
+}  // namespace
+
+void GraphChanges::insertEdge(NodeId source, NodeId target) {
+  inserted_edges.insert(makeEdgeEndpoints(source, target));
+}
+
+void GraphChanges::removeEdge(NodeId source, NodeId target) {
+  // a previous version of the edge may still need to be removed downstream, so the
+  // removal is kept even if the edge is inserted again
+  const EdgeEndpoints key = makeEdgeEndpoints(source, target);
+  inserted_edges.erase(key);
+  removed_edges.insert(key);
+}
+
+void GraphChanges::clear() {
+  modified_nodes.clear();
+  archived_nodes.clear();
+  inserted_edges.clear();
+  removed_edges.clear();
+}
+
 }  // namespace topology
 }  // namespace hydra
@@ -43,6 +43,7 @@
 // purposes notwithstanding any copyright notation herein.
 #include "hydra_topology/gvd_integrator.h"
 #include "hydra_topology/gvd_utilities.h"
+#include "hydra_topology/memory_governor.h"
 
 #include <voxblox/utils/timing.h>
 
@@ -59,6 +60,7 @@ void UpdateStatistics::clear() {
   number_lower_updated = 0;
   number_fixed_no_parent = 0;
   number_force_lowered = 0;
+  number_mesh_assignments = 0;
 }
 
 std::ostream& operator<<(std::ostream& out, const UpdateStatistics& stats) {
@@ -72,9 +74,71 @@ std::ostream& operator<<(std::ostream& out, const UpdateStatistics& stats) {
   out << "  - Skipped (lower): " << stats.number_lower_skipped << std::endl;
   out << "  - Updated (lower): " << stats.number_lower_updated << std::endl;
   out << "  - Forced (lower): " << stats.number_force_lowered << std::endl;
+  out << "  - Mesh assignments: " << stats.number_mesh_assignments << std::endl;
   return out;
 }
 
+BlockIndexList GvdExtractionFrame::getUpdatedBlocks() const {
+  BlockIndexList blocks;
+  blocks.reserve(gvd_blocks.size());
+  for (const auto& idx_block_pair : gvd_blocks) {
+    blocks.push_back(idx_block_pair.first);
+  }
+  return blocks;
+}
+
+void GvdExtractionFrame::merge(GvdExtractionFrame&& newer) {
+  events.insert(events.end(), newer.events.begin(), newer.events.end());
+
+  for (const auto& idx : newer.archived_blocks) {
+    gvd_blocks.erase(idx);
+    archived_blocks.push_back(idx);
+  }
+
+  for (auto& idx_block_pair : newer.gvd_blocks) {
+    gvd_blocks[idx_block_pair.first] = std::move(idx_block_pair.second);
+  }
+
+  for (const auto& idx : newer.removed_parents) {
+    parents.erase(idx);
+    removed_parents.insert(idx);
+  }
+
+  for (auto& idx_parents_pair : newer.parents) {
+    removed_parents.erase(idx_parents_pair.first);
+    parents[idx_parents_pair.first] = std::move(idx_parents_pair.second);
+  }
+
+  for (const auto& idx : newer.changed_vertices) {
+    auto iter = newer.parent_vertices.find(idx);
+    if (iter == newer.parent_vertices.end()) {
+      parent_vertices.erase(idx);
+    } else {
+      parent_vertices[idx] = iter->second;
+    }
+    changed_vertices.insert(idx);
+  }
+}
+
+namespace {
+
+inline void applyExtractorEvent(GraphExtractor& extractor,
+                                const GvdExtractionFrame::Event& event) {
+  switch (event.type) {
+    case GvdExtractionFrame::EventType::PUSH:
+      extractor.pushGvdIndex(event.index);
+      break;
+    case GvdExtractionFrame::EventType::CLEAR:
+      extractor.clearGvdIndex(event.index);
+      break;
+    case GvdExtractionFrame::EventType::REMOVE:
+      extractor.removeDistantIndex(event.index);
+      break;
+  }
+}
+
+}  // namespace
+
 GvdIntegrator::GvdIntegrator(const GvdIntegratorConfig& config,
                              Layer<TsdfVoxel>* tsdf_layer,
                              const Layer<GvdVoxel>::Ptr& gvd_layer,
@@ -82,7 +146,8 @@ GvdIntegrator::GvdIntegrator(const GvdIntegratorConfig& config,
     : config_(config),
       tsdf_layer_(tsdf_layer),
       gvd_layer_(gvd_layer),
-      mesh_layer_(mesh_layer) {
+      mesh_layer_(mesh_layer),
+      defer_extraction_(false) {
   // TODO(nathan) we could consider an exception here for any of these
   CHECK(tsdf_layer_);
   CHECK(gvd_layer_);
@@ -91,6 +156,7 @@ GvdIntegrator::GvdIntegrator(const GvdIntegratorConfig& config,
   CHECK(tsdf_layer_->voxels_per_side() == gvd_layer_->voxels_per_side());
 
   voxel_size_ = gvd_layer_->voxel_size();
+  voxels_per_side_inv_ = 1.0 / gvd_layer_->voxels_per_side();
 
   lower_.setNumBuckets(config_.num_buckets, config_.max_distance_m);
 
@@ -109,6 +175,10 @@ uint8_t GvdIntegrator::updateGvdParentMap(const GlobalIndex& voxel_index,
     gvd_parents_[voxel_index] = voxblox::LongIndexSet();
   }
 
+  if (defer_extraction_) {
+    changed_parents_.insert(voxel_index);
+  }
+
   uint8_t curr_extra_basis = gvd_parents_[voxel_index].size();
   for (const auto& other_parent : gvd_parents_[voxel_index]) {
     const bool is_unique = isParentUnique(
@@ -120,6 +190,7 @@ uint8_t GvdIntegrator::updateGvdParentMap(const GlobalIndex& voxel_index,
 
   // parent is unique enough
   gvd_parents_[voxel_index].insert(neighbor_parent);
+  markBlockDirty(voxel_index);
   markNewGvdParent(neighbor_parent);
   return curr_extra_basis + 1;
 }
@@ -153,6 +224,7 @@ void GvdIntegrator::markNewGvdParent(const GlobalIndex& parent) {
   }
 
   gvd_parent_vertices_[parent] = info;
+  changed_vertices_.insert(parent);
 }
 
 void GvdIntegrator::removeVoronoiFromGvdParentMap(const GlobalIndex& voxel_index) {
@@ -167,6 +239,9 @@ void GvdIntegrator::removeVoronoiFromGvdParentMap(const GlobalIndex& voxel_index
     }
 
     gvd_parents_.erase(voxel_parents);
+    if (defer_extraction_) {
+      changed_parents_.insert(voxel_index);
+    }
   }
 }
 
@@ -174,6 +249,7 @@ void GvdIntegrator::updateVertexMapping() {
   auto iter = gvd_parent_vertices_.begin();
   while (iter != gvd_parent_vertices_.end()) {
     if (!iter->second.ref_count) {
+      changed_vertices_.insert(iter->first);
       iter = gvd_parent_vertices_.erase(iter);
       continue;
     }
@@ -185,10 +261,12 @@ void GvdIntegrator::updateVertexMapping() {
     }
 
     if (!voxel->on_surface) {
+      changed_vertices_.insert(iter->first);
       iter = gvd_parent_vertices_.erase(iter);
       continue;
     }
 
+    const GvdVertexInfo prev_info = iter->second;
     iter->second.vertex = voxel->block_vertex_index;
 
     const BlockIndex block_index = Eigen::Map<BlockIndex>(voxel->mesh_block);
@@ -198,6 +276,7 @@ void GvdIntegrator::updateVertexMapping() {
     if (voxel->block_vertex_index >= mesh_block.vertices.size()) {
       LOG(ERROR) << "Invalid vertex: " << voxel->block_vertex_index
                  << " >= " << mesh_block.vertices.size();
+      changed_vertices_.insert(iter->first);
       iter = gvd_parent_vertices_.erase(iter);
       continue;
     }
@@ -207,6 +286,12 @@ void GvdIntegrator::updateVertexMapping() {
     iter->second.pos[1] = vertex_pos(1);
     iter->second.pos[2] = vertex_pos(2);
 
+    if (prev_info.vertex != iter->second.vertex ||
+        std::memcmp(prev_info.block, iter->second.block, sizeof(prev_info.block)) ||
+        std::memcmp(prev_info.pos, iter->second.pos, sizeof(prev_info.pos))) {
+      changed_vertices_.insert(iter->first);
+    }
+
     ++iter;
   }
 }
@@ -226,22 +311,35 @@ void GvdIntegrator::updateGvdVoxel(const GlobalIndex& voxel_index,
   }
 
   voxel.num_extra_basis = new_basis;
+  markBlockDirty(voxel_index);
 
   if (voxel.num_extra_basis == config_.min_basis_for_extraction) {
-    graph_extractor_->pushGvdIndex(voxel_index);
+    notifyGraphExtractor(GvdExtractionFrame::EventType::PUSH, voxel_index);
   }
 }
 
 void GvdIntegrator::clearGvdVoxel(const GlobalIndex& index, GvdVoxel& voxel) {
+  markBlockDirty(index);
+
   if (voxel.num_extra_basis) {
     // TODO(nathan) rethink how clearing voxels from graph extractor works
-    graph_extractor_->clearGvdIndex(index);
+    notifyGraphExtractor(GvdExtractionFrame::EventType::CLEAR, index);
     removeVoronoiFromGvdParentMap(index);
   }
 
   resetVoronoi(voxel);
 }
 
+void GvdIntegrator::notifyGraphExtractor(GvdExtractionFrame::EventType type,
+                                         const GlobalIndex& index) {
+  GvdExtractionFrame::Event event{type, index};
+  if (defer_extraction_) {
+    extraction_frame_->events.push_back(event);
+  } else {
+    applyExtractorEvent(*graph_extractor_, event);
+  }
+}
+
 void GvdIntegrator::updateVoronoiQueue(GvdVoxel& voxel,
                                        const GlobalIndex& voxel_idx,
                                        GvdVoxel& neighbor,
@@ -267,13 +365,27 @@ BlockIndexList GvdIntegrator::removeDistantBlocks(const voxblox::Point& center,
   BlockIndexList blocks;
   gvd_layer_->getAllAllocatedBlocks(&blocks);
 
-  BlockIndexList archived;
+  BlockIndexList distant_blocks;
   for (const auto& idx : blocks) {
     Block<GvdVoxel>::Ptr block = gvd_layer_->getBlockPtrByIndex(idx);
     if ((center - block->origin()).norm() < max_distance) {
       continue;
     }
 
+    distant_blocks.push_back(idx);
+  }
+
+  return archiveBlocks(distant_blocks);
+}
+
+BlockIndexList GvdIntegrator::archiveBlocks(const BlockIndexList& blocks) {
+  BlockIndexList archived;
+  for (const auto& idx : blocks) {
+    Block<GvdVoxel>::Ptr block = gvd_layer_->getBlockPtrByIndex(idx);
+    if (!block) {
+      continue;
+    }
+
     for (size_t v = 0; v < block->num_voxels(); ++v) {
       const GvdVoxel& voxel = block->getVoxelByLinearIndex(v);
       if (!voxel.observed) {
@@ -285,7 +397,7 @@ BlockIndexList GvdIntegrator::removeDistantBlocks(const voxblox::Point& center,
               idx,
               block->computeVoxelIndexFromLinearIndex(v),
               gvd_layer_->voxels_per_side());
-      graph_extractor_->removeDistantIndex(global_index);
+      notifyGraphExtractor(GvdExtractionFrame::EventType::REMOVE, global_index);
 
       removeVoronoiFromGvdParentMap(global_index);
     }
@@ -296,13 +408,180 @@ BlockIndexList GvdIntegrator::removeDistantBlocks(const voxblox::Point& center,
     archived.push_back(idx);
   }
 
+  if (defer_extraction_) {
+    for (const auto& idx : archived) {
+      dirty_blocks_.erase(idx);
+    }
+
+    last_dirty_block_.reset();
+    extraction_frame_->archived_blocks.insert(
+        extraction_frame_->archived_blocks.end(), archived.begin(), archived.end());
+  }
+
   return archived;
 }
 
+size_t GvdIntegrator::getParentMemorySize() const {
+  size_t num_bytes =
+      getHashMapMemorySize(gvd_parents_) + getHashMapMemorySize(gvd_parent_vertices_);
+  for (const auto& index_parents_pair : gvd_parents_) {
+    num_bytes += getHashMapMemorySize(index_parents_pair.second);
+  }
+
+  return num_bytes;
+}
+
+void GvdIntegrator::setDeferredExtraction(bool defer_extraction) {
+  if (defer_extraction == defer_extraction_) {
+    return;
+  }
+
+  defer_extraction_ = defer_extraction;
+  if (!defer_extraction_) {
+    // the extractor has seen every change: drop the private copies
+    extraction_frame_.reset();
+    extraction_layer_.reset();
+    extraction_parents_.clear();
+    extraction_parent_vertices_.clear();
+    dirty_blocks_.clear();
+    last_dirty_block_.reset();
+    changed_parents_.clear();
+    changed_vertices_.clear();
+    return;
+  }
+
+  // seed the private copies with the current state so that the first frame only
+  // has to carry the changes since now
+  extraction_frame_.reset(new GvdExtractionFrame());
+  extraction_layer_.reset(
+      new Layer<GvdVoxel>(gvd_layer_->voxel_size(), gvd_layer_->voxels_per_side()));
+  BlockIndexList blocks;
+  gvd_layer_->getAllAllocatedBlocks(&blocks);
+  for (const auto& idx : blocks) {
+    extraction_layer_->insertBlock(
+        std::make_pair(idx, copyGvdBlock(gvd_layer_->getBlockByIndex(idx))));
+  }
+  extraction_parents_ = gvd_parents_;
+  extraction_parent_vertices_ = gvd_parent_vertices_;
+}
+
+GvdExtractionFrame::Ptr GvdIntegrator::popExtractionFrame() {
+  CHECK(defer_extraction_) << "extraction frames require deferred extraction";
+  voxblox::timing::Timer timer("gvd/pop_extraction_frame");
+
+  GvdExtractionFrame::Ptr frame = std::move(extraction_frame_);
+  extraction_frame_.reset(new GvdExtractionFrame());
+
+  for (const auto& idx : dirty_blocks_) {
+    Block<GvdVoxel>::Ptr block = gvd_layer_->getBlockPtrByIndex(idx);
+    if (!block) {
+      continue;
+    }
+
+    frame->gvd_blocks[idx] = copyGvdBlock(*block);
+  }
+
+  for (const auto& idx : changed_parents_) {
+    const auto iter = gvd_parents_.find(idx);
+    if (iter == gvd_parents_.end()) {
+      frame->removed_parents.insert(idx);
+    } else {
+      frame->parents[idx] = iter->second;
+    }
+  }
+
+  // only the changed vertex info is sent (the extractor keeps its own copy)
+  for (const auto& idx : changed_vertices_) {
+    const auto iter = gvd_parent_vertices_.find(idx);
+    if (iter != gvd_parent_vertices_.end()) {
+      frame->parent_vertices.emplace(idx, iter->second);
+    }
+  }
+  frame->changed_vertices = std::move(changed_vertices_);
+
+  dirty_blocks_.clear();
+  last_dirty_block_.reset();
+  changed_parents_.clear();
+  changed_vertices_.clear();
+  return frame;
+}
+
+void GvdIntegrator::extractGraph(const GvdExtractionFrame& frame) {
+  CHECK(defer_extraction_) << "extraction frames require deferred extraction";
+
+  voxblox::timing::Timer apply_timer("gvd/apply_extraction_frame");
+  for (const auto& idx : frame.archived_blocks) {
+    extraction_layer_->removeBlock(idx);
+  }
+
+  for (const auto& idx_block_pair : frame.gvd_blocks) {
+    // blocks are never modified after being copied, so sharing them is safe
+    extraction_layer_->removeBlock(idx_block_pair.first);
+    extraction_layer_->insertBlock(idx_block_pair);
+  }
+
+  for (const auto& idx : frame.removed_parents) {
+    extraction_parents_.erase(idx);
+  }
+
+  for (const auto& idx_parents_pair : frame.parents) {
+    extraction_parents_[idx_parents_pair.first] = idx_parents_pair.second;
+  }
+
+  for (const auto& event : frame.events) {
+    applyExtractorEvent(*graph_extractor_, event);
+  }
+
+  for (const auto& idx_block_pair : frame.gvd_blocks) {
+    graph_extractor_->markBlockChanged(idx_block_pair.first);
+  }
+
+  for (const auto& parent : frame.changed_vertices) {
+    const auto iter = frame.parent_vertices.find(parent);
+    if (iter == frame.parent_vertices.end()) {
+      extraction_parent_vertices_.erase(parent);
+    } else {
+      extraction_parent_vertices_[parent] = iter->second;
+    }
+
+    graph_extractor_->markParentVertexChanged(parent);
+  }
+  apply_timer.Stop();
+
+  voxblox::timing::Timer extraction_timer("gvd/extract_graph");
+  graph_extractor_->extract(*extraction_layer_);
+  const size_t num_assigned = graph_extractor_->assignMeshVertices(
+      *extraction_layer_, extraction_parents_, extraction_parent_vertices_);
+  VLOG(2) << "[GVD extraction]: reassigned mesh vertices for " << num_assigned
+          << " nodes";
+}
+
+size_t GvdIntegrator::getExtractionMemorySize() const {
+  size_t num_bytes = graph_extractor_->getMemorySize();
+  if (!defer_extraction_) {
+    return num_bytes;
+  }
+
+  num_bytes += extraction_layer_->getMemorySize();
+  num_bytes += getHashMapMemorySize(extraction_parents_);
+  num_bytes += getHashMapMemorySize(extraction_parent_vertices_);
+  for (const auto& index_parents_pair : extraction_parents_) {
+    num_bytes += getHashMapMemorySize(index_parents_pair.second);
+  }
+
+  return num_bytes;
+}
+
 void GvdIntegrator::updateFromTsdfLayer(bool clear_updated_flag,
                                         bool clear_surface_flag,
                                         bool use_all_blocks) {
   update_stats_.clear();
+  if (!defer_extraction_) {
+    // changes from previous updates have already been handed to the extractor
+    dirty_blocks_.clear();
+    last_dirty_block_.reset();
+    changed_vertices_.clear();
+  }
 
   BlockIndexList blocks;
   if (use_all_blocks) {
@@ -310,6 +589,9 @@ void GvdIntegrator::updateFromTsdfLayer(bool clear_updated_flag,
   } else {
     tsdf_layer_->getAllUpdatedBlocks(voxblox::Update::kEsdf, &blocks);
   }
+  updated_blocks_ = blocks;
+  // marching cubes and tsdf propagation may touch any voxel in these blocks
+  dirty_blocks_.insert(blocks.begin(), blocks.end());
 
   voxblox::timing::Timer gvd_timer("gvd");
 
@@ -362,9 +644,20 @@ void GvdIntegrator::updateFromTsdfLayer(bool clear_updated_flag,
     VLOG(3) << "[GVD update]: starting graph extraction";
     voxblox::timing::Timer extraction_timer("gvd/extract_graph");
     updateVertexMapping();
-    graph_extractor_->extract(*gvd_layer_);
-    graph_extractor_->assignMeshVertices(
-        *gvd_layer_, gvd_parents_, gvd_parent_vertices_);
+    if (!defer_extraction_) {
+      // otherwise the graph is extracted by extractGraph
+      for (const auto& idx : dirty_blocks_) {
+        graph_extractor_->markBlockChanged(idx);
+      }
+
+      for (const auto& parent : changed_vertices_) {
+        graph_extractor_->markParentVertexChanged(parent);
+      }
+
+      graph_extractor_->extract(*gvd_layer_);
+      update_stats_.number_mesh_assignments = graph_extractor_->assignMeshVertices(
+          *gvd_layer_, gvd_parents_, gvd_parent_vertices_);
+    }
     extraction_timer.Stop();
     VLOG(3) << "[GVD update]: finished graph extraction";
   }
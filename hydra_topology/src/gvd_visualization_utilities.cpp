@@ -307,8 +307,7 @@ void fillMarkerFromBlock(Marker& marker,
   }
 }
 
-template <typename LayerType>
-Marker makeBlocksMarkerImpl(const LayerType& layer, double scale) {
+Marker makeBlocksMarker(const BlockIndexList& blocks, double block_size, double scale) {
   Marker marker;
   marker.type = Marker::LINE_LIST;
   marker.action = Marker::ADD;
@@ -325,18 +324,21 @@ Marker makeBlocksMarkerImpl(const LayerType& layer, double scale) {
   tf2::convert(identity_pos, marker.pose.position);
   tf2::convert(Eigen::Quaterniond::Identity(), marker.pose.orientation);
 
-  BlockIndexList blocks;
-  layer.getAllAllocatedBlocks(&blocks);
-
   for (const auto& idx : blocks) {
-    const auto& block = layer.getBlockByIndex(idx);
-    Eigen::Vector3f block_pos = block.origin();
-    fillMarkerFromBlock(marker, block_pos.cast<double>(), block.block_size());
+    Eigen::Vector3d block_pos = idx.cast<double>() * block_size;
+    fillMarkerFromBlock(marker, block_pos, block_size);
   }
 
   return marker;
 }
 
+template <typename LayerType>
+Marker makeBlocksMarkerImpl(const LayerType& layer, double scale) {
+  BlockIndexList blocks;
+  layer.getAllAllocatedBlocks(&blocks);
+  return makeBlocksMarker(blocks, layer.block_size(), scale);
+}
+
 Marker makeBlocksMarker(const Layer<TsdfVoxel>& layer, double scale) {
   return makeBlocksMarkerImpl(layer, scale);
 }
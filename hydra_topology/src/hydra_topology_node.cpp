@@ -34,6 +34,7 @@
  * -------------------------------------------------------------------------- */
 #include "hydra_topology/topology_server.h"
 
+#include <hydra_utils/metric_utilities.h>
 #include <kimera_semantics_ros/semantic_tsdf_server.h>
 #include <voxblox_ros/tsdf_server.h>
 
@@ -52,6 +53,9 @@ int main(int argc, char* argv[]) {
 
   ros::NodeHandle pnh("~");
 
+  std::string log_path = "";
+  pnh.getParam("log_path", log_path);
+
   bool use_semantic_tsdf_server = false;
   pnh.getParam("use_semantic_tsdf_server", use_semantic_tsdf_server);
   if (use_semantic_tsdf_server) {
@@ -64,5 +68,9 @@ int main(int argc, char* argv[]) {
     server.spin();
   }
 
+  if (!log_path.empty()) {
+    hydra::metrics::MetricRecorder::instance().logAllMetrics(log_path);
+  }
+
   return 0;
 }
@@ -0,0 +1,463 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_topology/layer_encoding.h"
+#include "hydra_topology/mesh_connections.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace hydra {
+namespace topology {
+
+namespace {
+
+// the leading null byte can never start a JSON document
+const char kBinaryMagic[] = {'\0', 'H', 'P', 'L'};
+const size_t kMagicSize = sizeof(kBinaryMagic);
+const uint8_t kBinaryVersion = 3;
+// mesh connection positions are only drawn, so they are quantized to a millimeter
+const double kConnectionResolution = 1.0e-3;
+
+class ByteWriter {
+ public:
+  explicit ByteWriter(std::string& buffer) : buffer_(buffer) {}
+
+  void writeByte(uint8_t value) { buffer_.push_back(static_cast<char>(value)); }
+
+  void writeVarint(uint64_t value) {
+    while (value >= 0x80) {
+      writeByte(static_cast<uint8_t>(value) | 0x80);
+      value >>= 7;
+    }
+    writeByte(static_cast<uint8_t>(value));
+  }
+
+  void writeSigned(int64_t value) {
+    // zig-zag encoding keeps small negative values small
+    const uint64_t sign = static_cast<uint64_t>(value >> 63);
+    writeVarint((static_cast<uint64_t>(value) << 1) ^ sign);
+  }
+
+  void writeDouble(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    // fixed little-endian byte order, independent of the host
+    for (size_t i = 0; i < sizeof(bits); ++i) {
+      writeByte(static_cast<uint8_t>(bits >> (8 * i)));
+    }
+  }
+
+ private:
+  std::string& buffer_;
+};
+
+class ByteReader {
+ public:
+  ByteReader(const std::string& buffer, size_t offset)
+      : buffer_(buffer), pos_(offset) {}
+
+  bool readByte(uint8_t& value) {
+    if (pos_ >= buffer_.size()) {
+      return false;
+    }
+
+    value = static_cast<uint8_t>(buffer_[pos_]);
+    ++pos_;
+    return true;
+  }
+
+  bool readVarint(uint64_t& value) {
+    value = 0;
+    for (size_t shift = 0; shift < 64; shift += 7) {
+      uint8_t byte;
+      if (!readByte(byte)) {
+        return false;
+      }
+
+      value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if (!(byte & 0x80)) {
+        return true;
+      }
+    }
+
+    return false;  // more than 10 bytes can't be a valid varint
+  }
+
+  bool readSigned(int64_t& value) {
+    uint64_t encoded;
+    if (!readVarint(encoded)) {
+      return false;
+    }
+
+    value = static_cast<int64_t>(encoded >> 1) ^ -static_cast<int64_t>(encoded & 1);
+    return true;
+  }
+
+  bool readDouble(double& value) {
+    uint64_t bits = 0;
+    for (size_t i = 0; i < sizeof(bits); ++i) {
+      uint8_t byte;
+      if (!readByte(byte)) {
+        return false;
+      }
+      bits |= static_cast<uint64_t>(byte) << (8 * i);
+    }
+
+    std::memcpy(&value, &bits, sizeof(value));
+    return true;
+  }
+
+  //! Check that a count read from the buffer could fit in the remaining bytes
+  bool canHold(uint64_t count, size_t min_bytes_per_entry) const {
+    return count <= (buffer_.size() - pos_) / min_bytes_per_entry;
+  }
+
+  bool done() const { return pos_ == buffer_.size(); }
+
+ private:
+  const std::string& buffer_;
+  size_t pos_;
+};
+
+using QuantizedPosition = std::array<int64_t, 3>;
+
+template <typename T>
+QuantizedPosition quantizePosition(const T& pos) {
+  return {std::llround(pos[0] / kConnectionResolution),
+          std::llround(pos[1] / kConnectionResolution),
+          std::llround(pos[2] / kConnectionResolution)};
+}
+
+void writeNode(ByteWriter& writer, const PlaceNodeAttributes& attrs) {
+  for (int i = 0; i < 3; ++i) {
+    writer.writeDouble(attrs.position(i));
+  }
+  writer.writeDouble(attrs.distance);
+  writer.writeVarint(attrs.num_basis_points);
+
+  // connections are stored as per-block runs of vertex intervals, which is lossless
+  // for any order but is most compact for compacted connections
+  const auto& connections = attrs.voxblox_mesh_connections;
+  const auto runs = getBlockRuns(connections);
+  writer.writeVarint(runs.size());
+  voxblox::BlockIndex prev_block = voxblox::BlockIndex::Zero();
+  // positions are deltas from the previous connection (starting at the place)
+  QuantizedPosition prev_pos = quantizePosition(attrs.position);
+  for (const auto& run : runs) {
+    for (int i = 0; i < 3; ++i) {
+      writer.writeSigned(static_cast<int64_t>(run.block(i)) - prev_block(i));
+    }
+    prev_block = run.block;
+
+    const auto intervals = getVertexIntervals(connections, run);
+    writer.writeVarint(intervals.size());
+    uint64_t prev_end = 0;
+    for (const auto& interval : intervals) {
+      writer.writeSigned(static_cast<int64_t>(interval.start - prev_end));
+      writer.writeVarint(interval.size());
+      prev_end = interval.end;
+    }
+
+    for (size_t c = run.begin; c < run.end; ++c) {
+      const auto pos = quantizePosition(connections[c].voxel_pos);
+      for (int i = 0; i < 3; ++i) {
+        writer.writeSigned(pos[i] - prev_pos[i]);
+      }
+      prev_pos = pos;
+    }
+  }
+}
+
+bool readBlockRun(ByteReader& reader,
+                  voxblox::BlockIndex& block,
+                  QuantizedPosition& prev_pos,
+                  MeshConnections& connections) {
+  using BlockScalar = std::remove_reference_t<decltype(NearestVertexInfo().block[0])>;
+  for (int i = 0; i < 3; ++i) {
+    int64_t delta;
+    if (!reader.readSigned(delta)) {
+      return false;
+    }
+    block(i) = static_cast<voxblox::BlockIndex::Scalar>(block(i) + delta);
+  }
+
+  uint64_t num_intervals;
+  // each interval takes at least 1 start byte, 1 size byte and 3 position bytes
+  if (!reader.readVarint(num_intervals) || !reader.canHold(num_intervals, 5)) {
+    return false;
+  }
+
+  const size_t run_begin = connections.size();
+  uint64_t prev_end = 0;
+  for (uint64_t i = 0; i < num_intervals; ++i) {
+    int64_t start_delta;
+    uint64_t size;
+    if (!reader.readSigned(start_delta) || !reader.readVarint(size) || size == 0 ||
+        !reader.canHold(size, 3) ||
+        !reader.canHold(connections.size() - run_begin + size, 3)) {
+      return false;
+    }
+
+    // vertices are unsigned, so the deltas wrap the same way they were written
+    const uint64_t start = prev_end + static_cast<uint64_t>(start_delta);
+    for (uint64_t v = 0; v < size; ++v) {
+      NearestVertexInfo info;
+      for (int j = 0; j < 3; ++j) {
+        info.block[j] = static_cast<BlockScalar>(block(j));
+      }
+      info.vertex = static_cast<size_t>(start) + v;
+      connections.push_back(info);
+    }
+    prev_end = start + size;
+  }
+
+  for (size_t c = run_begin; c < connections.size(); ++c) {
+    for (int i = 0; i < 3; ++i) {
+      int64_t delta;
+      if (!reader.readSigned(delta)) {
+        return false;
+      }
+
+      prev_pos[i] += delta;
+      connections[c].voxel_pos[i] = prev_pos[i] * kConnectionResolution;
+    }
+  }
+
+  return true;
+}
+
+PlaceNodeAttributes::Ptr readNode(ByteReader& reader) {
+  Eigen::Vector3d position;
+  for (int i = 0; i < 3; ++i) {
+    if (!reader.readDouble(position(i))) {
+      return nullptr;
+    }
+  }
+
+  double distance;
+  uint64_t num_basis_points;
+  uint64_t num_runs;
+  if (!reader.readDouble(distance) || !reader.readVarint(num_basis_points) ||
+      !reader.readVarint(num_runs)) {
+    return nullptr;
+  }
+
+  // each run takes at least 3 block bytes and 1 count byte
+  if (!reader.canHold(num_runs, 4)) {
+    return nullptr;
+  }
+
+  PlaceNodeAttributes::Ptr attrs(new PlaceNodeAttributes(distance, num_basis_points));
+  attrs->position = position;
+  attrs->color = decltype(attrs->color)::Zero();
+
+  voxblox::BlockIndex block = voxblox::BlockIndex::Zero();
+  QuantizedPosition prev_pos = quantizePosition(position);
+  for (uint64_t i = 0; i < num_runs; ++i) {
+    if (!readBlockRun(reader, block, prev_pos, attrs->voxblox_mesh_connections)) {
+      return nullptr;
+    }
+  }
+
+  return attrs;
+}
+
+std::string encodeBinaryLayer(const SceneGraphLayer& layer,
+                              const std::unordered_set<NodeId>& nodes) {
+  // sorted ids keep the deltas small (places share a prefix and are mostly sequential)
+  std::vector<NodeId> sorted_nodes;
+  sorted_nodes.reserve(nodes.size());
+  for (const auto node_id : nodes) {
+    if (layer.hasNode(node_id)) {
+      sorted_nodes.push_back(node_id);
+    }
+  }
+  std::sort(sorted_nodes.begin(), sorted_nodes.end());
+
+  std::vector<const SceneGraphEdge*> edges;
+  for (const auto node_id : sorted_nodes) {
+    for (const auto sibling : layer.getNode(node_id).value().get().siblings()) {
+      if (nodes.count(sibling) && sibling < node_id) {
+        continue;  // already added from the other endpoint
+      }
+
+      edges.push_back(&layer.getEdge(node_id, sibling).value().get());
+    }
+  }
+
+  std::sort(edges.begin(), edges.end(), [](const auto* lhs, const auto* rhs) {
+    return std::make_pair(lhs->source, lhs->target) <
+           std::make_pair(rhs->source, rhs->target);
+  });
+
+  std::string contents(kBinaryMagic, kMagicSize);
+  ByteWriter writer(contents);
+  writer.writeByte(kBinaryVersion);
+
+  writer.writeVarint(sorted_nodes.size());
+  NodeId prev_node = 0;
+  for (const auto node_id : sorted_nodes) {
+    writer.writeVarint(node_id - prev_node);
+    prev_node = node_id;
+
+    const SceneGraphNode& node = layer.getNode(node_id).value();
+    writeNode(writer, node.attributes<PlaceNodeAttributes>());
+  }
+
+  writer.writeVarint(edges.size());
+  NodeId prev_source = 0;
+  for (const auto* edge : edges) {
+    writer.writeVarint(edge->source - prev_source);
+    writer.writeSigned(static_cast<int64_t>(edge->target - edge->source));
+    prev_source = edge->source;
+
+    writer.writeByte(edge->info->weighted ? 1 : 0);
+    writer.writeDouble(edge->info->weight);
+  }
+
+  return contents;
+}
+
+std::unique_ptr<SceneGraphLayer::Edges> decodeBinaryLayer(
+    const std::string& contents, IsolatedSceneGraphLayer& layer) {
+  ByteReader reader(contents, kMagicSize);
+  uint8_t version;
+  if (!reader.readByte(version)) {
+    LOG(ERROR) << "Binary layer is missing a version";
+    return nullptr;
+  }
+
+  if (version != kBinaryVersion) {
+    LOG(ERROR) << "Unsupported binary layer version: " << static_cast<int>(version);
+    return nullptr;
+  }
+
+  uint64_t num_nodes;
+  // each node takes at least 1 id byte, 32 attribute bytes and 2 count bytes
+  if (!reader.readVarint(num_nodes) || !reader.canHold(num_nodes, 35)) {
+    LOG(ERROR) << "Binary layer has an invalid number of nodes";
+    return nullptr;
+  }
+
+  NodeId node_id = 0;
+  for (uint64_t i = 0; i < num_nodes; ++i) {
+    uint64_t delta;
+    if (!reader.readVarint(delta)) {
+      LOG(ERROR) << "Binary layer is truncated";
+      return nullptr;
+    }
+    node_id += delta;
+
+    PlaceNodeAttributes::Ptr attrs = readNode(reader);
+    if (!attrs) {
+      LOG(ERROR) << "Binary layer has invalid attributes for "
+                 << NodeSymbol(node_id).getLabel();
+      return nullptr;
+    }
+
+    layer.emplaceNode(node_id, std::move(attrs));
+  }
+
+  uint64_t num_edges;
+  // each edge takes at least 2 endpoint bytes, 1 flag byte and 8 weight bytes
+  if (!reader.readVarint(num_edges) || !reader.canHold(num_edges, 11)) {
+    LOG(ERROR) << "Binary layer has an invalid number of edges";
+    return nullptr;
+  }
+
+  auto edges = std::make_unique<SceneGraphLayer::Edges>();
+  NodeId source = 0;
+  for (uint64_t i = 0; i < num_edges; ++i) {
+    uint64_t source_delta;
+    int64_t target_offset;
+    uint8_t weighted;
+    double weight;
+    if (!reader.readVarint(source_delta) || !reader.readSigned(target_offset) ||
+        !reader.readByte(weighted) || !reader.readDouble(weight)) {
+      LOG(ERROR) << "Binary layer is truncated";
+      return nullptr;
+    }
+
+    source += source_delta;
+    const NodeId target = source + static_cast<NodeId>(target_offset);
+    auto info = weighted ? std::make_unique<EdgeAttributes>(weight)
+                         : std::make_unique<EdgeAttributes>();
+    edges->emplace(std::piecewise_construct,
+                   std::forward_as_tuple(i),
+                   std::forward_as_tuple(source, target, std::move(info)));
+  }
+
+  if (!reader.done()) {
+    LOG(ERROR) << "Binary layer has trailing bytes";
+    return nullptr;
+  }
+
+  return edges;
+}
+
+}  // namespace
+
+std::string encodeLayer(const SceneGraphLayer& layer,
+                        const std::unordered_set<NodeId>& nodes,
+                        LayerEncoding encoding) {
+  if (encoding == LayerEncoding::JSON) {
+    return layer.serializeLayer(nodes);
+  }
+
+  return encodeBinaryLayer(layer, nodes);
+}
+
+bool isBinaryLayer(const std::string& contents) {
+  return contents.size() >= kMagicSize &&
+         std::equal(kBinaryMagic, kBinaryMagic + kMagicSize, contents.begin());
+}
+
+std::unique_ptr<SceneGraphLayer::Edges> decodeLayer(const std::string& contents,
+                                                    IsolatedSceneGraphLayer& layer) {
+  if (!isBinaryLayer(contents)) {
+    return layer.deserializeLayer(contents);
+  }
+
+  return decodeBinaryLayer(contents, layer);
+}
+
+}  // namespace topology
+}  // namespace hydra
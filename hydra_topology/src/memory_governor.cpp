@@ -0,0 +1,197 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_topology/memory_governor.h"
+
+#include <hydra_utils/display_utils.h>
+#include <hydra_utils/metric_utilities.h>
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace hydra {
+namespace topology {
+
+using hydra::metrics::MetricRecorder;
+
+size_t MemoryUsage::total() const {
+  return tsdf_bytes + gvd_bytes + mesh_bytes + parent_bytes + extractor_bytes;
+}
+
+std::ostream& operator<<(std::ostream& out, const MemoryUsage& usage) {
+  using hydra_utils::getHumanReadableMemoryString;
+  return out << "[TSDF=" << getHumanReadableMemoryString(usage.tsdf_bytes)
+             << ", GVD=" << getHumanReadableMemoryString(usage.gvd_bytes)
+             << ", Mesh=" << getHumanReadableMemoryString(usage.mesh_bytes)
+             << ", Parents=" << getHumanReadableMemoryString(usage.parent_bytes)
+             << ", Extractor=" << getHumanReadableMemoryString(usage.extractor_bytes)
+             << "]";
+}
+
+MemoryGovernor::MemoryGovernor(const MemoryGovernorConfig& config,
+                               double nominal_radius_m,
+                               double block_size)
+    : config_(config),
+      nominal_radius_m_(nominal_radius_m),
+      radius_m_(nominal_radius_m),
+      block_size_(block_size) {
+  config_.min_radius_m = std::min(config_.min_radius_m, nominal_radius_m_);
+}
+
+void MemoryGovernor::updateBlockTimes(const BlockIndexList& blocks,
+                                      uint64_t timestamp_ns) {
+  if (!enabled()) {
+    return;
+  }
+
+  for (const auto& idx : blocks) {
+    block_update_times_[idx] = timestamp_ns;
+  }
+}
+
+void MemoryGovernor::removeBlocks(const BlockIndexList& blocks) {
+  for (const auto& idx : blocks) {
+    block_update_times_.erase(idx);
+  }
+}
+
+double MemoryGovernor::update(uint64_t timestamp_ns, const MemoryUsage& usage) {
+  if (!enabled()) {
+    return radius_m_;
+  }
+
+  auto& recorder = MetricRecorder::instance();
+  recorder.record("topology/memory/tsdf_bytes", timestamp_ns, usage.tsdf_bytes);
+  recorder.record("topology/memory/gvd_bytes", timestamp_ns, usage.gvd_bytes);
+  recorder.record("topology/memory/mesh_bytes", timestamp_ns, usage.mesh_bytes);
+  recorder.record("topology/memory/parent_bytes", timestamp_ns, usage.parent_bytes);
+  recorder.record(
+      "topology/memory/extractor_bytes", timestamp_ns, usage.extractor_bytes);
+  recorder.record("topology/memory/total_bytes", timestamp_ns, usage.total());
+
+  const double budget_bytes = config_.budget_mb * 1024.0 * 1024.0;
+  const double used_bytes = usage.total();
+
+  // -1: shrink, 0: hold, 1: grow
+  int decision = 0;
+  const double prev_radius_m = radius_m_;
+  if (used_bytes > budget_bytes) {
+    radius_m_ = std::max(config_.min_radius_m, radius_m_ * config_.shrink_factor);
+    decision = -1;
+  } else if (used_bytes < config_.restore_fraction * budget_bytes &&
+             radius_m_ < nominal_radius_m_) {
+    radius_m_ = std::min(nominal_radius_m_, radius_m_ * config_.grow_factor);
+    decision = 1;
+  }
+
+  recorder.record("topology/memory/radius_m", timestamp_ns, radius_m_);
+  recorder.record("topology/memory/radius_decision", timestamp_ns, decision);
+
+  if (radius_m_ != prev_radius_m) {
+    VLOG(1) << "[Memory Governor] " << (decision < 0 ? "shrinking" : "restoring")
+            << " dense radius: " << prev_radius_m << " -> " << radius_m_
+            << " [m] (usage: " << usage << ")";
+  }
+
+  return radius_m_;
+}
+
+BlockIndexList MemoryGovernor::getBlocksToArchive(uint64_t timestamp_ns,
+                                                  const MemoryUsage& usage,
+                                                  const voxblox::Point& center) const {
+  BlockIndexList to_archive;
+  const double budget_bytes = config_.budget_mb * 1024.0 * 1024.0;
+  // shrinking the radius takes priority over archiving by age
+  if (!enabled() || radius_m_ > config_.min_radius_m ||
+      usage.total() <= budget_bytes || block_update_times_.empty()) {
+    return to_archive;
+  }
+
+  const double dense_bytes = usage.tsdf_bytes + usage.gvd_bytes + usage.mesh_bytes;
+  const double bytes_per_block = dense_bytes / block_update_times_.size();
+  if (bytes_per_block <= 0.0) {
+    return to_archive;
+  }
+
+  const size_t num_to_archive =
+      std::min(config_.max_archived_blocks,
+               static_cast<size_t>(
+                   std::ceil((usage.total() - budget_bytes) / bytes_per_block)));
+
+  // distant blocks are already gone at the minimum radius, so only the blocks that
+  // the sensor is (or is next to) are protected
+  const double protected_radius_m = block_size_ * std::sqrt(3.0);
+  std::vector<std::pair<uint64_t, BlockIndex>> candidates;
+  candidates.reserve(block_update_times_.size());
+  for (const auto& idx_time_pair : block_update_times_) {
+    const voxblox::Point block_center =
+        voxblox::getOriginPointFromGridIndex(idx_time_pair.first, block_size_) +
+        voxblox::Point::Constant(block_size_ / 2.0);
+    // never archive the blocks immediately around the sensor
+    if ((block_center - center).norm() < protected_radius_m) {
+      continue;
+    }
+
+    candidates.emplace_back(idx_time_pair.second, idx_time_pair.first);
+  }
+
+  const size_t num_candidates = std::min(num_to_archive, candidates.size());
+  std::partial_sort(candidates.begin(),
+                    candidates.begin() + num_candidates,
+                    candidates.end(),
+                    [](const auto& lhs, const auto& rhs) {
+                      if (lhs.first != rhs.first) {
+                        return lhs.first < rhs.first;
+                      }
+                      return std::lexicographical_compare(lhs.second.data(),
+                                                          lhs.second.data() + 3,
+                                                          rhs.second.data(),
+                                                          rhs.second.data() + 3);
+                    });
+
+  for (size_t i = 0; i < num_candidates; ++i) {
+    to_archive.push_back(candidates[i].second);
+  }
+
+  MetricRecorder::instance().record(
+      "topology/memory/num_archived_by_age", timestamp_ns, to_archive.size());
+  VLOG(1) << "[Memory Governor] archiving " << to_archive.size()
+          << " least recently updated blocks (usage: " << usage << ")";
+  return to_archive;
+}
+
+}  // namespace topology
+}  // namespace hydra
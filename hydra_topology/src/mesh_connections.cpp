@@ -0,0 +1,114 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_topology/mesh_connections.h"
+
+#include <algorithm>
+#include <tuple>
+
+namespace hydra {
+namespace topology {
+
+namespace {
+
+inline voxblox::BlockIndex getBlock(const NearestVertexInfo& info) {
+  return voxblox::BlockIndex(info.block[0], info.block[1], info.block[2]);
+}
+
+inline bool sameBlock(const NearestVertexInfo& lhs, const NearestVertexInfo& rhs) {
+  return lhs.block[0] == rhs.block[0] && lhs.block[1] == rhs.block[1] &&
+         lhs.block[2] == rhs.block[2];
+}
+
+inline auto getKey(const NearestVertexInfo& info) {
+  return std::make_tuple(info.block[0], info.block[1], info.block[2], info.vertex);
+}
+
+}  // namespace
+
+void compactMeshConnections(MeshConnections& connections) {
+  std::stable_sort(connections.begin(),
+                   connections.end(),
+                   [](const NearestVertexInfo& lhs, const NearestVertexInfo& rhs) {
+                     return getKey(lhs) < getKey(rhs);
+                   });
+
+  auto new_end = std::unique(
+      connections.begin(),
+      connections.end(),
+      [](const NearestVertexInfo& lhs, const NearestVertexInfo& rhs) {
+        return getKey(lhs) == getKey(rhs);
+      });
+  connections.erase(new_end, connections.end());
+}
+
+void mergeMeshConnections(const MeshConnections& other, MeshConnections& connections) {
+  if (other.empty()) {
+    return;
+  }
+
+  connections.insert(connections.end(), other.begin(), other.end());
+  compactMeshConnections(connections);
+}
+
+std::vector<MeshBlockRun> getBlockRuns(const MeshConnections& connections) {
+  std::vector<MeshBlockRun> runs;
+  for (size_t i = 0; i < connections.size(); ++i) {
+    if (runs.empty() || !sameBlock(connections[runs.back().begin], connections[i])) {
+      runs.push_back({getBlock(connections[i]), i, i + 1});
+    } else {
+      runs.back().end = i + 1;
+    }
+  }
+
+  return runs;
+}
+
+std::vector<VertexInterval> getVertexIntervals(const MeshConnections& connections,
+                                               const MeshBlockRun& run) {
+  std::vector<VertexInterval> intervals;
+  for (size_t i = run.begin; i < run.end; ++i) {
+    const size_t vertex = connections[i].vertex;
+    if (intervals.empty() || intervals.back().end != vertex) {
+      intervals.push_back({vertex, vertex + 1});
+    } else {
+      intervals.back().end = vertex + 1;
+    }
+  }
+
+  return intervals;
+}
+
+}  // namespace topology
+}  // namespace hydra
@@ -37,6 +37,13 @@
 
 #include <nanoflann.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <list>
+#include <numeric>
+#include <thread>
+
 namespace hydra {
 namespace topology {
 
@@ -108,6 +115,126 @@ void NearestNodeFinder::find(const Eigen::Vector3d& position,
   }
 }
 
+namespace {
+
+// queries are handed to threads in chunks of neighboring positions
+const size_t kQueryChunkSize = 32;
+
+inline uint32_t spreadBits(uint32_t value) {
+  // spread the lower 10 bits so that there are two zeros between each bit
+  value &= 0x3ff;
+  value = (value | (value << 16)) & 0x30000ff;
+  value = (value | (value << 8)) & 0x300f00f;
+  value = (value | (value << 4)) & 0x30c30c3;
+  value = (value | (value << 2)) & 0x9249249;
+  return value;
+}
+
+std::vector<size_t> getLocalityOrder(const std::vector<Eigen::Vector3d>& positions) {
+  std::vector<size_t> order(positions.size());
+  std::iota(order.begin(), order.end(), 0);
+  if (positions.size() <= 1) {
+    return order;
+  }
+
+  Eigen::Vector3d min = positions.front();
+  Eigen::Vector3d max = positions.front();
+  for (const auto& pos : positions) {
+    min = min.cwiseMin(pos);
+    max = max.cwiseMax(pos);
+  }
+
+  // morton order over a 1024^3 grid spanning the queries
+  const double extent = std::max((max - min).maxCoeff(), 1.0e-9);
+  const double scale = 1023.0 / extent;
+  std::vector<uint32_t> codes(positions.size());
+  for (size_t i = 0; i < positions.size(); ++i) {
+    const Eigen::Vector3d cell = (positions[i] - min) * scale;
+    codes[i] = spreadBits(static_cast<uint32_t>(cell.x())) |
+               (spreadBits(static_cast<uint32_t>(cell.y())) << 1) |
+               (spreadBits(static_cast<uint32_t>(cell.z())) << 2);
+  }
+
+  std::sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+    return codes[lhs] < codes[rhs];
+  });
+  return order;
+}
+
+}  // namespace
+
+NearestNodeMatches NearestNodeFinder::findBatch(
+    const std::vector<Eigen::Vector3d>& positions,
+    size_t num_to_find,
+    double max_distance_m,
+    size_t num_threads) const {
+  const size_t num_queries = positions.size();
+  NearestNodeMatches matches;
+  matches.offsets.resize(num_queries + 1, 0);
+  if (num_to_find == 0 || internals_->adaptor.nodes.empty()) {
+    return matches;
+  }
+
+  // every query owns a fixed range of the raw results, so threads never share outputs
+  std::vector<size_t> num_found(num_queries, 0);
+  std::vector<size_t> nn_indices(num_queries * num_to_find);
+  std::vector<double> distances(num_queries * num_to_find);
+  const auto& kdtree = *internals_->kdtree;
+  const auto search = [&](size_t query) {
+    const size_t offset = query * num_to_find;
+    num_found[query] = kdtree.knnSearch(positions[query].data(),
+                                        num_to_find,
+                                        nn_indices.data() + offset,
+                                        distances.data() + offset);
+  };
+
+  const std::vector<size_t> order = getLocalityOrder(positions);
+  const size_t num_chunks = (num_queries + kQueryChunkSize - 1) / kQueryChunkSize;
+  const size_t threads_to_use = std::min(num_threads, num_chunks);
+  if (threads_to_use <= 1) {
+    for (const auto query : order) {
+      search(query);
+    }
+  } else {
+    std::atomic<size_t> next_chunk(0);
+    std::list<std::thread> threads;
+    for (size_t i = 0; i < threads_to_use; ++i) {
+      threads.emplace_back([&]() {
+        size_t chunk;
+        while ((chunk = next_chunk.fetch_add(1)) < num_chunks) {
+          const size_t end = std::min(num_queries, (chunk + 1) * kQueryChunkSize);
+          for (size_t j = chunk * kQueryChunkSize; j < end; ++j) {
+            search(order[j]);
+          }
+        }
+      });
+    }
+
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+  }
+
+  // results are sorted by distance, so the radius check can stop early
+  const double max_distance_sq = max_distance_m * max_distance_m;
+  for (size_t query = 0; query < num_queries; ++query) {
+    const size_t offset = query * num_to_find;
+    for (size_t i = 0; i < num_found[query]; ++i) {
+      const double distance_sq = distances[offset + i];
+      if (max_distance_m > 0.0 && distance_sq > max_distance_sq) {
+        break;
+      }
+
+      matches.nodes.push_back(internals_->adaptor.nodes[nn_indices[offset + i]]);
+      matches.distances.push_back(std::sqrt(distance_sq));
+    }
+
+    matches.offsets[query + 1] = matches.nodes.size();
+  }
+
+  return matches;
+}
+
 struct VoxelKdTreeAdaptor {
   explicit VoxelKdTreeAdaptor(const GlobalIndexVector& indices) : indices(indices) {}
 
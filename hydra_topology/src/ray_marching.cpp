@@ -0,0 +1,75 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_topology/ray_marching.h"
+
+namespace hydra {
+namespace topology {
+
+voxblox::AlignedVector<GlobalIndex> makeVoxelLine(const GlobalIndex& start,
+                                                  const GlobalIndex& end) {
+  voxblox::AlignedVector<GlobalIndex> indices;
+  walkVoxelLine(start, end, [&](const GlobalIndex& index) {
+    indices.push_back(index);
+    return 0.0;
+  });
+  return indices;
+}
+
+GvdRayMarcher::GvdRayMarcher(const Layer<GvdVoxel>& layer)
+    : layer_(layer),
+      voxels_per_side_(static_cast<int>(layer.voxels_per_side())),
+      voxels_per_side_inv_(1.0f / static_cast<FloatingPoint>(layer.voxels_per_side())),
+      voxel_size_inv_(1.0 / layer.voxel_size()),
+      has_block_(false) {}
+
+const GvdVoxel* GvdRayMarcher::getVoxel(const GlobalIndex& index) {
+  const BlockIndex block_index =
+      voxblox::getBlockIndexFromGlobalVoxelIndex(index, voxels_per_side_inv_);
+  if (!has_block_ || block_index != block_index_) {
+    block_ = layer_.getBlockPtrByIndex(block_index);
+    block_index_ = block_index;
+    has_block_ = true;
+  }
+
+  if (!block_) {
+    return nullptr;
+  }
+
+  return &block_->getVoxelByVoxelIndex(
+      voxblox::getLocalFromGlobalVoxelIndex(index, voxels_per_side_));
+}
+
+}  // namespace topology
+}  // namespace hydra
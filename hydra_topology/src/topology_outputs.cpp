@@ -0,0 +1,428 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_topology/topology_outputs.h"
+
+#include <glog/logging.h>
+
+#include <array>
+#include <map>
+#include <set>
+
+namespace hydra {
+namespace topology {
+
+using BlockKey = std::array<int64_t, 3>;
+
+inline EdgeEndpoints sortedEndpoints(NodeId source, NodeId target) {
+  return {std::min(source, target), std::max(source, target)};
+}
+
+inline BlockKey getBlockKey(const voxblox_msgs::MeshBlock& block) {
+  return {block.index[0], block.index[1], block.index[2]};
+}
+
+void ActivePlacesUpdate::mergeInto(DynamicSceneGraph& graph) const {
+  for (const auto& id_node_pair : layer.nodes()) {
+    const auto& attrs = id_node_pair.second->attributes<PlaceNodeAttributes>();
+    if (!graph.hasNode(id_node_pair.first)) {
+      graph.emplaceNode(DsgLayers::PLACES, id_node_pair.first, attrs.clone());
+      continue;
+    }
+
+    graph.getNode(id_node_pair.first)
+        .value()
+        .get()
+        .attributes<PlaceNodeAttributes>() = attrs;
+  }
+
+  for (const auto& id_edge_pair : edges) {
+    const auto& edge = id_edge_pair.second;
+    if (graph.hasEdge(edge.source, edge.target)) {
+      *graph.getEdge(edge.source, edge.target).value().get().info = *edge.info;
+      continue;
+    }
+
+    graph.insertEdge(edge.source, edge.target, edge.info->clone());
+  }
+}
+
+ActivePlacesUpdate::Ptr makeActivePlacesUpdate(
+    uint64_t timestamp_ns,
+    const SceneGraphLayer& graph,
+    const std::unordered_set<NodeId>& active_nodes,
+    const std::unordered_set<NodeId>& deleted_nodes) {
+  auto update = std::make_shared<ActivePlacesUpdate>();
+  update->timestamp_ns = timestamp_ns;
+  update->deleted_nodes.insert(
+      update->deleted_nodes.end(), deleted_nodes.begin(), deleted_nodes.end());
+
+  size_t edge_index = 0;
+  for (const auto& node_id : active_nodes) {
+    const SceneGraphNode& node = graph.getNode(node_id).value();
+    update->layer.emplaceNode(node_id, node.attributes().clone());
+
+    for (const auto& sibling : node.siblings()) {
+      if (active_nodes.count(sibling) && sibling < node_id) {
+        continue;  // already added from the other endpoint
+      }
+
+      const SceneGraphEdge& edge = graph.getEdge(node_id, sibling).value();
+      update->edges.emplace(
+          std::piecewise_construct,
+          std::forward_as_tuple(edge_index),
+          std::forward_as_tuple(edge.source, edge.target, edge.info->clone()));
+      ++edge_index;
+    }
+  }
+
+  VLOG(3) << "[Topology Outputs] " << update->layer.numNodes() << " active places, "
+          << update->edges.size() << " edges";
+  return update;
+}
+
+ActivePlacesUpdate::Ptr makeActivePlacesDelta(
+    uint64_t timestamp_ns,
+    const SceneGraphLayer& graph,
+    const GraphChanges& changes,
+    const std::unordered_set<NodeId>& deleted_nodes) {
+  auto update = std::make_shared<ActivePlacesUpdate>();
+  update->timestamp_ns = timestamp_ns;
+  update->is_full_update = false;
+  update->deleted_nodes.insert(
+      update->deleted_nodes.end(), deleted_nodes.begin(), deleted_nodes.end());
+
+  for (const auto& node_id : changes.modified_nodes) {
+    if (!graph.hasNode(node_id)) {
+      continue;
+    }
+
+    const SceneGraphNode& node = graph.getNode(node_id).value();
+    update->layer.emplaceNode(node_id, node.attributes().clone());
+  }
+
+  size_t edge_index = 0;
+  for (const auto& endpoints : changes.inserted_edges) {
+    // edges are implicitly removed with their nodes
+    if (!graph.hasEdge(endpoints.first, endpoints.second)) {
+      continue;
+    }
+
+    const SceneGraphEdge& edge =
+        graph.getEdge(endpoints.first, endpoints.second).value();
+    update->edges.emplace(
+        std::piecewise_construct,
+        std::forward_as_tuple(edge_index),
+        std::forward_as_tuple(edge.source, edge.target, edge.info->clone()));
+    ++edge_index;
+  }
+
+  addRemovedElements(graph, changes, *update);
+
+  VLOG(3) << "[Topology Outputs] " << update->layer.numNodes() << " changed places, "
+          << update->edges.size() << " new edges, " << update->removed_edges.size()
+          << " removed edges";
+  return update;
+}
+
+void addRemovedElements(const SceneGraphLayer& graph,
+                        const GraphChanges& changes,
+                        ActivePlacesUpdate& update) {
+  update.archived_nodes.insert(update.archived_nodes.end(),
+                               changes.archived_nodes.begin(),
+                               changes.archived_nodes.end());
+
+  for (const auto& endpoints : changes.removed_edges) {
+    if (!graph.hasNode(endpoints.first) || !graph.hasNode(endpoints.second)) {
+      continue;  // removed alongside the node
+    }
+
+    update.removed_edges.push_back(endpoints);
+  }
+}
+
+StalePlaces findStalePlaces(const SceneGraphLayer& graph,
+                            const std::unordered_set<NodeId>& active_nodes,
+                            const ActivePlacesUpdate& update) {
+  StalePlaces stale;
+  if (!update.is_full_update) {
+    return stale;  // partial updates only describe what changed
+  }
+
+  std::set<NodeId> removed(update.deleted_nodes.begin(), update.deleted_nodes.end());
+  removed.insert(update.archived_nodes.begin(), update.archived_nodes.end());
+  for (const auto& node_id : active_nodes) {
+    if (!update.layer.hasNode(node_id) && !removed.count(node_id) &&
+        graph.hasNode(node_id)) {
+      stale.nodes.push_back(node_id);
+    }
+  }
+
+  std::set<EdgeEndpoints> sent_edges;
+  for (const auto& id_edge_pair : update.edges) {
+    const auto& edge = id_edge_pair.second;
+    sent_edges.insert(sortedEndpoints(edge.source, edge.target));
+  }
+
+  // full updates contain every edge that touches a sent place
+  for (const auto& id_node_pair : update.layer.nodes()) {
+    const NodeId node_id = id_node_pair.first;
+    if (!graph.hasNode(node_id)) {
+      continue;
+    }
+
+    for (const auto& sibling : graph.getNode(node_id).value().get().siblings()) {
+      if (update.layer.hasNode(sibling) && sibling < node_id) {
+        continue;  // already checked from the other endpoint
+      }
+
+      const auto endpoints = sortedEndpoints(node_id, sibling);
+      if (!sent_edges.count(endpoints)) {
+        stale.edges.push_back(endpoints);
+      }
+    }
+  }
+
+  return stale;
+}
+
+ActivePlacesUpdate::Ptr mergeActivePlacesUpdates(
+    const std::vector<ActivePlacesUpdate::ConstPtr>& updates) {
+  CHECK(!updates.empty());
+
+  // newest version of every place and edge (owned by the updates)
+  std::map<NodeId, const NodeAttributes*> nodes;
+  std::map<EdgeEndpoints, const SceneGraphEdge*> edges;
+  std::set<NodeId> deleted;
+  std::set<NodeId> archived;
+  std::set<EdgeEndpoints> removed_edges;
+
+  auto merged = std::make_shared<ActivePlacesUpdate>();
+  merged->is_full_update = false;
+  merged->num_merged = 0;
+  // same order as applying the update: removals before insertions
+  for (const auto& update : updates) {
+    for (const auto& node_id : update->deleted_nodes) {
+      nodes.erase(node_id);
+      archived.erase(node_id);
+      deleted.insert(node_id);
+    }
+
+    for (const auto& endpoints : update->removed_edges) {
+      const auto key = sortedEndpoints(endpoints.first, endpoints.second);
+      edges.erase(key);
+      removed_edges.insert(key);
+    }
+
+    if (update->is_full_update) {
+      // pending places that are missing from a full update are no longer active
+      for (const auto& id_attrs_pair : nodes) {
+        archived.insert(id_attrs_pair.first);
+      }
+      merged->is_full_update = true;
+    }
+
+    archived.insert(update->archived_nodes.begin(), update->archived_nodes.end());
+
+    for (const auto& id_node_pair : update->layer.nodes()) {
+      nodes[id_node_pair.first] = &id_node_pair.second->attributes();
+      archived.erase(id_node_pair.first);
+    }
+
+    for (const auto& id_edge_pair : update->edges) {
+      const auto& edge = id_edge_pair.second;
+      edges[sortedEndpoints(edge.source, edge.target)] = &edge;
+    }
+
+    merged->num_merged += update->num_merged;
+  }
+
+  merged->timestamp_ns = updates.back()->timestamp_ns;
+  merged->sequence_number = updates.back()->sequence_number;
+  for (const auto& id_attrs_pair : nodes) {
+    merged->layer.emplaceNode(id_attrs_pair.first, id_attrs_pair.second->clone());
+  }
+
+  size_t edge_index = 0;
+  for (const auto& endpoints_edge_pair : edges) {
+    const auto& endpoints = endpoints_edge_pair.first;
+    const bool source_deleted =
+        deleted.count(endpoints.first) && !nodes.count(endpoints.first);
+    const bool target_deleted =
+        deleted.count(endpoints.second) && !nodes.count(endpoints.second);
+    if (source_deleted || target_deleted) {
+      continue;  // edges are implicitly removed with their nodes
+    }
+
+    const SceneGraphEdge& edge = *endpoints_edge_pair.second;
+    merged->edges.emplace(
+        std::piecewise_construct,
+        std::forward_as_tuple(edge_index),
+        std::forward_as_tuple(edge.source, edge.target, edge.info->clone()));
+    ++edge_index;
+  }
+
+  merged->deleted_nodes.assign(deleted.begin(), deleted.end());
+  merged->archived_nodes.assign(archived.begin(), archived.end());
+  merged->removed_edges.assign(removed_edges.begin(), removed_edges.end());
+  return merged;
+}
+
+size_t estimateMemoryUsage(const ActivePlacesUpdate& update) {
+  size_t bytes = sizeof(ActivePlacesUpdate);
+  for (const auto& id_node_pair : update.layer.nodes()) {
+    bytes += sizeof(PlaceNodeAttributes);
+    const auto attrs =
+        dynamic_cast<const PlaceNodeAttributes*>(&id_node_pair.second->attributes());
+    if (attrs) {
+      bytes += attrs->voxblox_mesh_connections.size() * sizeof(NearestVertexInfo);
+    }
+  }
+
+  bytes += update.edges.size() * (sizeof(SceneGraphEdge) + sizeof(EdgeAttributes));
+  const size_t num_removed = update.deleted_nodes.size() + update.archived_nodes.size();
+  bytes += num_removed * sizeof(NodeId);
+  bytes += update.removed_edges.size() * sizeof(EdgeEndpoints);
+  return bytes;
+}
+
+voxblox_msgs::Mesh::ConstPtr ActiveMeshUpdate::getMesh() const {
+  if (merged_blocks.empty()) {
+    return mesh;
+  }
+
+  voxblox_msgs::Mesh::Ptr full_mesh(new voxblox_msgs::Mesh());
+  if (mesh) {
+    full_mesh->header = mesh->header;
+    full_mesh->block_edge_length = mesh->block_edge_length;
+  }
+
+  full_mesh->mesh_blocks.reserve(merged_blocks.size());
+  for (const auto& block : merged_blocks) {
+    full_mesh->mesh_blocks.push_back(block.get());
+  }
+
+  return full_mesh;
+}
+
+ActiveMeshUpdate::Ptr mergeActiveMeshUpdates(
+    const std::vector<ActiveMeshUpdate::ConstPtr>& updates) {
+  CHECK(!updates.empty());
+
+  // newest version of every block (in the messages of the updates)
+  std::map<BlockKey, ActiveMeshUpdate::BlockRef> blocks;
+  std::set<BlockKey> archived;
+  float block_edge_length = 0.0f;
+  std_msgs::Header header;
+  for (const auto& update : updates) {
+    for (const auto& block : update->merged_blocks) {
+      const auto key = getBlockKey(block.get());
+      blocks[key] = block;
+      archived.erase(key);
+    }
+
+    if (update->mesh) {
+      header = update->mesh->header;
+      block_edge_length = update->mesh->block_edge_length;
+      const auto& mesh_blocks = update->mesh->mesh_blocks;
+      for (size_t i = 0; i < mesh_blocks.size(); ++i) {
+        const auto key = getBlockKey(mesh_blocks[i]);
+        blocks[key] = {update->mesh, i};
+        archived.erase(key);
+      }
+    }
+
+    if (update->archived_blocks) {
+      for (const auto& block : update->archived_blocks->mesh_blocks) {
+        archived.insert(getBlockKey(block));
+      }
+    }
+  }
+
+  auto merged = std::make_shared<ActiveMeshUpdate>();
+  merged->timestamp_ns = updates.back()->timestamp_ns;
+
+  voxblox_msgs::Mesh::Ptr mesh(new voxblox_msgs::Mesh());
+  mesh->header = header;
+  mesh->block_edge_length = block_edge_length;
+  merged->mesh = mesh;
+  merged->merged_blocks.reserve(blocks.size());
+  for (const auto& key_block_pair : blocks) {
+    merged->merged_blocks.push_back(key_block_pair.second);
+  }
+
+  voxblox_msgs::Mesh::Ptr archived_blocks(new voxblox_msgs::Mesh());
+  archived_blocks->header = header;
+  archived_blocks->block_edge_length = block_edge_length;
+  archived_blocks->mesh_blocks.resize(archived.size());
+  size_t i = 0;
+  for (const auto& key : archived) {
+    auto& block = archived_blocks->mesh_blocks[i];
+    block.index[0] = key[0];
+    block.index[1] = key[1];
+    block.index[2] = key[2];
+    ++i;
+  }
+  merged->archived_blocks = archived_blocks;
+
+  return merged;
+}
+
+size_t estimateMemoryUsage(const ActiveMeshUpdate& update) {
+  // a referenced block keeps every other block of its message alive
+  std::set<const voxblox_msgs::Mesh*> messages{update.mesh.get(),
+                                               update.archived_blocks.get()};
+  for (const auto& block : update.merged_blocks) {
+    messages.insert(block.source.get());
+  }
+
+  size_t bytes = sizeof(ActiveMeshUpdate);
+  bytes += update.merged_blocks.size() * sizeof(ActiveMeshUpdate::BlockRef);
+  for (const auto mesh : messages) {
+    if (!mesh) {
+      continue;
+    }
+
+    for (const auto& block : mesh->mesh_blocks) {
+      bytes += sizeof(voxblox_msgs::MeshBlock);
+      bytes += (block.x.size() + block.y.size() + block.z.size()) * sizeof(uint16_t);
+      bytes += block.r.size() + block.g.size() + block.b.size();
+    }
+  }
+
+  return bytes;
+}
+
+}  // namespace topology
+}  // namespace hydra
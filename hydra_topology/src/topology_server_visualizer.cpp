@@ -33,6 +33,12 @@
  * purposes notwithstanding any copyright notation herein.
  * -------------------------------------------------------------------------- */
 #include "hydra_topology/topology_server_visualizer.h"
+#include "hydra_topology/gvd_utilities.h"
+
+#include <glog/logging.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 
 namespace hydra {
 namespace topology {
@@ -40,7 +46,36 @@ namespace topology {
 using visualization_msgs::Marker;
 using visualization_msgs::MarkerArray;
 
-TopologyServerVisualizer::TopologyServerVisualizer(const std::string& ns) : nh_(ns) {
+void TopologyVisualizerSnapshot::merge(TopologyVisualizerSnapshot&& newer) {
+  if (newer.full_update) {
+    *this = std::move(newer);
+    return;
+  }
+
+  for (const auto& idx : newer.archived_blocks) {
+    gvd_blocks.erase(idx);
+    archived_blocks.push_back(idx);
+  }
+
+  for (auto& idx_block_pair : newer.gvd_blocks) {
+    gvd_blocks[idx_block_pair.first] = std::move(idx_block_pair.second);
+  }
+
+  outline_blocks = std::move(newer.outline_blocks);
+  use_gvd_outlines = newer.use_gvd_outlines;
+  graph = std::move(newer.graph);
+  edge_info = std::move(newer.edge_info);
+  root_map = std::move(newer.root_map);
+}
+
+TopologyServerVisualizer::TopologyServerVisualizer(const std::string& ns,
+                                                   size_t dirty_block_padding)
+    : nh_(ns),
+      dirty_block_padding_(dirty_block_padding),
+      needs_full_update_(true),
+      last_snapshot_ns_(0),
+      have_snapshot_(false),
+      should_shutdown_(false) {
   gvd_viz_pub_ = nh_.advertise<Marker>("gvd_viz", 1, true);
   gvd_edge_viz_pub_ = nh_.advertise<Marker>("gvd_edge_viz", 1, true);
   graph_viz_pub_ = nh_.advertise<MarkerArray>("graph_viz", 1, true);
@@ -54,38 +89,228 @@ TopologyServerVisualizer::TopologyServerVisualizer(const std::string& ns) : nh_(
   setupConfigServers();
 }
 
-void TopologyServerVisualizer::visualize(const GraphExtractor& extractor,
-                                         const SceneGraphLayer& graph,
-                                         const Layer<GvdVoxel>& gvd,
-                                         const Layer<TsdfVoxel>& tsdf) {
-  visualizeGraph(graph);
-  visualizeGvd(gvd);
-  visualizeGvdEdges(extractor, gvd);
-  if (config_.show_block_outlines) {
-    visualizeBlocks(gvd, tsdf);
+TopologyServerVisualizer::~TopologyServerVisualizer() { stop(); }
+
+void TopologyServerVisualizer::start() {
+  if (spin_thread_) {
+    return;
+  }
+
+  should_shutdown_ = false;
+  spin_thread_.reset(new std::thread(&TopologyServerVisualizer::spin, this));
+}
+
+void TopologyServerVisualizer::stop() {
+  if (!spin_thread_) {
+    return;
+  }
+
+  should_shutdown_ = true;
+  snapshot_cv_.notify_all();
+  spin_thread_->join();
+  spin_thread_.reset();
+}
+
+TopologyVisualizerConfig TopologyServerVisualizer::getConfig() const {
+  std::unique_lock<std::mutex> lock(config_mutex_);
+  return config_;
+}
+
+void TopologyServerVisualizer::markDirtyBlocks(const Layer<GvdVoxel>& gvd,
+                                               const BlockIndexList& updated_blocks,
+                                               const BlockIndexList& archived_blocks) {
+  const int padding = dirty_block_padding_;
+  for (const auto& idx : updated_blocks) {
+    for (int x = -padding; x <= padding; ++x) {
+      for (int y = -padding; y <= padding; ++y) {
+        for (int z = -padding; z <= padding; ++z) {
+          const BlockIndex neighbor = idx + BlockIndex(x, y, z);
+          if (gvd.hasBlock(neighbor)) {
+            dirty_blocks_.insert(neighbor);
+          }
+        }
+      }
+    }
+  }
+
+  for (const auto& idx : archived_blocks) {
+    dirty_blocks_.erase(idx);
+    archived_blocks_.push_back(idx);
+  }
+}
+
+TopologyVisualizerSnapshot::Ptr TopologyServerVisualizer::makeSnapshot(
+    const TopologyVisualizerConfig& config,
+    const GraphExtractor& extractor,
+    const Layer<GvdVoxel>& gvd,
+    const Layer<TsdfVoxel>* tsdf) {
+  auto snapshot = std::make_unique<TopologyVisualizerSnapshot>();
+  snapshot->voxel_size = gvd.voxel_size();
+  snapshot->voxels_per_side = gvd.voxels_per_side();
+
+  const bool show_blocks = config.show_block_outlines &&
+                           block_viz_pub_.getNumSubscribers() > 0;
+  const bool use_gvd_outlines = config.use_gvd_block_outlines || !tsdf;
+  const bool need_gvd =
+      gvd_viz_pub_.getNumSubscribers() > 0 || (show_blocks && use_gvd_outlines);
+  if (!need_gvd) {
+    // nobody needs the mirror to be up to date: resync from scratch when they do
+    dirty_blocks_.clear();
+    archived_blocks_.clear();
+    needs_full_update_ = true;
+  } else if (needs_full_update_) {
+    BlockIndexList blocks;
+    gvd.getAllAllocatedBlocks(&blocks);
+    for (const auto& idx : blocks) {
+      snapshot->gvd_blocks[idx] = copyGvdBlock(gvd.getBlockByIndex(idx));
+    }
+
+    snapshot->full_update = true;
+    dirty_blocks_.clear();
+    archived_blocks_.clear();
+    needs_full_update_ = false;
+  } else {
+    for (const auto& idx : dirty_blocks_) {
+      const auto block = gvd.getBlockPtrByIndex(idx);
+      if (block) {
+        snapshot->gvd_blocks[idx] = copyGvdBlock(*block);
+      }
+    }
+
+    snapshot->archived_blocks = archived_blocks_;
+    dirty_blocks_.clear();
+    archived_blocks_.clear();
+  }
+
+  snapshot->use_gvd_outlines = use_gvd_outlines;
+  if (show_blocks && !use_gvd_outlines) {
+    tsdf->getAllAllocatedBlocks(&snapshot->outline_blocks);
+  }
+
+  if (graph_viz_pub_.getNumSubscribers() > 0 ||
+      (config.graph_layer.use_label && label_viz_pub_.getNumSubscribers() > 0)) {
+    snapshot->graph = extractor.getGraphSnapshot();
+  }
+
+  if (gvd_edge_viz_pub_.getNumSubscribers() > 0) {
+    snapshot->edge_info.reset(
+        new GraphExtractor::EdgeInfoMap(extractor.getGvdEdgeInfo()));
+    snapshot->root_map.reset(
+        new GraphExtractor::NodeIdRootMap(extractor.getNodeRootMap()));
+  }
+
+  return snapshot;
+}
+
+void TopologyServerVisualizer::update(uint64_t timestamp_ns,
+                                      const GraphExtractor& extractor,
+                                      const Layer<GvdVoxel>& gvd,
+                                      const Layer<TsdfVoxel>* tsdf,
+                                      const BlockIndexList& updated_blocks,
+                                      const BlockIndexList& archived_blocks) {
+  if (!needs_full_update_) {
+    markDirtyBlocks(gvd, updated_blocks, archived_blocks);
+  }
+
+  const TopologyVisualizerConfig config = getConfig();
+  const uint64_t period_ns = config.visualization_period_s * 1.0e9;
+  if (have_snapshot_ && timestamp_ns < last_snapshot_ns_ + period_ns) {
+    return;
+  }
+
+  last_snapshot_ns_ = timestamp_ns;
+  have_snapshot_ = true;
+
+  auto snapshot = makeSnapshot(config, extractor, gvd, tsdf);
+
+  {  // start snapshot critical section
+    std::unique_lock<std::mutex> lock(snapshot_mutex_);
+    if (pending_snapshot_) {
+      // the visualization thread is behind: fold the changes into the pending update
+      pending_snapshot_->merge(std::move(*snapshot));
+    } else {
+      pending_snapshot_ = std::move(snapshot);
+    }
+  }  // end snapshot critical section
+
+  snapshot_cv_.notify_one();
+}
+
+void TopologyServerVisualizer::spin() {
+  // visualization is best-effort: let the scheduler favor the update threads
+  if (setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 10) != 0) {
+    LOG(WARNING) << "[Topology Visualizer] unable to lower thread priority";
+  }
+
+  while (!should_shutdown_) {
+    TopologyVisualizerSnapshot::Ptr snapshot;
+    {  // start snapshot critical section
+      std::unique_lock<std::mutex> lock(snapshot_mutex_);
+      snapshot_cv_.wait(lock, [&] { return should_shutdown_ || pending_snapshot_; });
+      snapshot = std::move(pending_snapshot_);
+    }  // end snapshot critical section
+
+    if (!snapshot) {
+      continue;
+    }
+
+    visualize(*snapshot);
+  }
+}
+
+void TopologyServerVisualizer::visualize(TopologyVisualizerSnapshot& snapshot) {
+  if (!gvd_ || snapshot.full_update) {
+    gvd_.reset(new Layer<GvdVoxel>(snapshot.voxel_size, snapshot.voxels_per_side));
+  }
+
+  for (const auto& idx : snapshot.archived_blocks) {
+    gvd_->removeBlock(idx);
+  }
+
+  for (const auto& idx_block_pair : snapshot.gvd_blocks) {
+    gvd_->removeBlock(idx_block_pair.first);
+    gvd_->insertBlock(idx_block_pair);
+  }
+
+  const TopologyVisualizerConfig config = getConfig();
+  if (snapshot.graph) {
+    visualizeGraph(config, *snapshot.graph);
+  }
+
+  if (gvd_viz_pub_.getNumSubscribers() > 0) {
+    visualizeGvd(config, *gvd_);
+  }
+
+  if (snapshot.edge_info && snapshot.root_map) {
+    visualizeGvdEdges(config, snapshot, *gvd_);
+  }
+
+  if (config.show_block_outlines) {
+    visualizeBlocks(config, snapshot, *gvd_);
   }
 }
 
-void TopologyServerVisualizer::visualizeGraph(const SceneGraphLayer& graph) {
+void TopologyServerVisualizer::visualizeGraph(const TopologyVisualizerConfig& config,
+                                              const SceneGraphLayer& graph) {
   if (graph.nodes().empty()) {
     return;
   }
 
   std_msgs::Header header;
   header.stamp = ros::Time::now();
-  header.frame_id = config_.world_frame;
+  header.frame_id = config.world_frame;
 
   MarkerArray markers;
 
   Marker node_marker;
 
-  const std::string node_ns = config_.topology_marker_ns + "_nodes";
-  if (config_.gvd.color_nearest_vertices) {
+  const std::string node_ns = config.topology_marker_ns + "_nodes";
+  if (config.gvd.color_nearest_vertices) {
     node_marker = makeCentroidMarkers(
         header,
-        config_.graph_layer,
+        config.graph_layer,
         graph,
-        config_.graph,
+        config.graph,
         node_ns,
         [](const SceneGraphNode& node) {
           if (node.attributes<PlaceNodeAttributes>().voxblox_mesh_connections.empty()) {
@@ -96,34 +321,35 @@ void TopologyServerVisualizer::visualizeGraph(const SceneGraphLayer& graph) {
         });
   } else {
     node_marker = makeCentroidMarkers(
-        header, config_.graph_layer, graph, config_.graph, node_ns, config_.colormap);
+        header, config.graph_layer, graph, config.graph, node_ns, config.colormap);
   }
 
   markers.markers.push_back(node_marker);
 
   if (!graph.edges().empty()) {
     Marker edge_marker = makeLayerEdgeMarkers(header,
-                                              config_.graph_layer,
+                                              config.graph_layer,
                                               graph,
-                                              config_.graph,
+                                              config.graph,
                                               NodeColor::Zero(),
-                                              config_.topology_marker_ns + "_edges");
+                                              config.topology_marker_ns + "_edges");
     markers.markers.push_back(edge_marker);
   }
 
-  publishGraphLabels(graph);
+  publishGraphLabels(config, graph);
   graph_viz_pub_.publish(markers);
 }
 
-void TopologyServerVisualizer::visualizeGvd(const Layer<GvdVoxel>& gvd) const {
+void TopologyServerVisualizer::visualizeGvd(const TopologyVisualizerConfig& config,
+                                            const Layer<GvdVoxel>& gvd) const {
   Marker msg;
 
-  switch (static_cast<VisualizationType>(config_.gvd.visualization_type)) {
+  switch (static_cast<VisualizationType>(config.gvd.visualization_type)) {
     case VisualizationType::ESDF_WITH_SLICE:
-      msg = makeEsdfMarker(config_.gvd, config_.colormap, gvd);
+      msg = makeEsdfMarker(config.gvd, config.colormap, gvd);
       break;
     case VisualizationType::GVD:
-      msg = makeGvdMarker(config_.gvd, config_.colormap, gvd);
+      msg = makeGvdMarker(config.gvd, config.colormap, gvd);
       break;
     case VisualizationType::NONE:
     default:
@@ -134,51 +360,57 @@ void TopologyServerVisualizer::visualizeGvd(const Layer<GvdVoxel>& gvd) const {
     return;
   }
 
-  msg.header.frame_id = config_.world_frame;
+  msg.header.frame_id = config.world_frame;
 
   msg.header.stamp = ros::Time::now();
   msg.ns = "gvd_visualizer";
   gvd_viz_pub_.publish(msg);
 }
 
-void TopologyServerVisualizer::visualizeBlocks(const Layer<GvdVoxel>& gvd,
-                                               const Layer<TsdfVoxel>& tsdf) const {
+void TopologyServerVisualizer::visualizeBlocks(
+    const TopologyVisualizerConfig& config,
+    const TopologyVisualizerSnapshot& snapshot,
+    const Layer<GvdVoxel>& gvd) const {
   Marker msg;
-  if (config_.use_gvd_block_outlines) {
-    msg = makeBlocksMarker(gvd, config_.outline_scale);
+  if (snapshot.use_gvd_outlines) {
+    msg = makeBlocksMarker(gvd, config.outline_scale);
   } else {
-    msg = makeBlocksMarker(tsdf, config_.outline_scale);
+    msg = makeBlocksMarker(
+        snapshot.outline_blocks, gvd.block_size(), config.outline_scale);
   }
 
-  msg.header.frame_id = config_.world_frame;
+  msg.header.frame_id = config.world_frame;
   msg.header.stamp = ros::Time::now();
   msg.ns = "topology_server_blocks";
   block_viz_pub_.publish(msg);
 }
 
-void TopologyServerVisualizer::visualizeGvdEdges(const GraphExtractor& graph,
-                                                 const Layer<GvdVoxel>& gvd) const {
-  auto msg = makeGvdEdgeMarker(gvd, graph.getGvdEdgeInfo(), graph.getNodeRootMap());
-  msg.header.frame_id = config_.world_frame;
+void TopologyServerVisualizer::visualizeGvdEdges(
+    const TopologyVisualizerConfig& config,
+    const TopologyVisualizerSnapshot& snapshot,
+    const Layer<GvdVoxel>& gvd) const {
+  auto msg = makeGvdEdgeMarker(gvd, *snapshot.edge_info, *snapshot.root_map);
+  msg.header.frame_id = config.world_frame;
   msg.header.stamp = ros::Time::now();
   gvd_edge_viz_pub_.publish(msg);
 }
 
-void TopologyServerVisualizer::publishGraphLabels(const SceneGraphLayer& graph) {
-  if (!config_.graph_layer.use_label) {
+void TopologyServerVisualizer::publishGraphLabels(const TopologyVisualizerConfig& config,
+                                                  const SceneGraphLayer& graph) {
+  if (!config.graph_layer.use_label) {
     return;
   }
 
   std_msgs::Header header;
   header.stamp = ros::Time::now();
-  header.frame_id = config_.world_frame;
-  const std::string label_ns = config_.topology_marker_ns + "_labels";
+  header.frame_id = config.world_frame;
+  const std::string label_ns = config.topology_marker_ns + "_labels";
 
   MarkerArray labels;
   for (const auto& id_node_pair : graph.nodes()) {
     const SceneGraphNode& node = *id_node_pair.second;
     Marker label =
-        makeTextMarker(header, config_.graph_layer, node, config_.graph, label_ns);
+        makeTextMarker(header, config.graph_layer, node, config.graph, label_ns);
     labels.markers.push_back(label);
   }
 
@@ -209,14 +441,17 @@ void TopologyServerVisualizer::publishGraphLabels(const SceneGraphLayer& graph)
 }
 
 void TopologyServerVisualizer::graphConfigCb(LayerConfig& config, uint32_t) {
+  std::unique_lock<std::mutex> lock(config_mutex_);
   config_.graph_layer = config;
 }
 
 void TopologyServerVisualizer::colormapCb(ColormapConfig& config, uint32_t) {
+  std::unique_lock<std::mutex> lock(config_mutex_);
   config_.colormap = config;
 }
 
 void TopologyServerVisualizer::gvdConfigCb(GvdVisualizerConfig& config, uint32_t) {
+  std::unique_lock<std::mutex> lock(config_mutex_);
   config_.gvd = config;
   config_.graph.places_colormap_min_distance = config.gvd_min_distance;
   config_.graph.places_colormap_max_distance = config.gvd_max_distance;
@@ -0,0 +1,126 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_topology/update_scheduler.h"
+
+#include <hydra_utils/metric_utilities.h>
+
+#include <glog/logging.h>
+
+#include <algorithm>
+
+namespace hydra {
+namespace topology {
+
+using hydra::metrics::MetricRecorder;
+
+UpdateScheduler::UpdateScheduler(const UpdateSchedulerConfig& config)
+    : config_(config),
+      has_update_(false),
+      last_update_ns_(0),
+      has_cost_(false),
+      cost_s_(0.0) {
+  CHECK_GT(config_.min_period_s, 0.0);
+  CHECK_GT(config_.target_cpu_fraction, 0.0);
+  config_.max_period_s = std::max(config_.max_period_s, config_.min_period_s);
+  config_.urgent_changed_blocks =
+      std::max(config_.urgent_changed_blocks, config_.min_changed_blocks);
+}
+
+double UpdateScheduler::getMinPeriod() const {
+  const double cost_period = cost_s_ / config_.target_cpu_fraction;
+  return std::clamp(cost_period, config_.min_period_s, config_.max_period_s);
+}
+
+double UpdateScheduler::getTargetPeriod(size_t num_changed_blocks) const {
+  if (num_changed_blocks < config_.min_changed_blocks) {
+    return config_.max_period_s;
+  }
+
+  const double min_period = getMinPeriod();
+  if (config_.urgent_changed_blocks == config_.min_changed_blocks) {
+    return min_period;
+  }
+
+  const double change_ratio =
+      static_cast<double>(num_changed_blocks - config_.min_changed_blocks) /
+      (config_.urgent_changed_blocks - config_.min_changed_blocks);
+  const double urgency = std::min(change_ratio, 1.0);
+  return config_.max_period_s - urgency * (config_.max_period_s - min_period);
+}
+
+bool UpdateScheduler::shouldUpdate(uint64_t timestamp_ns, size_t num_changed_blocks) {
+  if (!has_update_) {
+    has_update_ = true;
+    last_update_ns_ = timestamp_ns;
+    return true;
+  }
+
+  const double elapsed_s =
+      timestamp_ns > last_update_ns_ ? (timestamp_ns - last_update_ns_) * 1.0e-9 : 0.0;
+  const double period_s = getTargetPeriod(num_changed_blocks);
+  const bool should_update = elapsed_s >= period_s;
+  VLOG(3) << "[Update Scheduler] changed blocks: " << num_changed_blocks
+          << ", elapsed: " << elapsed_s << " [s], period: " << period_s
+          << " [s] -> " << (should_update ? "update" : "wait");
+
+  auto& recorder = MetricRecorder::instance();
+  recorder.record("topology/scheduler/target_period_s", timestamp_ns, period_s);
+  if (!should_update) {
+    recorder.increment("topology/scheduler/num_skipped", timestamp_ns);
+    return false;
+  }
+
+  recorder.record("topology/scheduler/elapsed_s", timestamp_ns, elapsed_s);
+  recorder.record("topology/scheduler/changed_blocks", timestamp_ns, num_changed_blocks);
+  last_update_ns_ = timestamp_ns;
+  return true;
+}
+
+void UpdateScheduler::recordCost(uint64_t timestamp_ns, double cost_s) {
+  if (!has_cost_) {
+    has_cost_ = true;
+    cost_s_ = cost_s;
+  } else {
+    cost_s_ = config_.cost_alpha * cost_s + (1.0 - config_.cost_alpha) * cost_s_;
+  }
+
+  auto& recorder = MetricRecorder::instance();
+  recorder.record("topology/scheduler/cost_s", timestamp_ns, cost_s);
+  recorder.record("topology/scheduler/cost_estimate_s", timestamp_ns, cost_s_);
+  recorder.record("topology/scheduler/min_period_s", timestamp_ns, getMinPeriod());
+}
+
+}  // namespace topology
+}  // namespace hydra
@@ -0,0 +1,120 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_topology/worker_pool.h"
+
+namespace hydra {
+namespace topology {
+
+WorkerPool::WorkerPool(size_t num_threads)
+    : should_shutdown_(false),
+      batch_(0),
+      num_busy_(0),
+      task_(nullptr),
+      num_tasks_(0),
+      next_task_(0) {
+  for (size_t i = 1; i < num_threads; ++i) {
+    workers_.emplace_back(&WorkerPool::spin, this);
+  }
+}
+
+WorkerPool::~WorkerPool() {
+  {  // start critical section
+    std::unique_lock<std::mutex> lock(mutex_);
+    should_shutdown_ = true;
+  }  // end critical section
+
+  start_cv_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+void WorkerPool::run(size_t num_tasks, const Task& task) {
+  if (workers_.empty() || num_tasks <= 1) {
+    for (size_t i = 0; i < num_tasks; ++i) {
+      task(i);
+    }
+    return;
+  }
+
+  {  // start critical section
+    std::unique_lock<std::mutex> lock(mutex_);
+    task_ = &task;
+    num_tasks_ = num_tasks;
+    next_task_ = 0;
+    num_busy_ = workers_.size();
+    ++batch_;
+  }  // end critical section
+
+  start_cv_.notify_all();
+  work();
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_cv_.wait(lock, [&] { return num_busy_ == 0; });
+  task_ = nullptr;
+}
+
+void WorkerPool::spin() {
+  uint64_t last_batch = 0;
+  while (true) {
+    {  // start critical section
+      std::unique_lock<std::mutex> lock(mutex_);
+      start_cv_.wait(lock, [&] { return should_shutdown_ || batch_ != last_batch; });
+      if (should_shutdown_) {
+        return;
+      }
+
+      last_batch = batch_;
+    }  // end critical section
+
+    work();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    --num_busy_;
+    if (num_busy_ == 0) {
+      done_cv_.notify_one();
+    }
+  }
+}
+
+void WorkerPool::work() {
+  size_t index;
+  while ((index = next_task_.fetch_add(1)) < num_tasks_) {
+    (*task_)(index);
+  }
+}
+
+}  // namespace topology
+}  // namespace hydra
@@ -0,0 +1,152 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+
+#include <hydra_topology/component_tracker.h>
+
+namespace hydra {
+namespace topology {
+
+namespace {
+
+void addNodes(IsolatedSceneGraphLayer& graph, ComponentTracker& tracker, size_t num) {
+  for (size_t i = 0; i < num; ++i) {
+    graph.emplaceNode(i, std::make_unique<NodeAttributes>());
+    tracker.addNode(i);
+  }
+}
+
+void addEdge(IsolatedSceneGraphLayer& graph,
+             ComponentTracker& tracker,
+             NodeId source,
+             NodeId target) {
+  graph.insertEdge(source, target);
+  tracker.addEdge(source, target);
+}
+
+}  // namespace
+
+TEST(ComponentTracker, MergesOnInsertion) {
+  IsolatedSceneGraphLayer graph(1);
+  ComponentTracker tracker;
+  addNodes(graph, tracker, 6);
+  EXPECT_EQ(6u, tracker.numComponents());
+
+  addEdge(graph, tracker, 0, 1);
+  addEdge(graph, tracker, 1, 2);
+  addEdge(graph, tracker, 3, 4);
+  EXPECT_EQ(3u, tracker.numComponents());
+  EXPECT_EQ(tracker.getComponent(0), tracker.getComponent(2));
+  EXPECT_NE(tracker.getComponent(0), tracker.getComponent(3));
+  EXPECT_EQ(3u, tracker.getComponentSize(1));
+  EXPECT_EQ(1u, tracker.getComponentSize(5));
+
+  tracker.clearChanged();
+  EXPECT_FALSE(tracker.hasChanged(0));
+  EXPECT_FALSE(tracker.hasChanged(3));
+
+  // only the merged component is reported
+  addEdge(graph, tracker, 4, 5);
+  EXPECT_FALSE(tracker.hasChanged(0));
+  EXPECT_TRUE(tracker.hasChanged(3));
+  EXPECT_TRUE(tracker.hasChanged(5));
+
+  // edges inside a component don't change it
+  tracker.clearChanged();
+  addEdge(graph, tracker, 0, 2);
+  EXPECT_FALSE(tracker.hasChanged(0));
+
+  // marking a node reports its whole component
+  tracker.markChanged(2);
+  EXPECT_TRUE(tracker.hasChanged(0));
+  EXPECT_FALSE(tracker.hasChanged(3));
+  tracker.markChanged(7);  // unknown nodes are ignored
+}
+
+TEST(ComponentTracker, RebuildsOnRemoval) {
+  IsolatedSceneGraphLayer graph(1);
+  ComponentTracker tracker;
+  addNodes(graph, tracker, 7);
+  addEdge(graph, tracker, 0, 1);
+  addEdge(graph, tracker, 1, 2);
+  addEdge(graph, tracker, 2, 3);
+  addEdge(graph, tracker, 3, 0);
+  addEdge(graph, tracker, 4, 5);
+  addEdge(graph, tracker, 5, 6);
+  tracker.clearChanged();
+
+  // the cycle survives a single edge removal
+  graph.removeEdge(0, 1);
+  tracker.removeEdge(0, 1);
+  tracker.update(graph);
+  EXPECT_EQ(2u, tracker.numComponents());
+  EXPECT_EQ(tracker.getComponent(0), tracker.getComponent(1));
+  EXPECT_TRUE(tracker.hasChanged(0));
+  EXPECT_FALSE(tracker.hasChanged(4));
+
+  // removing the middle of the chain splits it
+  tracker.clearChanged();
+  graph.removeNode(5);
+  tracker.removeNode(5);
+  tracker.update(graph);
+  EXPECT_FALSE(tracker.hasNode(5));
+  EXPECT_EQ(6u, tracker.numNodes());
+  EXPECT_EQ(3u, tracker.numComponents());
+  EXPECT_NE(tracker.getComponent(4), tracker.getComponent(6));
+  EXPECT_TRUE(tracker.hasChanged(4));
+  EXPECT_TRUE(tracker.hasChanged(6));
+  EXPECT_FALSE(tracker.hasChanged(0));
+}
+
+TEST(ComponentTracker, RemovalAfterMerge) {
+  IsolatedSceneGraphLayer graph(1);
+  ComponentTracker tracker;
+  addNodes(graph, tracker, 4);
+  addEdge(graph, tracker, 0, 1);
+
+  // the removal is resolved against the component at update time
+  graph.removeEdge(0, 1);
+  tracker.removeEdge(0, 1);
+  addEdge(graph, tracker, 1, 2);
+  addEdge(graph, tracker, 2, 3);
+  tracker.update(graph);
+
+  EXPECT_EQ(2u, tracker.numComponents());
+  EXPECT_EQ(1u, tracker.getComponentSize(0));
+  EXPECT_EQ(3u, tracker.getComponentSize(3));
+}
+
+}  // namespace topology
+}  // namespace hydra
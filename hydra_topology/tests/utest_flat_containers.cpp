@@ -0,0 +1,166 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+
+#include <hydra_topology/flat_containers.h>
+
+#include <random>
+#include <set>
+#include <string>
+#include <unordered_map>
+
+namespace hydra {
+namespace topology {
+
+TEST(SmallIdSet, InsertEraseSorted) {
+  SmallIdSet<size_t, 2> ids;
+  EXPECT_TRUE(ids.empty());
+
+  EXPECT_TRUE(ids.insert(5).second);
+  EXPECT_TRUE(ids.insert(1).second);
+  EXPECT_FALSE(ids.insert(5).second);
+  EXPECT_EQ(2u, ids.size());
+
+  // spills to the heap
+  EXPECT_TRUE(ids.insert(3).second);
+  EXPECT_TRUE(ids.insert(7).second);
+  EXPECT_EQ(4u, ids.size());
+  EXPECT_EQ(1u, ids.count(3));
+  EXPECT_EQ(0u, ids.count(4));
+
+  std::vector<size_t> expected{1, 3, 5, 7};
+  std::vector<size_t> result(ids.begin(), ids.end());
+  EXPECT_EQ(expected, result);
+
+  EXPECT_EQ(1u, ids.erase(3));
+  EXPECT_EQ(0u, ids.erase(3));
+  expected = {1, 5, 7};
+  result = std::vector<size_t>(ids.begin(), ids.end());
+  EXPECT_EQ(expected, result);
+
+  SmallIdSet<size_t, 2> copy = ids;
+  SmallIdSet<size_t, 2> moved = std::move(ids);
+  EXPECT_TRUE(ids.empty());
+  EXPECT_EQ(3u, copy.size());
+  EXPECT_EQ(3u, moved.size());
+  EXPECT_EQ(1u, moved.count(7));
+
+  moved.clear();
+  EXPECT_TRUE(moved.empty());
+  EXPECT_TRUE(moved.insert(2).second);
+  EXPECT_EQ(1u, moved.count(2));
+}
+
+TEST(SmallIdSet, MatchesStdSet) {
+  SmallIdSet<size_t> ids;
+  std::set<size_t> expected;
+  for (size_t i = 0; i < 200; ++i) {
+    const size_t value = (i * 37) % 23;
+    if (i % 3 == 0) {
+      EXPECT_EQ(expected.erase(value), ids.erase(value));
+    } else {
+      EXPECT_EQ(expected.insert(value).second, ids.insert(value).second);
+    }
+
+    ASSERT_EQ(expected.size(), ids.size());
+    EXPECT_TRUE(std::equal(expected.begin(), expected.end(), ids.begin()));
+  }
+}
+
+TEST(SlotMap, EraseKeepsKeysConsistent) {
+  SlotMap<int, std::string> values;
+  values[1] = "a";
+  values[2] = "b";
+  values[3] = "c";
+  EXPECT_EQ(3u, values.size());
+  EXPECT_EQ("b", values.at(2));
+
+  // erasing from the middle moves the last value into the freed slot
+  EXPECT_EQ(1u, values.erase(1));
+  EXPECT_EQ(0u, values.erase(1));
+  EXPECT_EQ(2u, values.size());
+  EXPECT_EQ(0u, values.count(1));
+  EXPECT_EQ(nullptr, values.find(1));
+  EXPECT_EQ("b", values.at(2));
+  EXPECT_EQ("c", values.at(3));
+
+  for (size_t i = 0; i < values.size(); ++i) {
+    EXPECT_EQ(values.at(values.keys()[i]), values.values()[i]);
+  }
+
+  ASSERT_NE(nullptr, values.find(3));
+  *values.find(3) = "d";
+  EXPECT_EQ("d", values.at(3));
+  EXPECT_THROW(values.at(1), std::out_of_range);
+
+  values.clear();
+  EXPECT_TRUE(values.empty());
+}
+
+TEST(SlotMap, MatchesUnorderedMap) {
+  SlotMap<uint64_t, uint64_t> values;
+  std::unordered_map<uint64_t, uint64_t> expected;
+
+  // sequential keys mixed with strided keys force collisions, probing and rehashing
+  std::mt19937_64 rng(42);
+  for (size_t i = 0; i < 20000; ++i) {
+    const uint64_t key = (i % 2 == 0) ? rng() % 500 : (rng() % 500) << 32;
+    if (rng() % 3 == 0) {
+      EXPECT_EQ(expected.erase(key), values.erase(key));
+    } else {
+      values[key] = i;
+      expected[key] = i;
+    }
+
+    ASSERT_EQ(expected.size(), values.size());
+  }
+
+  for (const auto& key_value_pair : expected) {
+    ASSERT_EQ(1u, values.count(key_value_pair.first));
+    EXPECT_EQ(key_value_pair.second, values.at(key_value_pair.first));
+  }
+
+  for (size_t i = 0; i < values.size(); ++i) {
+    EXPECT_EQ(expected.at(values.keys()[i]), values.values()[i]);
+  }
+
+  values.clear();
+  EXPECT_EQ(0u, values.count(expected.begin()->first));
+  values[7] = 3;
+  EXPECT_EQ(3u, values.at(7));
+}
+
+}  // namespace topology
+}  // namespace hydra
@@ -36,6 +36,8 @@
 
 #include <gtest/gtest.h>
 
+#include <random>
+
 #include <hydra_topology/graph_extraction_utilities.h>
 #include <hydra_topology/voxblox_types.h>
 
@@ -206,6 +208,20 @@ TEST_F(SingleBlockExtractionTestFixture, NeighborhoodExtraction) {
   }
 }
 
+TEST_F(SingleBlockExtractionTestFixture, NeighborhoodExtractionMatchesIndexLookup) {
+  // covers neighborhoods inside the block, on its boundary and outside of it
+  for (int x = -1; x <= voxels_per_side; ++x) {
+    for (int y = -1; y <= voxels_per_side; ++y) {
+      for (int z = -1; z <= voxels_per_side; ++z) {
+        const GlobalIndex index(x, y, z);
+        EXPECT_EQ(extractNeighborhoodFlagsByIndex(*gvd_layer, index),
+                  extractNeighborhoodFlags(*gvd_layer, index))
+            << "index: " << index.transpose();
+      }
+    }
+  }
+}
+
 #define CHECK_TEMPLATE_SOUNDNESS(finder, template_name)                    \
   EXPECT_EQ(2u, finder.template_name.fg_mask.count()) << #template_name;   \
   for (const auto& unused_mask : finder.template_name.unused_mask_array) { \
@@ -295,6 +311,61 @@ TEST(GraphExtractionUtilities, CornerDetectionTemplateCorrect) {
 
 #undef TEST_CORNER_ROTATION
 
+TEST(GraphExtractionUtilities, CornerClassifierMatchesTemplates) {
+  CornerFinder finder;
+  CornerClassifier classifier(finder);
+
+  const std::array<const GvdCornerTemplate*, 6> templates{
+      &finder.negative_x_template,
+      &finder.positive_x_template,
+      &finder.negative_y_template,
+      &finder.positive_y_template,
+      &finder.negative_z_template,
+      &finder.positive_z_template};
+
+  // every assignment of the unused voxels, plus every single-voxel perturbation of
+  // the voxels each rotation cares about
+  for (const auto corner_template : templates) {
+    for (const auto& unused_mask : corner_template->unused_mask_array) {
+      std::vector<size_t> unused_bits;
+      for (size_t i = 0; i < 27; ++i) {
+        if (unused_mask[i]) {
+          unused_bits.push_back(i);
+        }
+      }
+
+      for (size_t combination = 0; combination < (1u << unused_bits.size());
+           ++combination) {
+        std::bitset<27> state = corner_template->fg_mask;
+        for (size_t i = 0; i < unused_bits.size(); ++i) {
+          state.set(unused_bits[i], (combination >> i) & 1);
+        }
+
+        EXPECT_EQ(finder.match(state), classifier.match(state)) << state;
+        for (size_t i = 0; i < 27; ++i) {
+          std::bitset<27> perturbed = state;
+          perturbed.flip(i);
+          EXPECT_EQ(finder.match(perturbed), classifier.match(perturbed))
+              << perturbed;
+        }
+      }
+    }
+  }
+
+  // random neighborhoods over a range of densities
+  std::mt19937 gen(12345);
+  for (double density : {0.1, 0.3, 0.5, 0.7, 0.9}) {
+    std::bernoulli_distribution is_gvd(density);
+    for (size_t i = 0; i < 20000; ++i) {
+      std::bitset<27> state;
+      for (size_t b = 0; b < 27; ++b) {
+        state.set(b, is_gvd(gen));
+      }
+      ASSERT_EQ(finder.match(state), classifier.match(state)) << state;
+    }
+  }
+}
+
 TEST(GraphExtractionUtilities, TestBresenhamLine) {
   {  // x primary axis
     GlobalIndex start(1, 2, 3);
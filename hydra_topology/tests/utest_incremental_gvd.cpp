@@ -370,6 +370,128 @@ TEST_F(LargeSingleBlockTestFixture, LCorrect) {
   }
 }
 
+TEST_F(LargeSingleBlockTestFixture, DeferredExtractionSame) {
+  for (int x = 0; x < voxels_per_side; ++x) {
+    for (int y = 0; y < voxels_per_side; ++y) {
+      for (int z = 0; z < voxels_per_side; ++z) {
+        const bool is_edge = (x == 0) || (y == 0);
+        setTsdfVoxel(x, y, z, is_edge ? 0.0 : truncation_distance);
+      }
+    }
+  }
+
+  Layer<GvdVoxel>::Ptr serial_gvd(new Layer<GvdVoxel>(voxel_size, voxels_per_side));
+  MeshLayer::Ptr serial_mesh(new MeshLayer(voxel_size * voxels_per_side));
+  GvdIntegrator serial_integrator(gvd_config, tsdf_layer.get(), serial_gvd, serial_mesh);
+  serial_integrator.updateFromTsdfLayer(false, true, true);
+
+  GvdIntegrator gvd_integrator(gvd_config, tsdf_layer.get(), gvd_layer, mesh_layer);
+  gvd_integrator.setDeferredExtraction(true);
+  gvd_integrator.updateFromTsdfLayer(true);
+  // nothing is extracted until the frame is handed off
+  EXPECT_EQ(0u, gvd_integrator.getGraphExtractor().getGraph().numNodes());
+
+  auto frame = gvd_integrator.popExtractionFrame();
+  ASSERT_TRUE(frame != nullptr);
+  EXPECT_EQ(1u, frame->gvd_blocks.size());
+  gvd_integrator.extractGraph(*frame);
+
+  const auto& extraction_layer = gvd_integrator.getExtractionLayer();
+  ASSERT_NE(&extraction_layer, gvd_layer.get());
+  for (int x = 0; x < voxels_per_side; ++x) {
+    for (int y = 0; y < voxels_per_side; ++y) {
+      for (int z = 0; z < voxels_per_side; ++z) {
+        const GlobalIndex index(x, y, z);
+        const auto* expected = gvd_layer->getVoxelPtrByGlobalIndex(index);
+        const auto* result = extraction_layer.getVoxelPtrByGlobalIndex(index);
+        ASSERT_TRUE(expected != nullptr);
+        ASSERT_TRUE(result != nullptr);
+        EXPECT_EQ(expected->distance, result->distance);
+        EXPECT_EQ(expected->num_extra_basis, result->num_extra_basis)
+            << " @ (" << x << ", " << y << ", " << z << ")";
+      }
+    }
+  }
+
+  EXPECT_EQ(serial_integrator.getGraphExtractor().getGraph().numNodes(),
+            gvd_integrator.getGraphExtractor().getGraph().numNodes());
+  EXPECT_EQ(serial_integrator.getGraphExtractor().getGraph().numEdges(),
+            gvd_integrator.getGraphExtractor().getGraph().numEdges());
+}
+
+TEST_F(LargeSingleBlockTestFixture, ParallelEdgeSplittingSame) {
+  for (int x = 0; x < voxels_per_side; ++x) {
+    for (int y = 0; y < voxels_per_side; ++y) {
+      for (int z = 0; z < voxels_per_side; ++z) {
+        const bool is_edge = (x == 0) || (y == 0) || (z == 0) || (x + y == 6);
+        setTsdfVoxel(x, y, z, is_edge ? 0.0 : truncation_distance);
+      }
+    }
+  }
+
+  Layer<GvdVoxel>::Ptr serial_gvd(new Layer<GvdVoxel>(voxel_size, voxels_per_side));
+  MeshLayer::Ptr serial_mesh(new MeshLayer(voxel_size * voxels_per_side));
+  GvdIntegrator serial_integrator(gvd_config, tsdf_layer.get(), serial_gvd, serial_mesh);
+  serial_integrator.updateFromTsdfLayer(false, true, true);
+
+  GvdIntegratorConfig parallel_config = gvd_config;
+  parallel_config.graph_extractor_config.edge_splitting_threads = 4;
+  GvdIntegrator gvd_integrator(parallel_config, tsdf_layer.get(), gvd_layer, mesh_layer);
+  gvd_integrator.updateFromTsdfLayer(false, true, true);
+
+  const auto& expected = serial_integrator.getGraphExtractor().getGraph();
+  const auto& result = gvd_integrator.getGraphExtractor().getGraph();
+  ASSERT_EQ(expected.numNodes(), result.numNodes());
+  EXPECT_EQ(expected.numEdges(), result.numEdges());
+  for (const auto& id_node_pair : expected.nodes()) {
+    ASSERT_TRUE(result.hasNode(id_node_pair.first));
+    EXPECT_NEAR(0.0,
+                (expected.getPosition(id_node_pair.first) -
+                 result.getPosition(id_node_pair.first))
+                    .norm(),
+                1.0e-9);
+  }
+
+  for (const auto& id_edge_pair : expected.edges()) {
+    const auto& edge = id_edge_pair.second;
+    EXPECT_TRUE(result.hasEdge(edge.source, edge.target));
+  }
+}
+
+TEST_F(LargeSingleBlockTestFixture, MeshAssignmentOnlyForChanges) {
+  for (int x = 0; x < voxels_per_side; ++x) {
+    for (int y = 0; y < voxels_per_side; ++y) {
+      for (int z = 0; z < voxels_per_side; ++z) {
+        const bool is_edge = (x == 0) || (y == 0);
+        setTsdfVoxel(x, y, z, is_edge ? 0.0 : truncation_distance);
+      }
+    }
+  }
+
+  GvdIntegrator gvd_integrator(gvd_config, tsdf_layer.get(), gvd_layer, mesh_layer);
+  gvd_integrator.updateFromTsdfLayer(true, true, true);
+
+  const auto& graph = gvd_integrator.getGraph();
+  ASSERT_LT(0u, graph.numNodes());
+  EXPECT_EQ(graph.numNodes(),
+            gvd_integrator.getUpdateStatistics().number_mesh_assignments);
+
+  std::map<NodeId, size_t> num_connections;
+  for (const auto& id_node_pair : graph.nodes()) {
+    const auto& attrs = id_node_pair.second->attributes<PlaceNodeAttributes>();
+    num_connections[id_node_pair.first] = attrs.voxblox_mesh_connections.size();
+  }
+
+  // nothing changed, so no node should be reassigned
+  gvd_integrator.updateFromTsdfLayer(true);
+  EXPECT_EQ(0u, gvd_integrator.getUpdateStatistics().number_mesh_assignments);
+  for (const auto& id_node_pair : graph.nodes()) {
+    const auto& attrs = id_node_pair.second->attributes<PlaceNodeAttributes>();
+    EXPECT_EQ(num_connections.at(id_node_pair.first),
+              attrs.voxblox_mesh_connections.size());
+  }
+}
+
 TEST_F(SingleBlockTestFixture, CornerCorrect) {
   GvdIntegrator gvd_integrator(gvd_config, tsdf_layer.get(), gvd_layer, mesh_layer);
   gvd_integrator.updateFromTsdfLayer(true);
@@ -0,0 +1,255 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra_topology/gvd_integrator.h>
+#include <hydra_topology/layer_encoding.h>
+
+#include "hydra_topology_test/test_fixtures.h"
+
+namespace hydra {
+namespace topology {
+
+using test_helpers::LargeSingleBlockTestFixture;
+
+namespace {
+
+std::unordered_set<NodeId> getAllNodes(const SceneGraphLayer& layer) {
+  std::unordered_set<NodeId> nodes;
+  for (const auto& id_node_pair : layer.nodes()) {
+    nodes.insert(id_node_pair.first);
+  }
+  return nodes;
+}
+
+void expectLayersEqual(const SceneGraphLayer& expected,
+                       const SceneGraphLayer& result,
+                       const SceneGraphLayer::Edges& edges) {
+  ASSERT_EQ(expected.numNodes(), result.numNodes());
+  for (const auto& id_node_pair : expected.nodes()) {
+    ASSERT_TRUE(result.hasNode(id_node_pair.first));
+    const auto& lhs = id_node_pair.second->attributes<PlaceNodeAttributes>();
+    const auto& rhs = result.getNode(id_node_pair.first)
+                          .value()
+                          .get()
+                          .attributes<PlaceNodeAttributes>();
+    EXPECT_EQ(lhs.position, rhs.position);
+    EXPECT_EQ(lhs.distance, rhs.distance);
+    EXPECT_EQ(lhs.num_basis_points, rhs.num_basis_points);
+
+    ASSERT_EQ(lhs.voxblox_mesh_connections.size(),
+              rhs.voxblox_mesh_connections.size());
+    for (size_t i = 0; i < lhs.voxblox_mesh_connections.size(); ++i) {
+      const auto& lhs_info = lhs.voxblox_mesh_connections[i];
+      const auto& rhs_info = rhs.voxblox_mesh_connections[i];
+      for (size_t j = 0; j < 3; ++j) {
+        EXPECT_EQ(lhs_info.block[j], rhs_info.block[j]);
+        // binary positions are quantized to a millimeter
+        EXPECT_NEAR(lhs_info.voxel_pos[j], rhs_info.voxel_pos[j], 5.0e-4 + 1.0e-9);
+      }
+      EXPECT_EQ(lhs_info.vertex, rhs_info.vertex);
+    }
+  }
+
+  EXPECT_EQ(expected.numEdges(), edges.size());
+  for (const auto& id_edge_pair : edges) {
+    const auto& edge = id_edge_pair.second;
+    ASSERT_TRUE(expected.hasEdge(edge.source, edge.target));
+    const SceneGraphEdge& expected_edge =
+        expected.getEdge(edge.source, edge.target).value();
+    EXPECT_EQ(expected_edge.info->weighted, edge.info->weighted);
+    EXPECT_EQ(expected_edge.info->weight, edge.info->weight);
+  }
+}
+
+void fillTestLayer(IsolatedSceneGraphLayer& layer) {
+  for (size_t i = 0; i < 5; ++i) {
+    PlaceNodeAttributes::Ptr attrs(new PlaceNodeAttributes(0.1 * i, i));
+    attrs->position << 1.5 * i, -2.0 * i, 0.25;
+    for (size_t j = 0; j < i; ++j) {
+      NearestVertexInfo info;
+      info.block[0] = -static_cast<int>(j);
+      info.block[1] = 100;
+      info.block[2] = -70000;
+      info.voxel_pos[0] = 0.05 * j;
+      info.voxel_pos[1] = -1.0;
+      info.voxel_pos[2] = 3.0;
+      info.vertex = 1000 * j;
+      attrs->voxblox_mesh_connections.push_back(info);
+    }
+
+    // runs of vertices in a shared block (including out-of-order and repeated ones)
+    for (const size_t vertex : {5, 6, 7, 3, 9, 9}) {
+      NearestVertexInfo info;
+      info.block[0] = 2;
+      info.block[1] = -3;
+      info.block[2] = static_cast<int>(i);
+      info.voxel_pos[0] = 0.1 * vertex;
+      info.voxel_pos[1] = 0.2;
+      info.voxel_pos[2] = -0.3;
+      info.vertex = vertex;
+      attrs->voxblox_mesh_connections.push_back(info);
+    }
+
+    layer.emplaceNode(NodeSymbol('p', 2 * i), std::move(attrs));
+  }
+
+  layer.insertEdge(NodeSymbol('p', 0), NodeSymbol('p', 2));
+  layer.insertEdge(
+      NodeSymbol('p', 6), NodeSymbol('p', 2), std::make_unique<EdgeAttributes>(0.3));
+  layer.insertEdge(
+      NodeSymbol('p', 8), NodeSymbol('p', 0), std::make_unique<EdgeAttributes>(0.7));
+}
+
+}  // namespace
+
+TEST(LayerEncoding, BinaryRoundTrip) {
+  IsolatedSceneGraphLayer layer(DsgLayers::PLACES);
+  fillTestLayer(layer);
+  const std::string contents = encodeLayer(layer, getAllNodes(layer));
+  EXPECT_TRUE(isBinaryLayer(contents));
+
+  IsolatedSceneGraphLayer result(DsgLayers::PLACES);
+  auto edges = decodeLayer(contents, result);
+  ASSERT_TRUE(edges != nullptr);
+  expectLayersEqual(layer, result, *edges);
+}
+
+TEST(LayerEncoding, BinaryKeepsBoundaryEdges) {
+  IsolatedSceneGraphLayer layer(DsgLayers::PLACES);
+  fillTestLayer(layer);
+  const std::string contents = encodeLayer(layer, {NodeSymbol('p', 2)});
+
+  IsolatedSceneGraphLayer result(DsgLayers::PLACES);
+  auto edges = decodeLayer(contents, result);
+  ASSERT_TRUE(edges != nullptr);
+  EXPECT_EQ(1u, result.numNodes());
+  // both edges touch the encoded node
+  EXPECT_EQ(2u, edges->size());
+}
+
+TEST(LayerEncoding, BinaryRejectsInvalidContents) {
+  IsolatedSceneGraphLayer layer(DsgLayers::PLACES);
+  fillTestLayer(layer);
+  const std::string contents = encodeLayer(layer, getAllNodes(layer));
+
+  // every strict prefix that still looks binary is truncated
+  for (size_t length = 4; length < contents.size(); ++length) {
+    IsolatedSceneGraphLayer result(DsgLayers::PLACES);
+    EXPECT_TRUE(decodeLayer(contents.substr(0, length), result) == nullptr)
+        << "length: " << length;
+  }
+
+  std::string future_version = contents;
+  future_version[4] = 4;
+  IsolatedSceneGraphLayer result(DsgLayers::PLACES);
+  EXPECT_TRUE(decodeLayer(future_version, result) == nullptr);
+
+  // version 2 stored full-precision connection positions
+  std::string old_version = contents;
+  old_version[4] = 2;
+  IsolatedSceneGraphLayer old_result(DsgLayers::PLACES);
+  EXPECT_TRUE(decodeLayer(old_version, old_result) == nullptr);
+}
+
+TEST(LayerEncoding, BinaryConnectionsAreCompact) {
+  IsolatedSceneGraphLayer layer(DsgLayers::PLACES);
+  PlaceNodeAttributes::Ptr attrs(new PlaceNodeAttributes(0.5, 2));
+  attrs->position << 1.0, 2.0, 3.0;
+  for (size_t vertex = 0; vertex < 100; ++vertex) {
+    NearestVertexInfo info;
+    info.block[0] = 1;
+    info.block[1] = 2;
+    info.block[2] = 3;
+    info.voxel_pos[0] = 1.0 + 0.05 * vertex;
+    info.voxel_pos[1] = 2.5;
+    info.voxel_pos[2] = 3.0 - 0.02 * vertex;
+    info.vertex = vertex;
+    attrs->voxblox_mesh_connections.push_back(info);
+  }
+  layer.emplaceNode(NodeSymbol('p', 0), std::move(attrs));
+
+  // nearby connection positions only take a few bytes instead of three doubles
+  const std::string contents = encodeLayer(layer, getAllNodes(layer));
+  EXPECT_LT(contents.size(), 100u * 8u);
+
+  IsolatedSceneGraphLayer result(DsgLayers::PLACES);
+  auto edges = decodeLayer(contents, result);
+  ASSERT_TRUE(edges != nullptr);
+  expectLayersEqual(layer, result, *edges);
+}
+
+TEST(LayerEncoding, JsonFallback) {
+  IsolatedSceneGraphLayer layer(DsgLayers::PLACES);
+  fillTestLayer(layer);
+  const std::string contents =
+      encodeLayer(layer, getAllNodes(layer), LayerEncoding::JSON);
+  EXPECT_FALSE(isBinaryLayer(contents));
+
+  IsolatedSceneGraphLayer result(DsgLayers::PLACES);
+  auto edges = decodeLayer(contents, result);
+  ASSERT_TRUE(edges != nullptr);
+  EXPECT_EQ(layer.numNodes(), result.numNodes());
+  EXPECT_EQ(layer.numEdges(), edges->size());
+}
+
+TEST_F(LargeSingleBlockTestFixture, ExtractedLayerRoundTrip) {
+  for (int x = 0; x < voxels_per_side; ++x) {
+    for (int y = 0; y < voxels_per_side; ++y) {
+      for (int z = 0; z < voxels_per_side; ++z) {
+        const bool is_edge = (x == 0) || (y == 0);
+        setTsdfVoxel(x, y, z, is_edge ? 0.0 : truncation_distance);
+      }
+    }
+  }
+
+  GvdIntegrator gvd_integrator(gvd_config, tsdf_layer.get(), gvd_layer, mesh_layer);
+  gvd_integrator.updateFromTsdfLayer(true, true, true);
+
+  const auto& graph = gvd_integrator.getGraph();
+  ASSERT_LT(0u, graph.numNodes());
+
+  const std::string binary = encodeLayer(graph, getAllNodes(graph));
+  IsolatedSceneGraphLayer result(DsgLayers::PLACES);
+  auto edges = decodeLayer(binary, result);
+  ASSERT_TRUE(edges != nullptr);
+  expectLayersEqual(graph, result, *edges);
+
+  const std::string json =
+      encodeLayer(graph, getAllNodes(graph), LayerEncoding::JSON);
+  EXPECT_LT(binary.size(), json.size());
+}
+
+}  // namespace topology
+}  // namespace hydra
@@ -0,0 +1,113 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+
+#include <hydra_topology/memory_governor.h>
+
+namespace hydra {
+namespace topology {
+
+namespace {
+
+inline MemoryUsage makeUsage(double total_mb) {
+  MemoryUsage usage;
+  usage.tsdf_bytes = total_mb * 1024 * 1024;
+  return usage;
+}
+
+}  // namespace
+
+TEST(MemoryGovernor, DisabledKeepsRadius) {
+  MemoryGovernorConfig config;
+  MemoryGovernor governor(config, 5.0, 1.0);
+  EXPECT_FALSE(governor.enabled());
+  EXPECT_EQ(5.0, governor.update(0, makeUsage(1.0e6)));
+}
+
+TEST(MemoryGovernor, ShrinkAndRestoreRadius) {
+  MemoryGovernorConfig config;
+  config.budget_mb = 10.0;
+  config.shrink_factor = 0.5;
+  config.grow_factor = 2.0;
+  config.min_radius_m = 2.0;
+  config.restore_fraction = 0.8;
+  MemoryGovernor governor(config, 8.0, 1.0);
+
+  EXPECT_EQ(4.0, governor.update(0, makeUsage(11.0)));
+  EXPECT_EQ(2.0, governor.update(1, makeUsage(11.0)));
+  // clamped to the minimum radius
+  EXPECT_EQ(2.0, governor.update(2, makeUsage(11.0)));
+  // under budget, but not under the restore threshold
+  EXPECT_EQ(2.0, governor.update(3, makeUsage(9.0)));
+  EXPECT_EQ(4.0, governor.update(4, makeUsage(7.0)));
+  EXPECT_EQ(8.0, governor.update(5, makeUsage(7.0)));
+  // clamped to the nominal radius
+  EXPECT_EQ(8.0, governor.update(6, makeUsage(7.0)));
+}
+
+TEST(MemoryGovernor, ArchiveOldestBlocks) {
+  MemoryGovernorConfig config;
+  config.budget_mb = 3.5;
+  config.min_radius_m = 4.0;
+  config.shrink_factor = 0.1;
+  MemoryGovernor governor(config, 8.0, 1.0);
+
+  // blocks inside the minimum radius are still candidates
+  BlockIndexList blocks{BlockIndex(2, 0, 0), BlockIndex(3, 0, 0)};
+  governor.updateBlockTimes(blocks, 10);
+  governor.updateBlockTimes({BlockIndex(0, 3, 0)}, 20);
+  // next to the sensor, so these should never get archived
+  governor.updateBlockTimes({BlockIndex(0, 0, 0), BlockIndex(-1, 0, 0)}, 5);
+
+  const MemoryUsage usage = makeUsage(4.0);
+  const voxblox::Point center = voxblox::Point::Zero();
+
+  // radius hasn't reached the minimum yet
+  EXPECT_TRUE(governor.getBlocksToArchive(0, usage, center).empty());
+
+  EXPECT_EQ(4.0, governor.update(0, usage));
+  BlockIndexList result = governor.getBlocksToArchive(0, usage, center);
+  // each of the 5 blocks is worth 0.8 MiB, so we only need to archive a single block
+  ASSERT_EQ(1u, result.size());
+  EXPECT_EQ(BlockIndex(2, 0, 0), result[0]);
+
+  governor.removeBlocks(blocks);
+  result = governor.getBlocksToArchive(0, usage, center);
+  ASSERT_EQ(1u, result.size());
+  EXPECT_EQ(BlockIndex(0, 3, 0), result[0]);
+}
+
+}  // namespace topology
+}  // namespace hydra
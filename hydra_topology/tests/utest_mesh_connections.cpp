@@ -0,0 +1,116 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra_topology/mesh_connections.h>
+
+namespace hydra {
+namespace topology {
+
+namespace {
+
+NearestVertexInfo makeInfo(int x, int y, int z, size_t vertex) {
+  NearestVertexInfo info;
+  info.block[0] = x;
+  info.block[1] = y;
+  info.block[2] = z;
+  info.voxel_pos[0] = 0.0;
+  info.voxel_pos[1] = 0.0;
+  info.voxel_pos[2] = static_cast<double>(vertex);
+  info.vertex = vertex;
+  return info;
+}
+
+}  // namespace
+
+TEST(MeshConnections, CompactSortsAndDeduplicates) {
+  MeshConnections connections{makeInfo(1, 0, 0, 4),
+                              makeInfo(0, 0, 0, 2),
+                              makeInfo(1, 0, 0, 3),
+                              makeInfo(0, 0, 0, 2),
+                              makeInfo(0, 0, 0, 1)};
+  connections[3].voxel_pos[0] = 5.0;
+
+  compactMeshConnections(connections);
+  ASSERT_EQ(4u, connections.size());
+  EXPECT_EQ(0, connections[0].block[0]);
+  EXPECT_EQ(1u, connections[0].vertex);
+  EXPECT_EQ(0, connections[1].block[0]);
+  EXPECT_EQ(2u, connections[1].vertex);
+  // the first copy of a repeated vertex is kept
+  EXPECT_EQ(0.0, connections[1].voxel_pos[0]);
+  EXPECT_EQ(1, connections[2].block[0]);
+  EXPECT_EQ(3u, connections[2].vertex);
+  EXPECT_EQ(1, connections[3].block[0]);
+  EXPECT_EQ(4u, connections[3].vertex);
+
+  MeshConnections other{makeInfo(0, 0, 0, 3), makeInfo(1, 0, 0, 4)};
+  mergeMeshConnections(other, connections);
+  ASSERT_EQ(5u, connections.size());
+  EXPECT_EQ(3u, connections[2].vertex);
+  EXPECT_EQ(0, connections[2].block[0]);
+}
+
+TEST(MeshConnections, RunsAndIntervals) {
+  MeshConnections connections{makeInfo(0, 0, 0, 1),
+                              makeInfo(0, 0, 0, 2),
+                              makeInfo(0, 0, 0, 3),
+                              makeInfo(0, 0, 0, 7),
+                              makeInfo(0, 1, 0, 7),
+                              makeInfo(0, 1, 0, 8),
+                              makeInfo(0, 0, 0, 4)};
+
+  const auto runs = getBlockRuns(connections);
+  ASSERT_EQ(3u, runs.size());
+  EXPECT_EQ(voxblox::BlockIndex(0, 0, 0), runs[0].block);
+  EXPECT_EQ(4u, runs[0].size());
+  EXPECT_EQ(voxblox::BlockIndex(0, 1, 0), runs[1].block);
+  EXPECT_EQ(2u, runs[1].size());
+  EXPECT_EQ(voxblox::BlockIndex(0, 0, 0), runs[2].block);
+  EXPECT_EQ(6u, runs[2].begin);
+  EXPECT_EQ(7u, runs[2].end);
+
+  const auto intervals = getVertexIntervals(connections, runs[0]);
+  ASSERT_EQ(2u, intervals.size());
+  EXPECT_EQ(1u, intervals[0].start);
+  EXPECT_EQ(4u, intervals[0].end);
+  EXPECT_EQ(7u, intervals[1].start);
+  EXPECT_EQ(1u, intervals[1].size());
+
+  compactMeshConnections(connections);
+  EXPECT_EQ(2u, getBlockRuns(connections).size());
+}
+
+}  // namespace topology
+}  // namespace hydra
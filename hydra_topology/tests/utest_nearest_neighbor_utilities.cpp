@@ -36,6 +36,8 @@
 
 #include <gtest/gtest.h>
 
+#include <cmath>
+
 namespace hydra {
 namespace topology {
 
@@ -43,5 +45,48 @@ TEST(NearestNeighborUtilities, TestBasic) {
   // TODO(nathan) actual test nearest node
 }
 
+TEST(NearestNeighborUtilities, BatchMatchesSingleQueries) {
+  IsolatedSceneGraphLayer layer(DsgLayers::PLACES);
+  std::vector<NodeId> nodes;
+  for (size_t i = 0; i < 100; ++i) {
+    PlaceNodeAttributes::Ptr attrs(new PlaceNodeAttributes(1.0, 1));
+    // points on a spiral, so distances are never tied
+    attrs->position << std::cos(0.3 * i) * (1.0 + 0.1 * i),
+        std::sin(0.3 * i) * (1.0 + 0.1 * i), 0.05 * i;
+    layer.emplaceNode(i, std::move(attrs));
+    nodes.push_back(i);
+  }
+
+  NearestNodeFinder finder(layer, nodes);
+
+  std::vector<Eigen::Vector3d> queries;
+  for (size_t i = 0; i < 200; ++i) {
+    queries.emplace_back(0.11 * i - 10.0, 5.0 - 0.07 * i, 0.02 * i);
+  }
+
+  for (const size_t num_threads : {1, 4}) {
+    const auto matches = finder.findBatch(queries, 3, 2.0, num_threads);
+    ASSERT_EQ(queries.size(), matches.numQueries());
+
+    for (size_t i = 0; i < queries.size(); ++i) {
+      std::vector<NodeId> expected_nodes;
+      std::vector<double> expected_distances;
+      finder.find(queries[i], 3, false, [&](NodeId node, size_t, double distance_sq) {
+        if (distance_sq <= 4.0) {
+          expected_nodes.push_back(node);
+          expected_distances.push_back(std::sqrt(distance_sq));
+        }
+      });
+
+      ASSERT_EQ(expected_nodes.size(), matches.numMatches(i));
+      const size_t offset = matches.offsets[i];
+      for (size_t j = 0; j < expected_nodes.size(); ++j) {
+        EXPECT_EQ(expected_nodes[j], matches.nodes[offset + j]);
+        EXPECT_NEAR(expected_distances[j], matches.distances[offset + j], 1.0e-9);
+      }
+    }
+  }
+}
+
 }  // namespace topology
 }  // namespace hydra
@@ -0,0 +1,156 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+#include <hydra_topology/graph_extraction_utilities.h>
+#include <hydra_topology/ray_marching.h>
+
+namespace hydra {
+namespace topology {
+
+namespace {
+
+bool contains(const voxblox::AlignedVector<GlobalIndex>& indices,
+              const GlobalIndex& index) {
+  return std::find(indices.begin(), indices.end(), index) != indices.end();
+}
+
+}  // namespace
+
+TEST(RayMarching, AxisAlignedLine) {
+  const GlobalIndex start(0, 0, 0);
+  const GlobalIndex end(5, 0, 0);
+  voxblox::AlignedVector<GlobalIndex> expected{
+      {1, 0, 0}, {2, 0, 0}, {3, 0, 0}, {4, 0, 0}};
+  EXPECT_EQ(expected, makeVoxelLine(start, end));
+
+  voxblox::AlignedVector<GlobalIndex> reversed(expected.rbegin(), expected.rend());
+  EXPECT_EQ(reversed, makeVoxelLine(end, start));
+
+  EXPECT_TRUE(makeVoxelLine(start, start).empty());
+  EXPECT_TRUE(makeVoxelLine(start, GlobalIndex(1, 0, 0)).empty());
+}
+
+TEST(RayMarching, LineIsConnectedSupercover) {
+  const GlobalIndex start(-3, 2, 7);
+  const std::vector<GlobalIndex> ends{
+      {10, -4, 1}, {-3, 9, 7}, {4, 9, 14}, {-20, -1, 2}, {1, 1, 1}};
+
+  for (const auto& end : ends) {
+    const auto line = makeVoxelLine(start, end);
+    ASSERT_FALSE(line.empty());
+    EXPECT_FALSE(contains(line, start));
+    EXPECT_FALSE(contains(line, end));
+
+    // every step moves along exactly one axis
+    GlobalIndex prev = start;
+    for (const auto& index : line) {
+      EXPECT_EQ(1, (index - prev).cwiseAbs().sum()) << index.transpose();
+      prev = index;
+    }
+    EXPECT_EQ(1, (end - prev).cwiseAbs().sum());
+
+    // the 26-connected line always passes through the voxels the walk visits
+    for (const auto& index : makeBresenhamLine(start, end)) {
+      EXPECT_TRUE(contains(line, index)) << index.transpose();
+    }
+  }
+}
+
+TEST(RayMarching, JumpsStayOnLine) {
+  const GlobalIndex start(0, 0, 0);
+  const GlobalIndex end(40, 17, -9);
+  const auto line = makeVoxelLine(start, end);
+
+  voxblox::AlignedVector<GlobalIndex> visited;
+  walkVoxelLine(start, end, [&](const GlobalIndex& index) {
+    visited.push_back(index);
+    return 6.0;
+  });
+
+  ASSERT_FALSE(visited.empty());
+  EXPECT_LT(visited.size(), line.size() / 2);
+  for (const auto& index : visited) {
+    EXPECT_TRUE(contains(line, index)) << index.transpose();
+  }
+
+  // skipped voxels are always within the returned radius of a visited voxel
+  for (const auto& index : line) {
+    bool covered = false;
+    for (const auto& other : visited) {
+      covered |= (index - other).cast<double>().norm() <= 6.0;
+    }
+    EXPECT_TRUE(covered) << index.transpose();
+  }
+
+  size_t num_visited = 0;
+  walkVoxelLine(start, end, [&](const GlobalIndex&) {
+    ++num_visited;
+    return -1.0;
+  });
+  EXPECT_EQ(1u, num_visited);
+}
+
+TEST(RayMarching, MarcherMatchesLayerLookup) {
+  Layer<GvdVoxel> layer(0.1, 8);
+  for (const auto& block_index : {BlockIndex(0, 0, 0), BlockIndex(1, 0, 0)}) {
+    auto block = layer.allocateBlockPtrByIndex(block_index);
+    for (size_t i = 0; i < block->num_voxels(); ++i) {
+      block->getVoxelByLinearIndex(i).distance = static_cast<float>(i);
+    }
+  }
+
+  const GlobalIndex start(1, 2, 3);
+  const GlobalIndex end(30, 5, 6);
+  GvdRayMarcher marcher(layer);
+  size_t num_missing = 0;
+  marcher.march(start, end, [&](const GlobalIndex& index, const GvdVoxel* voxel) {
+    EXPECT_EQ(layer.getVoxelPtrByGlobalIndex(index), voxel) << index.transpose();
+    num_missing += voxel ? 0 : 1;
+    return 0.0;
+  });
+
+  // the line leaves the two allocated blocks
+  const auto line = makeVoxelLine(start, end);
+  const size_t expected_missing = std::count_if(
+      line.begin(), line.end(), [](const GlobalIndex& index) { return index.x() >= 16; });
+  EXPECT_LT(0u, expected_missing);
+  EXPECT_EQ(expected_missing, num_missing);
+}
+
+}  // namespace topology
+}  // namespace hydra
@@ -0,0 +1,331 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+
+#include <hydra_topology/topology_outputs.h>
+
+#include <map>
+#include <set>
+#include <unordered_set>
+
+namespace hydra {
+namespace topology {
+
+TEST(TopologyOutputs, PlacesUpdateCorrect) {
+  IsolatedSceneGraphLayer graph(DsgLayers::PLACES);
+  graph.emplaceNode(0, std::make_unique<NodeAttributes>());
+  graph.emplaceNode(1, std::make_unique<NodeAttributes>());
+  graph.emplaceNode(2, std::make_unique<NodeAttributes>());
+  graph.emplaceNode(3, std::make_unique<NodeAttributes>());
+  graph.insertEdge(0, 1);
+  graph.insertEdge(1, 2);
+  graph.insertEdge(2, 3);
+
+  auto update = makeActivePlacesUpdate(10, graph, {1, 2}, {5});
+  EXPECT_EQ(10u, update->timestamp_ns);
+  EXPECT_EQ(2u, update->layer.numNodes());
+  EXPECT_TRUE(update->layer.hasNode(1));
+  EXPECT_TRUE(update->layer.hasNode(2));
+  // every edge touches an active node
+  EXPECT_EQ(3u, update->edges.size());
+  ASSERT_EQ(1u, update->deleted_nodes.size());
+  EXPECT_EQ(5u, update->deleted_nodes.front());
+}
+
+TEST(TopologyOutputs, PlacesUpdateMergeCorrect) {
+  IsolatedSceneGraphLayer graph(DsgLayers::PLACES);
+  for (size_t i = 0; i < 3; ++i) {
+    graph.emplaceNode(i, std::make_unique<PlaceNodeAttributes>(0.5 * (i + 1), 2));
+  }
+  graph.insertEdge(0, 1);
+  graph.insertEdge(1, 2);
+
+  DynamicSceneGraph dsg;
+  dsg.emplaceNode(DsgLayers::PLACES, 0, std::make_unique<PlaceNodeAttributes>(0.1, 2));
+  dsg.emplaceNode(DsgLayers::PLACES, 1, std::make_unique<PlaceNodeAttributes>(0.2, 2));
+  dsg.insertEdge(0, 1, std::make_unique<EdgeAttributes>(0.3));
+
+  auto update = makeActivePlacesUpdate(10, graph, {1, 2}, {});
+  update->mergeInto(dsg);
+
+  const auto& places = dsg.getLayer(DsgLayers::PLACES);
+  const auto get_distance = [&](NodeId node_id) {
+    const SceneGraphNode& node = places.getNode(node_id).value();
+    return node.attributes<PlaceNodeAttributes>().distance;
+  };
+
+  EXPECT_EQ(3u, places.numNodes());
+  // existing places and edges are overwritten
+  EXPECT_EQ(0.1, get_distance(0));
+  EXPECT_EQ(1.0, get_distance(1));
+  EXPECT_EQ(1.5, get_distance(2));
+  EXPECT_EQ(1.0, places.getEdge(0, 1).value().get().info->weight);
+  EXPECT_TRUE(places.hasEdge(1, 2));
+
+  // the update is left untouched
+  EXPECT_EQ(2u, update->layer.numNodes());
+  EXPECT_EQ(2u, update->edges.size());
+}
+
+TEST(TopologyOutputs, PlacesDeltaCorrect) {
+  IsolatedSceneGraphLayer graph(DsgLayers::PLACES);
+  graph.emplaceNode(0, std::make_unique<NodeAttributes>());
+  graph.emplaceNode(1, std::make_unique<NodeAttributes>());
+  graph.emplaceNode(2, std::make_unique<NodeAttributes>());
+  graph.emplaceNode(3, std::make_unique<NodeAttributes>());
+  graph.insertEdge(0, 1);
+  graph.insertEdge(1, 2);
+
+  GraphChanges changes;
+  changes.modified_nodes = {2, 7};
+  changes.archived_nodes = {3};
+  changes.insertEdge(2, 1);
+  changes.insertEdge(3, 4);
+  // removed and then inserted again
+  changes.removeEdge(0, 1);
+  changes.insertEdge(0, 1);
+  // removed alongside a deleted node
+  changes.removeEdge(1, 5);
+
+  auto update = makeActivePlacesDelta(10, graph, changes, {5});
+  EXPECT_FALSE(update->is_full_update);
+  EXPECT_EQ(10u, update->timestamp_ns);
+  // only changed places that still exist are included
+  EXPECT_EQ(1u, update->layer.numNodes());
+  EXPECT_TRUE(update->layer.hasNode(2));
+
+  std::set<EdgeEndpoints> edges;
+  for (const auto& id_edge_pair : update->edges) {
+    const auto& edge = id_edge_pair.second;
+    edges.insert({std::min(edge.source, edge.target),
+                  std::max(edge.source, edge.target)});
+  }
+  const std::set<EdgeEndpoints> expected_edges{{0, 1}, {1, 2}};
+  EXPECT_EQ(expected_edges, edges);
+
+  ASSERT_EQ(1u, update->removed_edges.size());
+  EXPECT_EQ(EdgeEndpoints(0, 1), update->removed_edges.front());
+  ASSERT_EQ(1u, update->archived_nodes.size());
+  EXPECT_EQ(3u, update->archived_nodes.front());
+  ASSERT_EQ(1u, update->deleted_nodes.size());
+  EXPECT_EQ(5u, update->deleted_nodes.front());
+}
+
+void addPlace(ActivePlacesUpdate& update, NodeId node, double x = 0.0) {
+  auto attrs = std::make_unique<NodeAttributes>();
+  attrs->position.x() = x;
+  update.layer.emplaceNode(node, std::move(attrs));
+}
+
+void addEdge(ActivePlacesUpdate& update, NodeId source, NodeId target) {
+  update.edges.emplace(std::piecewise_construct,
+                       std::forward_as_tuple(update.edges.size()),
+                       std::forward_as_tuple(
+                           source, target, std::make_unique<EdgeAttributes>()));
+}
+
+std::set<EdgeEndpoints> getEdges(const ActivePlacesUpdate& update) {
+  std::set<EdgeEndpoints> edges;
+  for (const auto& id_edge_pair : update.edges) {
+    const auto& edge = id_edge_pair.second;
+    edges.insert({std::min(edge.source, edge.target),
+                  std::max(edge.source, edge.target)});
+  }
+  return edges;
+}
+
+std::set<NodeId> getPlaces(const ActivePlacesUpdate& update) {
+  std::set<NodeId> places;
+  for (const auto& id_node_pair : update.layer.nodes()) {
+    places.insert(id_node_pair.first);
+  }
+  return places;
+}
+
+TEST(TopologyOutputs, FullUpdateRecoversDroppedDelta) {
+  // consumer graph after applying a full update with places 1 to 4
+  IsolatedSceneGraphLayer graph(DsgLayers::PLACES);
+  for (NodeId node = 1; node <= 4; ++node) {
+    graph.emplaceNode(node, std::make_unique<NodeAttributes>());
+  }
+  graph.insertEdge(1, 2);
+  graph.insertEdge(2, 3);
+  graph.insertEdge(3, 4);
+  const std::unordered_set<NodeId> active{1, 2, 3, 4};
+
+  // the dropped delta deleted place 3, archived place 4 and removed edge (1, 2)
+  ActivePlacesUpdate full;
+  full.sequence_number = 5;
+  addPlace(full, 1);
+  addPlace(full, 2);
+  addPlace(full, 5);
+  addEdge(full, 2, 5);
+  // archived places are resent until the next full update
+  full.archived_nodes.push_back(4);
+
+  const auto stale = findStalePlaces(graph, active, full);
+  EXPECT_EQ(std::vector<NodeId>({3}), stale.nodes);
+  const std::set<EdgeEndpoints> stale_edges(stale.edges.begin(), stale.edges.end());
+  const std::set<EdgeEndpoints> expected_edges{{1, 2}, {2, 3}};
+  EXPECT_EQ(expected_edges, stale_edges);
+
+  // partial updates only describe what changed
+  full.is_full_update = false;
+  const auto none = findStalePlaces(graph, active, full);
+  EXPECT_TRUE(none.nodes.empty());
+  EXPECT_TRUE(none.edges.empty());
+}
+
+TEST(TopologyOutputs, PlacesMergeCorrect) {
+  auto first = std::make_shared<ActivePlacesUpdate>();
+  first->is_full_update = false;
+  first->sequence_number = 1;
+  addPlace(*first, 1);
+  addPlace(*first, 2);
+  addEdge(*first, 1, 2);
+  addEdge(*first, 2, 3);
+  first->removed_edges.push_back({4, 5});
+
+  auto second = std::make_shared<ActivePlacesUpdate>();
+  second->is_full_update = false;
+  second->sequence_number = 2;
+  addPlace(*second, 2, 2.0);
+  addPlace(*second, 6);
+  second->deleted_nodes.push_back(1);
+  second->archived_nodes.push_back(3);
+  second->removed_edges.push_back({3, 2});
+
+  auto third = std::make_shared<ActivePlacesUpdate>();
+  third->is_full_update = false;
+  third->timestamp_ns = 30;
+  third->sequence_number = 3;
+  addPlace(*third, 7);
+  addEdge(*third, 7, 6);
+  third->archived_nodes.push_back(2);
+
+  auto merged = mergeActivePlacesUpdates({first, second, third});
+  EXPECT_FALSE(merged->is_full_update);
+  EXPECT_EQ(30u, merged->timestamp_ns);
+  EXPECT_EQ(3u, merged->sequence_number);
+  EXPECT_EQ(3u, merged->num_merged);
+  // archived places are still sent with their latest attributes
+  EXPECT_EQ(std::set<NodeId>({2, 6, 7}), getPlaces(*merged));
+  EXPECT_EQ(2.0, merged->layer.getNode(2).value().get().attributes().position.x());
+  // edges are dropped with deleted places and cancelled by later removals
+  EXPECT_EQ(std::set<EdgeEndpoints>({{6, 7}}), getEdges(*merged));
+  EXPECT_EQ(std::vector<NodeId>({1}), merged->deleted_nodes);
+  EXPECT_EQ(std::vector<NodeId>({2, 3}), merged->archived_nodes);
+  EXPECT_EQ(std::vector<EdgeEndpoints>({{2, 3}, {4, 5}}), merged->removed_edges);
+
+  // pending places that are missing from a full update are archived
+  auto full = std::make_shared<ActivePlacesUpdate>();
+  full->sequence_number = 4;
+  addPlace(*full, 7);
+  addPlace(*full, 8);
+  merged = mergeActivePlacesUpdates({first, second, third, full});
+  EXPECT_TRUE(merged->is_full_update);
+  EXPECT_EQ(4u, merged->num_merged);
+  EXPECT_EQ(std::set<NodeId>({2, 6, 7, 8}), getPlaces(*merged));
+  EXPECT_EQ(std::vector<NodeId>({2, 3, 6}), merged->archived_nodes);
+}
+
+voxblox_msgs::MeshBlock makeBlock(int64_t x, const std::vector<uint16_t>& values) {
+  voxblox_msgs::MeshBlock block;
+  block.index[0] = x;
+  block.x = values;
+  block.y = values;
+  block.z = values;
+  return block;
+}
+
+std::map<int64_t, std::vector<uint16_t>> getBlocks(const voxblox_msgs::Mesh& mesh) {
+  std::map<int64_t, std::vector<uint16_t>> blocks;
+  for (const auto& block : mesh.mesh_blocks) {
+    blocks[block.index[0]] = block.x;
+  }
+  return blocks;
+}
+
+ActiveMeshUpdate::ConstPtr makeMeshUpdate(
+    uint64_t timestamp_ns,
+    const std::vector<voxblox_msgs::MeshBlock>& blocks,
+    const std::vector<int64_t>& archived) {
+  auto update = std::make_shared<ActiveMeshUpdate>();
+  update->timestamp_ns = timestamp_ns;
+  voxblox_msgs::Mesh::Ptr mesh(new voxblox_msgs::Mesh());
+  mesh->mesh_blocks = blocks;
+  update->mesh = mesh;
+
+  voxblox_msgs::Mesh::Ptr archived_blocks(new voxblox_msgs::Mesh());
+  for (const auto idx : archived) {
+    archived_blocks->mesh_blocks.push_back(makeBlock(idx, {}));
+  }
+  update->archived_blocks = archived_blocks;
+  return update;
+}
+
+TEST(TopologyOutputs, MeshMergeCorrect) {
+  const auto first = makeMeshUpdate(10, {makeBlock(0, {1}), makeBlock(1, {1})}, {});
+  const auto second = makeMeshUpdate(20, {makeBlock(0, {2, 3})}, {1});
+  // empty blocks delete the block
+  const auto third = makeMeshUpdate(30, {makeBlock(2, {5}), makeBlock(3, {})}, {0});
+
+  auto merged = mergeActiveMeshUpdates({first, second, third});
+  EXPECT_EQ(30u, merged->timestamp_ns);
+  std::map<int64_t, std::vector<uint16_t>> expected{
+      {0, {2, 3}}, {1, {1}}, {2, {5}}, {3, {}}};
+  EXPECT_EQ(expected, getBlocks(*merged->getMesh()));
+  // archived blocks still have their last version in the mesh
+  std::map<int64_t, std::vector<uint16_t>> expected_archived{{0, {}}, {1, {}}};
+  EXPECT_EQ(expected_archived, getBlocks(*merged->archived_blocks));
+
+  // merged blocks refer to the original messages instead of copies
+  ASSERT_EQ(4u, merged->merged_blocks.size());
+  EXPECT_EQ(&second->mesh->mesh_blocks[0], &merged->merged_blocks[0].get());
+  EXPECT_EQ(&first->mesh->mesh_blocks[1], &merged->merged_blocks[1].get());
+
+  // blocks that are sent again are no longer archived (merging merged updates works)
+  const auto fourth = makeMeshUpdate(40, {makeBlock(1, {4})}, {});
+  merged = mergeActiveMeshUpdates({merged, fourth});
+  expected[1] = {4};
+  EXPECT_EQ(expected, getBlocks(*merged->getMesh()));
+  EXPECT_EQ(&second->mesh->mesh_blocks[0], &merged->merged_blocks[0].get());
+  expected_archived.erase(1);
+  EXPECT_EQ(expected_archived, getBlocks(*merged->archived_blocks));
+  EXPECT_GT(estimateMemoryUsage(*merged), estimateMemoryUsage(*fourth));
+}
+
+}  // namespace topology
+}  // namespace hydra
@@ -0,0 +1,108 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+
+#include <hydra_topology/update_scheduler.h>
+
+namespace hydra {
+namespace topology {
+
+namespace {
+
+inline uint64_t toNs(double seconds) { return static_cast<uint64_t>(seconds * 1.0e9); }
+
+}  // namespace
+
+TEST(UpdateScheduler, PeriodFollowsChangeVolume) {
+  UpdateSchedulerConfig config;
+  config.enable = true;
+  config.min_period_s = 0.5;
+  config.max_period_s = 2.5;
+  config.min_changed_blocks = 1;
+  config.urgent_changed_blocks = 11;
+  UpdateScheduler scheduler(config);
+
+  EXPECT_NEAR(2.5, scheduler.getTargetPeriod(0), 1.0e-9);
+  EXPECT_NEAR(2.5, scheduler.getTargetPeriod(1), 1.0e-9);
+  EXPECT_NEAR(1.5, scheduler.getTargetPeriod(6), 1.0e-9);
+  EXPECT_NEAR(0.5, scheduler.getTargetPeriod(11), 1.0e-9);
+  EXPECT_NEAR(0.5, scheduler.getTargetPeriod(100), 1.0e-9);
+}
+
+TEST(UpdateScheduler, CostLimitsPeriod) {
+  UpdateSchedulerConfig config;
+  config.enable = true;
+  config.min_period_s = 0.5;
+  config.max_period_s = 2.5;
+  config.target_cpu_fraction = 0.5;
+  config.cost_alpha = 0.5;
+  UpdateScheduler scheduler(config);
+
+  scheduler.recordCost(0, 0.1);
+  EXPECT_NEAR(0.5, scheduler.getMinPeriod(), 1.0e-9);
+
+  // estimate is (0.1 + 1.9) / 2 = 1.0, which needs 2.0 seconds between updates
+  scheduler.recordCost(1, 1.9);
+  EXPECT_NEAR(1.0, scheduler.getCostEstimate(), 1.0e-9);
+  EXPECT_NEAR(2.0, scheduler.getMinPeriod(), 1.0e-9);
+  EXPECT_NEAR(2.0, scheduler.getTargetPeriod(1000), 1.0e-9);
+
+  // never slower than the maximum period
+  scheduler.recordCost(2, 20.0);
+  EXPECT_NEAR(2.5, scheduler.getMinPeriod(), 1.0e-9);
+}
+
+TEST(UpdateScheduler, ShouldUpdateCorrect) {
+  UpdateSchedulerConfig config;
+  config.enable = true;
+  config.min_period_s = 0.5;
+  config.max_period_s = 2.0;
+  config.min_changed_blocks = 1;
+  config.urgent_changed_blocks = 1;
+  UpdateScheduler scheduler(config);
+
+  // first update always runs
+  EXPECT_TRUE(scheduler.shouldUpdate(toNs(1.0), 0));
+  // nothing changed: wait for the maximum period
+  EXPECT_FALSE(scheduler.shouldUpdate(toNs(1.5), 0));
+  EXPECT_FALSE(scheduler.shouldUpdate(toNs(2.9), 0));
+  EXPECT_TRUE(scheduler.shouldUpdate(toNs(3.0), 0));
+  // changes: wait for the minimum period
+  EXPECT_FALSE(scheduler.shouldUpdate(toNs(3.2), 5));
+  EXPECT_TRUE(scheduler.shouldUpdate(toNs(3.5), 5));
+}
+
+}  // namespace topology
+}  // namespace hydra
@@ -0,0 +1,88 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+
+#include <hydra_topology/worker_pool.h>
+
+namespace hydra {
+namespace topology {
+
+TEST(WorkerPool, RunsEveryTaskOnce) {
+  WorkerPool pool(4);
+  EXPECT_EQ(4u, pool.numThreads());
+
+  std::vector<std::atomic<size_t>> counts(1000);
+  for (auto& count : counts) {
+    count = 0;
+  }
+
+  // the pool is reused between batches
+  for (size_t batch = 0; batch < 20; ++batch) {
+    pool.run(counts.size(), [&](size_t index) { ++counts[index]; });
+  }
+
+  for (const auto& count : counts) {
+    EXPECT_EQ(20u, count.load());
+  }
+}
+
+TEST(WorkerPool, HandlesSmallBatches) {
+  WorkerPool pool(3);
+  size_t num_calls = 0;
+  pool.run(0, [&](size_t) { ++num_calls; });
+  EXPECT_EQ(0u, num_calls);
+
+  pool.run(1, [&](size_t) { ++num_calls; });
+  EXPECT_EQ(1u, num_calls);
+
+  // fewer tasks than threads
+  std::vector<size_t> results(2, 0);
+  pool.run(results.size(), [&](size_t index) { results[index] = index + 1; });
+  EXPECT_EQ(1u, results[0]);
+  EXPECT_EQ(2u, results[1]);
+}
+
+TEST(WorkerPool, SingleThreadRunsInline) {
+  WorkerPool pool(1);
+  EXPECT_EQ(1u, pool.numThreads());
+
+  const auto caller = std::this_thread::get_id();
+  bool same_thread = true;
+  pool.run(10, [&](size_t) { same_thread &= std::this_thread::get_id() == caller; });
+  EXPECT_TRUE(same_thread);
+}
+
+}  // namespace topology
+}  // namespace hydra
@@ -0,0 +1,102 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <deque>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+
+namespace hydra {
+namespace metrics {
+
+/**
+ * @brief Records named scalar values over time (e.g. decisions made by adaptive
+ * components or queue sizes) alongside the timestamp they refer to
+ *
+ * Only the most recent measurements of every metric are kept (see
+ * setMaxMeasurements), so recording stays bounded over long runs
+ */
+class MetricRecorder {
+ public:
+  static MetricRecorder& instance() {
+    if (!instance_) {
+      instance_.reset(new MetricRecorder());
+    }
+    return *instance_;
+  }
+
+  void record(const std::string& name, uint64_t timestamp, double value);
+
+  //! Adds amount to the last recorded value for the metric (starting from zero)
+  void increment(const std::string& name, uint64_t timestamp, double amount = 1.0);
+
+  //! Clears every metric (the instance stays valid)
+  void reset();
+
+  //! Oldest measurements are dropped past this many per metric (0 for unbounded)
+  void setMaxMeasurements(size_t max_measurements);
+
+  std::optional<double> getLast(const std::string& name) const;
+
+  size_t getNumMeasurements(const std::string& name) const;
+
+  //! Number of measurements dropped to stay under the maximum
+  size_t getNumDropped(const std::string& name) const;
+
+  void logMetric(const std::string& name, const std::string& output_folder) const;
+
+  void logAllMetrics(const std::string& output_folder) const;
+
+ private:
+  using Measurement = std::pair<uint64_t, double>;
+  using MeasurementList = std::deque<Measurement>;
+
+  void addMeasurement(const std::string& name, uint64_t timestamp, double value);
+
+  MetricRecorder();
+
+  static std::unique_ptr<MetricRecorder> instance_;
+
+  size_t max_measurements_;
+  std::map<std::string, MeasurementList> values_;
+  std::map<std::string, size_t> num_dropped_;
+  std::unique_ptr<std::mutex> mutex_;
+};
+
+}  // namespace metrics
+}  // namespace hydra
@@ -0,0 +1,177 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_utils/metric_utilities.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <fstream>
+
+namespace hydra {
+namespace metrics {
+
+decltype(MetricRecorder::instance_) MetricRecorder::instance_;
+
+MetricRecorder::MetricRecorder() : max_measurements_(100000) {
+  mutex_.reset(new std::mutex());
+}
+
+void MetricRecorder::record(const std::string& name,
+                            uint64_t timestamp,
+                            double value) {
+  std::unique_lock<std::mutex> lock(*mutex_);
+  addMeasurement(name, timestamp, value);
+}
+
+void MetricRecorder::increment(const std::string& name,
+                               uint64_t timestamp,
+                               double amount) {
+  std::unique_lock<std::mutex> lock(*mutex_);
+  const auto& values = values_[name];
+  const double prev_value = values.empty() ? 0.0 : values.back().second;
+  addMeasurement(name, timestamp, prev_value + amount);
+}
+
+void MetricRecorder::addMeasurement(const std::string& name,
+                                    uint64_t timestamp,
+                                    double value) {
+  auto& values = values_[name];
+  values.emplace_back(timestamp, value);
+  if (max_measurements_ == 0 || values.size() <= max_measurements_) {
+    return;
+  }
+
+  const size_t num_extra = values.size() - max_measurements_;
+  values.erase(values.begin(), values.begin() + num_extra);
+  num_dropped_[name] += num_extra;
+}
+
+void MetricRecorder::reset() {
+  // callers may hold on to the instance, so it has to stay valid
+  std::unique_lock<std::mutex> lock(*mutex_);
+  values_.clear();
+  num_dropped_.clear();
+}
+
+void MetricRecorder::setMaxMeasurements(size_t max_measurements) {
+  std::unique_lock<std::mutex> lock(*mutex_);
+  max_measurements_ = max_measurements;
+  if (max_measurements_ == 0) {
+    return;
+  }
+
+  for (auto& name_values_pair : values_) {
+    auto& values = name_values_pair.second;
+    if (values.size() <= max_measurements_) {
+      continue;
+    }
+
+    const size_t num_extra = values.size() - max_measurements_;
+    values.erase(values.begin(), values.begin() + num_extra);
+    num_dropped_[name_values_pair.first] += num_extra;
+  }
+}
+
+std::optional<double> MetricRecorder::getLast(const std::string& name) const {
+  std::unique_lock<std::mutex> lock(*mutex_);
+  auto iter = values_.find(name);
+  if (iter == values_.end() || iter->second.empty()) {
+    return std::nullopt;
+  }
+
+  return iter->second.back().second;
+}
+
+size_t MetricRecorder::getNumMeasurements(const std::string& name) const {
+  std::unique_lock<std::mutex> lock(*mutex_);
+  auto iter = values_.find(name);
+  return iter == values_.end() ? 0 : iter->second.size();
+}
+
+size_t MetricRecorder::getNumDropped(const std::string& name) const {
+  std::unique_lock<std::mutex> lock(*mutex_);
+  auto iter = num_dropped_.find(name);
+  return iter == num_dropped_.end() ? 0 : iter->second;
+}
+
+void MetricRecorder::logMetric(const std::string& name,
+                               const std::string& output_folder) const {
+  MeasurementList values;
+  size_t num_dropped = 0;
+  {  // start critical section
+    std::unique_lock<std::mutex> lock(*mutex_);
+    auto iter = values_.find(name);
+    if (iter == values_.end()) {
+      return;
+    }
+
+    values = iter->second;
+    auto dropped_iter = num_dropped_.find(name);
+    num_dropped = dropped_iter == num_dropped_.end() ? 0 : dropped_iter->second;
+  }  // end critical section
+
+  if (num_dropped > 0) {
+    LOG(WARNING) << "Metric " << name << " dropped its oldest " << num_dropped
+                 << " measurements";
+  }
+
+  // metric names are namespaced with '/', which we flatten to keep one folder
+  std::string filename = name;
+  std::replace(filename.begin(), filename.end(), '/', '_');
+
+  std::ofstream output_file(output_folder + "/" + filename + "_metric_raw.csv");
+  output_file << "timestamp(ns),value\n";
+  for (const auto& measurement : values) {
+    output_file << measurement.first << "," << measurement.second << "\n";
+  }
+}
+
+void MetricRecorder::logAllMetrics(const std::string& output_folder) const {
+  std::list<std::string> names;
+  {  // start critical section
+    std::unique_lock<std::mutex> lock(*mutex_);
+    for (const auto& name_value_pair : values_) {
+      names.push_back(name_value_pair.first);
+    }
+  }  // end critical section
+
+  for (const auto& name : names) {
+    VLOG(1) << "Saving metric " << name;
+    logMetric(name, output_folder);
+  }
+}
+
+}  // namespace metrics
+}  // namespace hydra
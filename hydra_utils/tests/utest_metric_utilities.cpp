@@ -0,0 +1,99 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_utils/metric_utilities.h"
+
+#include <gtest/gtest.h>
+
+namespace hydra {
+namespace metrics {
+
+struct MetricUtilityTests : public ::testing::Test {
+  virtual void SetUp() override { MetricRecorder::instance().reset(); }
+  virtual void TearDown() override { MetricRecorder::instance().reset(); }
+};
+
+TEST_F(MetricUtilityTests, TestNoMeasurements) {
+  EXPECT_FALSE(MetricRecorder::instance().getLast("test"));
+  EXPECT_EQ(0u, MetricRecorder::instance().getNumMeasurements("test"));
+}
+
+TEST_F(MetricUtilityTests, TestRecord) {
+  MetricRecorder::instance().record("test", 0, 1.0);
+  MetricRecorder::instance().record("test", 1, 5.0);
+
+  auto value = MetricRecorder::instance().getLast("test");
+  ASSERT_TRUE(value);
+  EXPECT_EQ(5.0, *value);
+  EXPECT_EQ(2u, MetricRecorder::instance().getNumMeasurements("test"));
+}
+
+TEST_F(MetricUtilityTests, TestIncrement) {
+  MetricRecorder::instance().increment("test", 0);
+  MetricRecorder::instance().increment("test", 1, 2.0);
+
+  auto value = MetricRecorder::instance().getLast("test");
+  ASSERT_TRUE(value);
+  EXPECT_EQ(3.0, *value);
+  EXPECT_EQ(2u, MetricRecorder::instance().getNumMeasurements("test"));
+}
+
+TEST_F(MetricUtilityTests, TestMaxMeasurements) {
+  MetricRecorder::instance().setMaxMeasurements(2);
+  MetricRecorder::instance().record("test", 0, 1.0);
+  MetricRecorder::instance().record("test", 1, 2.0);
+  MetricRecorder::instance().increment("test", 2, 3.0);
+
+  auto value = MetricRecorder::instance().getLast("test");
+  ASSERT_TRUE(value);
+  EXPECT_EQ(5.0, *value);
+  EXPECT_EQ(2u, MetricRecorder::instance().getNumMeasurements("test"));
+  EXPECT_EQ(1u, MetricRecorder::instance().getNumDropped("test"));
+
+  MetricRecorder::instance().setMaxMeasurements(100000);
+}
+
+TEST_F(MetricUtilityTests, TestResetInPlace) {
+  MetricRecorder& recorder = MetricRecorder::instance();
+  recorder.record("test", 0, 1.0);
+  recorder.reset();
+  EXPECT_EQ(&recorder, &MetricRecorder::instance());
+  EXPECT_EQ(0u, recorder.getNumMeasurements("test"));
+
+  recorder.record("test", 1, 2.0);
+  EXPECT_EQ(1u, MetricRecorder::instance().getNumMeasurements("test"));
+}
+
+}  // namespace metrics
+}  // namespace hydra